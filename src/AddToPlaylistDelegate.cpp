@@ -0,0 +1,93 @@
+#include "AddToPlaylistDelegate.h"
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+namespace {
+
+static const int kButtonMargin = 4;
+static const int kButtonWidth = 24;
+
+} // namespace
+
+AddToPlaylistDelegate::AddToPlaylistDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+QRect AddToPlaylistDelegate::buttonRect(const QRect &itemRect)
+{
+    return QRect(itemRect.left() + kButtonMargin, itemRect.top(), kButtonWidth, itemRect.height());
+}
+
+void AddToPlaylistDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                  const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+    QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+
+    // Selection and hover cover the whole row, the text starts after the button
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+    const QRect button = buttonRect(option.rect);
+    QStyleOptionViewItem textOpt(opt);
+    textOpt.rect.setLeft(button.right() + 1 + kButtonMargin);
+    style->drawControl(QStyle::CE_ItemViewItem, &textOpt, painter, opt.widget);
+
+    // Flat like an auto-raise tool button until the row is hovered
+    QStyleOptionToolButton buttonOpt;
+    buttonOpt.palette = opt.palette;
+    buttonOpt.font = opt.font;
+    buttonOpt.fontMetrics = opt.fontMetrics;
+    buttonOpt.direction = opt.direction;
+    buttonOpt.rect = button;
+    buttonOpt.text = QStringLiteral("+");
+    buttonOpt.toolButtonStyle = Qt::ToolButtonTextOnly;
+    buttonOpt.subControls = QStyle::SC_ToolButton;
+    buttonOpt.state = QStyle::State_Enabled | QStyle::State_AutoRaise;
+    if (option.state & QStyle::State_MouseOver) {
+        buttonOpt.state |= QStyle::State_MouseOver | QStyle::State_Raised;
+        buttonOpt.activeSubControls = QStyle::SC_ToolButton;
+    }
+    style->drawComplexControl(QStyle::CC_ToolButton, &buttonOpt, painter, opt.widget);
+}
+
+QSize AddToPlaylistDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.rwidth() += kButtonWidth + 2 * kButtonMargin;
+    size.setHeight(qMax(size.height(), option.fontMetrics.height() + 2 * kButtonMargin));
+    return size;
+}
+
+bool AddToPlaylistDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                        const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    const QEvent::Type type = event->type();
+    if (type == QEvent::MouseButtonPress || type == QEvent::MouseButtonRelease ||
+        type == QEvent::MouseButtonDblClick) {
+        const QMouseEvent *mouse = static_cast<QMouseEvent *>(event);
+        if (mouse->button() == Qt::LeftButton && buttonRect(option.rect).contains(mouse->position().toPoint())) {
+            // The button takes the whole click, so it neither selects nor
+            // activates the row
+            if (type == QEvent::MouseButtonRelease) {
+                emit addClicked(index);
+            }
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+bool AddToPlaylistDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view,
+                                      const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::ToolTip && buttonRect(option.rect).contains(event->pos())) {
+        QToolTip::showText(event->globalPos(), "Add to playlist", view);
+        return true;
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
@@ -0,0 +1,32 @@
+#ifndef ADDTOPLAYLISTDELEGATE_H
+#define ADDTOPLAYLISTDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Draws a "+" button at the start of every row of a list view and reports
+// clicks on it. Painted rather than a widget per row, so long lists stay
+// cheap to fill and scroll.
+class AddToPlaylistDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit AddToPlaylistDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                   const QModelIndex &index) override;
+
+signals:
+    void addClicked(const QModelIndex &index);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                     const QModelIndex &index) override;
+
+private:
+    static QRect buttonRect(const QRect &itemRect);
+};
+
+#endif // ADDTOPLAYLISTDELEGATE_H
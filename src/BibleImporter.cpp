@@ -0,0 +1,637 @@
+#include "BibleImporter.h"
+#include "BiblePack.h"
+#include "BibleTranslation.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+
+namespace {
+
+// OSIS book identifiers in canonical order. Index + 1 is the book ID.
+static const char *const kOsisBookIds[] = {
+    "Gen", "Exod", "Lev", "Num", "Deut", "Josh", "Judg", "Ruth", "1Sam", "2Sam",
+    "1Kgs", "2Kgs", "1Chr", "2Chr", "Ezra", "Neh", "Esth", "Job", "Ps", "Prov",
+    "Eccl", "Song", "Isa", "Jer", "Lam", "Ezek", "Dan", "Hos", "Joel", "Amos",
+    "Obad", "Jonah", "Mic", "Nah", "Hab", "Zeph", "Hag", "Zech", "Mal", "Matt",
+    "Mark", "Luke", "John", "Acts", "Rom", "1Cor", "2Cor", "Gal", "Eph", "Phil",
+    "Col", "1Thess", "2Thess", "1Tim", "2Tim", "Titus", "Phlm", "Heb", "Jas", "1Pet",
+    "2Pet", "1John", "2John", "3John", "Jude", "Rev"
+};
+
+// Books outside the canon (deuterocanon, extra books) keep a stable ID
+// past the canonical range, in the order they appear
+static const int kExtraBookIdBase = 1000;
+
+int osisBookId(QStringView osisId)
+{
+    for (int i = 0; i < int(sizeof(kOsisBookIds) / sizeof(kOsisBookIds[0])); ++i) {
+        if (osisId == QLatin1String(kOsisBookIds[i])) {
+            return i + 1;
+        }
+    }
+    return BibleTranslation::canonicalBookId(osisId);
+}
+
+// "Gen.1.2" -> part 2 is 2, part 1 is 1. Verse bridges list several IDs
+// separated by spaces; the first one wins.
+int osisRefPart(QStringView osisRef, int part)
+{
+    const int space = osisRef.indexOf(QLatin1Char(' '));
+    if (space >= 0) {
+        osisRef = osisRef.left(space);
+    }
+    int index = 0;
+    qsizetype start = 0;
+    while (index < part) {
+        const qsizetype dot = osisRef.indexOf(QLatin1Char('.'), start);
+        if (dot < 0) {
+            return 0;
+        }
+        start = dot + 1;
+        ++index;
+    }
+    const qsizetype end = osisRef.indexOf(QLatin1Char('.'), start);
+    return osisRef.mid(start, end < 0 ? -1 : end - start).toInt();
+}
+
+bool nameIs(QStringView name, const char *expected)
+{
+    return name.compare(QLatin1String(expected), Qt::CaseInsensitive) == 0;
+}
+
+// Collects verse text for one book at a time
+struct BookBuilder {
+    int bookId = 0;
+    BibleBook book;
+    int chapter = 0;
+    int verse = 0;
+    bool inVerse = false;
+    QString text;
+
+    void startVerse(int verseNumber)
+    {
+        finishVerse();
+        verse = verseNumber;
+        inVerse = verseNumber > 0;
+    }
+
+    void appendText(QStringView fragment)
+    {
+        if (inVerse) {
+            text += fragment;
+        }
+    }
+
+    void finishVerse()
+    {
+        if (inVerse && bookId > 0 && chapter > 0 && verse > 0) {
+            const QString simplified = text.simplified();
+            if (!simplified.isEmpty()) {
+                QString &stored = book.chapters[chapter][verse];
+                stored = stored.isEmpty() ? simplified : stored + QLatin1Char(' ') + simplified;
+            }
+        }
+        inVerse = false;
+        text.clear();
+    }
+};
+
+// Compresses finished books on the thread pool while the reader carries on
+// with the next one. Waits for the oldest book once as many are in flight
+// as there are pool threads, which bounds the plain text held in memory.
+class BookCompressor
+{
+public:
+    explicit BookCompressor(BiblePackWriter &writer) : writer(writer) {}
+    ~BookCompressor() { finish(); }
+
+    void add(BookBuilder &builder)
+    {
+        builder.finishVerse();
+        if (builder.bookId > 0 && !builder.book.chapters.isEmpty()) {
+            const int maxInFlight = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+            while (pending.size() >= maxInFlight) {
+                pending.takeFirst().waitForFinished();
+            }
+            BiblePackWriter *target = &writer;
+            const int bookId = builder.bookId;
+            const BibleBook book = builder.book;
+            pending.append(QtConcurrent::run([target, bookId, book]() { target->addBook(bookId, book); }));
+        }
+        builder = BookBuilder();
+    }
+
+    void finish()
+    {
+        while (!pending.isEmpty()) {
+            pending.takeFirst().waitForFinished();
+        }
+    }
+
+private:
+    BiblePackWriter &writer;
+    QList<QFuture<void>> pending;
+};
+
+bool reportXmlError(const QXmlStreamReader &xml, QString *errorString)
+{
+    if (!xml.hasError()) {
+        return true;
+    }
+    if (errorString) {
+        *errorString = QString("XML parse error at line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+    }
+    return false;
+}
+
+bool isUsfmFile(const QFileInfo &info)
+{
+    const QString suffix = info.suffix().toLower();
+    return suffix == QLatin1String("usfm") || suffix == QLatin1String("sfm");
+}
+
+// Paragraph-level USFM markers whose text is not scripture (headings, book
+// titles, introductions, comments); the rest of their line is dropped
+bool isUsfmHeadingMarker(QStringView marker)
+{
+    static const char *const kMarkers[] = {
+        "h", "toc1", "toc2", "toc3", "toca1", "toca2", "toca3", "mt", "mt1", "mt2", "mt3", "mt4",
+        "mte", "mte1", "mte2", "ms", "ms1", "ms2", "ms3", "mr", "s", "s1", "s2", "s3", "s4",
+        "sr", "r", "d", "sp", "rem", "sts", "ide", "usfm", "cl", "cp", "cd", "restore",
+        "imt", "imt1", "imt2", "is", "is1", "is2", "ip", "ipi", "im", "imi", "ipq", "imq",
+        "ipr", "iq", "iq1", "iq2", "ib", "ili", "ili1", "ili2", "iot", "io", "io1", "io2",
+        "ior", "iex", "imte", "ie"
+    };
+    for (const char *known : kMarkers) {
+        if (marker == QLatin1String(known)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Character-level USFM spans whose content is not verse text
+bool isUsfmNoteMarker(QStringView marker)
+{
+    return marker == QLatin1String("f") || marker == QLatin1String("fe") || marker == QLatin1String("ef") ||
+           marker == QLatin1String("x") || marker == QLatin1String("ex") || marker == QLatin1String("fig") ||
+           marker == QLatin1String("rq") || marker == QLatin1String("va") || marker == QLatin1String("vp") ||
+           marker == QLatin1String("ca");
+}
+
+} // namespace
+
+BibleImporter::Format BibleImporter::detectFormat(const QString &sourcePath)
+{
+    const QFileInfo info(sourcePath);
+    if (info.isDir() || isUsfmFile(info)) {
+        return UsfmFormat;
+    }
+
+    QFile file(sourcePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return UnknownFormat;
+    }
+    QXmlStreamReader xml(&file);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement()) {
+            if (nameIs(xml.name(), "osis")) {
+                return OsisFormat;
+            }
+            if (nameIs(xml.name(), "XMLBIBLE") || nameIs(xml.name(), "bible")) {
+                return ZefaniaFormat;
+            }
+            return UnknownFormat;
+        }
+    }
+    return UnknownFormat;
+}
+
+QString BibleImporter::formatName(Format format)
+{
+    switch (format) {
+    case OsisFormat:
+        return QStringLiteral("OSIS");
+    case UsfmFormat:
+        return QStringLiteral("USFM");
+    case ZefaniaFormat:
+        return QStringLiteral("Zefania XML");
+    default:
+        return QString();
+    }
+}
+
+QString BibleImporter::fileDialogFilter()
+{
+    return QStringLiteral("Bible Files (*.xml *.osis *.usfm *.sfm);;All Files (*)");
+}
+
+bool BibleImporter::importBible(const QString &sourcePath, const QString &packPath, QString *errorString)
+{
+    const Format format = detectFormat(sourcePath);
+    if (format == UnknownFormat) {
+        if (errorString) {
+            *errorString = QString("Unrecognised Bible format: %1").arg(sourcePath);
+        }
+        return false;
+    }
+
+    BiblePackWriter writer;
+    bool ok = false;
+    if (format == UsfmFormat) {
+        // USFM has no translation title; name it after the folder or file
+        const QFileInfo info(sourcePath);
+        writer.setTranslation(info.isDir() ? info.fileName() : info.completeBaseName(), QString());
+        ok = importUsfm(sourcePath, writer, errorString);
+    } else {
+        QFile file(sourcePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            if (errorString) {
+                *errorString = QString("Cannot open file: %1").arg(sourcePath);
+            }
+            return false;
+        }
+        ok = format == OsisFormat ? importOsis(file, writer, errorString)
+                                  : importZefania(file, writer, errorString);
+    }
+    if (!ok) {
+        if (errorString && !errorString->isEmpty()) {
+            *errorString = QString("Reading %1 as %2: %3").arg(sourcePath, formatName(format), *errorString);
+        }
+        return false;
+    }
+
+    if (writer.bookCount() == 0) {
+        if (errorString) {
+            *errorString = QString("No books found in %1").arg(sourcePath);
+        }
+        return false;
+    }
+    return writer.save(packPath, errorString);
+}
+
+bool BibleImporter::importOsis(QIODevice &device, BiblePackWriter &writer, QString *errorString)
+{
+    QXmlStreamReader xml(&device);
+    BookCompressor compressor(writer);
+    BookBuilder builder;
+    QString translationName;
+    QString translationAcronym;
+    bool inWork = false;
+    bool milestoneVerse = false; // <verse sID/> ... <verse eID/> rather than <verse>...</verse>
+    int skipDepth = 0;           // inside notes, headings and other non-verse text
+    int extraBooks = 0;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isStartElement()) {
+            const QStringView name = xml.name();
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (skipDepth > 0) {
+                ++skipDepth;
+            } else if (name == QLatin1String("osisText")) {
+                translationAcronym = attributes.value("osisIDWork").toString();
+            } else if (name == QLatin1String("work")) {
+                inWork = true;
+            } else if (name == QLatin1String("title") && inWork) {
+                if (translationName.isEmpty()) {
+                    translationName = xml.readElementText(QXmlStreamReader::IncludeChildElements).simplified();
+                } else {
+                    xml.skipCurrentElement();
+                }
+            } else if (name == QLatin1String("div") && attributes.value("type") == QLatin1String("book")) {
+                compressor.add(builder);
+                const QStringView osisId = attributes.value("osisID");
+                builder.bookId = osisBookId(osisId);
+                builder.book.name = BibleTranslation::canonicalBookName(builder.bookId);
+                if (builder.bookId <= 0) {
+                    builder.bookId = kExtraBookIdBase + ++extraBooks;
+                    builder.book.name = osisId.toString();
+                }
+            } else if (name == QLatin1String("chapter")) {
+                builder.finishVerse();
+                if (!attributes.hasAttribute("eID")) {
+                    const QStringView ref = attributes.hasAttribute("osisID") ? attributes.value("osisID")
+                                                                                : attributes.value("sID");
+                    builder.chapter = osisRefPart(ref, 1);
+                }
+            } else if (name == QLatin1String("verse")) {
+                if (attributes.hasAttribute("eID")) {
+                    builder.finishVerse();
+                } else {
+                    milestoneVerse = attributes.hasAttribute("sID");
+                    const QStringView ref = attributes.hasAttribute("osisID") ? attributes.value("osisID")
+                                                                                : attributes.value("sID");
+                    if (builder.chapter == 0) {
+                        builder.chapter = osisRefPart(ref, 1);
+                    }
+                    builder.startVerse(osisRefPart(ref, 2));
+                }
+            } else if (name == QLatin1String("note") || name == QLatin1String("title") ||
+                       name == QLatin1String("rdg")) {
+                skipDepth = 1;
+            } else if (name == QLatin1String("lb") || name == QLatin1String("l")) {
+                builder.appendText(u" ");
+            }
+        } else if (xml.isEndElement()) {
+            const QStringView name = xml.name();
+            if (skipDepth > 0) {
+                --skipDepth;
+            } else if (name == QLatin1String("work")) {
+                inWork = false;
+            } else if (name == QLatin1String("verse") && !milestoneVerse) {
+                builder.finishVerse();
+            } else if (name == QLatin1String("chapter")) {
+                builder.finishVerse();
+            }
+        } else if (xml.isCharacters() && skipDepth == 0) {
+            builder.appendText(xml.text());
+        }
+    }
+
+    compressor.add(builder);
+    compressor.finish();
+    writer.setTranslation(translationName.isEmpty() ? translationAcronym : translationName, translationAcronym);
+    return reportXmlError(xml, errorString);
+}
+
+bool BibleImporter::importZefania(QIODevice &device, BiblePackWriter &writer, QString *errorString)
+{
+    QXmlStreamReader xml(&device);
+    BookCompressor compressor(writer);
+    BookBuilder builder;
+    QString translationName;
+    QString translationAcronym;
+    bool inInformation = false;
+    int skipDepth = 0; // NOTE, XREF, CAPTION, PROLOG and similar
+    int position = 0;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isStartElement()) {
+            const QStringView name = xml.name();
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (skipDepth > 0) {
+                ++skipDepth;
+            } else if (nameIs(name, "XMLBIBLE") || nameIs(name, "bible")) {
+                translationName = attributes.value("biblename").toString();
+                if (translationName.isEmpty()) {
+                    translationName = attributes.value("translation").toString();
+                }
+            } else if (nameIs(name, "INFORMATION")) {
+                inInformation = true;
+            } else if (inInformation) {
+                if (nameIs(name, "title") && translationName.isEmpty()) {
+                    translationName = xml.readElementText(QXmlStreamReader::IncludeChildElements).simplified();
+                } else if (nameIs(name, "identifier") && translationAcronym.isEmpty()) {
+                    translationAcronym = xml.readElementText(QXmlStreamReader::IncludeChildElements).simplified();
+                } else {
+                    xml.skipCurrentElement();
+                }
+            } else if (nameIs(name, "BIBLEBOOK") || nameIs(name, "book")) {
+                compressor.add(builder);
+                ++position;
+                QString bookName = attributes.value("bname").toString();
+                if (bookName.isEmpty()) {
+                    bookName = attributes.value("name").toString();
+                }
+                const QString shortName = attributes.value("bsname").toString();
+
+                builder.bookId = attributes.value("bnumber").toInt();
+                if (builder.bookId <= 0) {
+                    builder.bookId = BibleTranslation::canonicalBookId(bookName);
+                }
+                if (builder.bookId <= 0) {
+                    builder.bookId = BibleTranslation::canonicalBookId(shortName);
+                }
+                if (builder.bookId <= 0) {
+                    builder.bookId = kExtraBookIdBase + position;
+                }
+                builder.book.name = !bookName.isEmpty() ? bookName
+                                  : !shortName.isEmpty() ? shortName
+                                  : BibleTranslation::canonicalBookName(builder.bookId);
+            } else if (nameIs(name, "CHAPTER")) {
+                builder.finishVerse();
+                builder.chapter = attributes.value("cnumber").toInt();
+                if (builder.chapter == 0) {
+                    builder.chapter = attributes.value("number").toInt();
+                }
+            } else if (nameIs(name, "VERS") || nameIs(name, "verse")) {
+                int verse = attributes.value("vnumber").toInt();
+                if (verse == 0) {
+                    verse = attributes.value("number").toInt();
+                }
+                builder.startVerse(verse);
+            } else if (nameIs(name, "BR")) {
+                builder.appendText(u" ");
+            } else if (nameIs(name, "NOTE") || nameIs(name, "XREF") || nameIs(name, "CAPTION") ||
+                       nameIs(name, "PROLOG") || nameIs(name, "REMARK") || nameIs(name, "MEDIA")) {
+                skipDepth = 1;
+            }
+            // STYLE, gr and other inline markup fall through so their text is kept
+        } else if (xml.isEndElement()) {
+            const QStringView name = xml.name();
+            if (skipDepth > 0) {
+                --skipDepth;
+            } else if (nameIs(name, "INFORMATION")) {
+                inInformation = false;
+            } else if (nameIs(name, "VERS") || nameIs(name, "verse")) {
+                builder.finishVerse();
+            }
+        } else if (xml.isCharacters() && skipDepth == 0) {
+            builder.appendText(xml.text());
+        }
+    }
+
+    compressor.add(builder);
+    compressor.finish();
+    writer.setTranslation(translationName, translationAcronym);
+    return reportXmlError(xml, errorString);
+}
+
+bool BibleImporter::importUsfm(const QString &sourcePath, BiblePackWriter &writer, QString *errorString)
+{
+    QStringList files;
+    const QFileInfo info(sourcePath);
+    if (info.isDir()) {
+        const QFileInfoList entries = QDir(sourcePath).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &entry : entries) {
+            if (isUsfmFile(entry)) {
+                files.append(entry.absoluteFilePath());
+            }
+        }
+    } else {
+        files.append(info.absoluteFilePath());
+    }
+
+    if (files.isEmpty()) {
+        if (errorString) {
+            *errorString = QString("No USFM files (*.usfm, *.sfm) in %1").arg(sourcePath);
+        }
+        return false;
+    }
+
+    // One task per book file; each adds its own compressed book to the writer
+    QMutex errorMutex;
+    QString firstError;
+    QVector<int> indexes(files.size());
+    for (int i = 0; i < indexes.size(); ++i) {
+        indexes[i] = i;
+    }
+    QtConcurrent::blockingMap(indexes, [&](int index) {
+        QString error;
+        if (!importUsfmBook(files.at(index), kExtraBookIdBase + index + 1, writer, &error)) {
+            QMutexLocker locker(&errorMutex);
+            if (firstError.isEmpty()) {
+                firstError = error;
+            }
+        }
+    });
+
+    if (!firstError.isEmpty()) {
+        if (errorString) {
+            *errorString = firstError;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool BibleImporter::importUsfmBook(const QString &filePath, int fallbackBookId, BiblePackWriter &writer,
+                                   QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = QString("Cannot open file: %1").arg(filePath);
+        }
+        return false;
+    }
+
+    QTextStream in(&file);
+    BookBuilder builder;
+    builder.bookId = fallbackBookId; // until \id names the book
+    QString bookCode;
+    QString headerName;
+    QString noteCloser;        // e.g. "f" while inside a footnote, until \f*
+    qsizetype spanStart = -1;  // where the innermost character span began, for "|attributes"
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        qsizetype pos = 0;
+        const qsizetype length = line.size();
+
+        while (pos < length) {
+            const qsizetype slash = line.indexOf(QLatin1Char('\\'), pos);
+            const qsizetype textEnd = slash < 0 ? length : slash;
+            if (noteCloser.isEmpty() && textEnd > pos) {
+                builder.appendText(QStringView(line).mid(pos, textEnd - pos));
+            }
+            if (slash < 0) {
+                break;
+            }
+
+            // Marker name runs to whitespace or a closing '*'
+            qsizetype markerEnd = slash + 1;
+            while (markerEnd < length && !line.at(markerEnd).isSpace() && line.at(markerEnd) != QLatin1Char('*') &&
+                   line.at(markerEnd) != QLatin1Char('\\')) {
+                ++markerEnd;
+            }
+            const bool closing = markerEnd < length && line.at(markerEnd) == QLatin1Char('*');
+            QStringView marker = QStringView(line).mid(slash + 1, markerEnd - slash - 1);
+            if (marker.startsWith(QLatin1Char('+'))) {
+                marker = marker.mid(1); // nested character style
+            }
+            pos = closing ? markerEnd + 1 : markerEnd;
+            if (!closing && pos < length && line.at(pos).isSpace()) {
+                ++pos;
+            }
+
+            if (!noteCloser.isEmpty()) {
+                if (closing && marker == noteCloser) {
+                    noteCloser.clear();
+                }
+                continue;
+            }
+
+            if (closing) {
+                // Drop USFM 3 attributes such as \w grace|strong="H2580"\w*
+                if (spanStart >= 0) {
+                    const qsizetype bar = builder.text.indexOf(QLatin1Char('|'), spanStart);
+                    if (bar >= 0) {
+                        builder.text.truncate(bar);
+                    }
+                    spanStart = -1;
+                }
+                continue;
+            }
+
+            if (marker == QLatin1String("id")) {
+                const qsizetype codeEnd = line.indexOf(QLatin1Char(' '), pos);
+                bookCode = line.mid(pos, codeEnd < 0 ? -1 : codeEnd - pos).trimmed();
+                const int canonicalId = BibleTranslation::canonicalBookId(bookCode);
+                if (canonicalId > 0) {
+                    builder.bookId = canonicalId;
+                }
+                pos = length;
+            } else if (marker == QLatin1String("h") || marker == QLatin1String("toc2")) {
+                if (headerName.isEmpty() || marker == QLatin1String("h")) {
+                    headerName = line.mid(pos).trimmed();
+                }
+                pos = length;
+            } else if (marker == QLatin1String("c")) {
+                builder.finishVerse();
+                qsizetype numberEnd = pos;
+                while (numberEnd < length && line.at(numberEnd).isDigit()) {
+                    ++numberEnd;
+                }
+                builder.chapter = line.mid(pos, numberEnd - pos).toInt();
+                pos = numberEnd;
+            } else if (marker == QLatin1String("v")) {
+                qsizetype numberEnd = pos;
+                while (numberEnd < length && !line.at(numberEnd).isSpace()) {
+                    ++numberEnd;
+                }
+                // "1-2" bridges are stored under their first verse
+                QStringView number = QStringView(line).mid(pos, numberEnd - pos);
+                const qsizetype dash = number.indexOf(QLatin1Char('-'));
+                if (dash > 0) {
+                    number = number.left(dash);
+                }
+                builder.startVerse(number.toInt());
+                pos = numberEnd;
+            } else if (isUsfmNoteMarker(marker)) {
+                noteCloser = marker.toString();
+            } else if (isUsfmHeadingMarker(marker)) {
+                pos = length;
+            } else {
+                // Paragraph, poetry and character style markers: keep the text
+                builder.appendText(u" ");
+                spanStart = builder.inVerse ? builder.text.size() : -1;
+            }
+        }
+        builder.appendText(u" ");
+    }
+    builder.finishVerse();
+
+    if (builder.book.chapters.isEmpty()) {
+        // Front matter, glossaries and other non-scripture files
+        return true;
+    }
+    builder.book.name = !headerName.isEmpty() ? headerName
+                      : builder.bookId <= BibleTranslation::canonicalBookCount() ? BibleTranslation::canonicalBookName(builder.bookId)
+                      : bookCode;
+    writer.addBook(builder.bookId, builder.book);
+    return true;
+}
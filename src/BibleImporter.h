@@ -0,0 +1,49 @@
+#ifndef BIBLEIMPORTER_H
+#define BIBLEIMPORTER_H
+
+#include <QString>
+
+class QIODevice;
+class BiblePackWriter;
+
+// Converts Bibles from common interchange formats into the app's compiled
+// .spbible packs:
+//
+//   OSIS XML      - <osis>, container or milestone <chapter>/<verse> markup
+//   USFM          - a directory with one .usfm/.sfm file per book (or one file)
+//   Zefania XML   - <XMLBIBLE>/<bible>, including files with inline
+//                   STYLE/NOTE/BR markup, INFORMATION headers and bsname
+//
+// XML sources are read with QXmlStreamReader straight from the file and
+// each finished book is handed to the thread pool for compression, so only
+// a few books of plain text are ever in memory. USFM books are parsed in
+// parallel, one file per task.
+class BibleImporter
+{
+public:
+    enum Format {
+        UnknownFormat,
+        OsisFormat,
+        UsfmFormat,
+        ZefaniaFormat
+    };
+
+    static Format detectFormat(const QString &sourcePath);
+    static QString formatName(Format format);
+
+    // File dialog filter for the formats importBible understands
+    static QString fileDialogFilter();
+
+    // Import sourcePath (a file or a USFM directory) and write the result
+    // to packPath. Blocking; run it off the GUI thread for large sources.
+    static bool importBible(const QString &sourcePath, const QString &packPath, QString *errorString = nullptr);
+
+private:
+    static bool importOsis(QIODevice &device, BiblePackWriter &writer, QString *errorString);
+    static bool importZefania(QIODevice &device, BiblePackWriter &writer, QString *errorString);
+    static bool importUsfm(const QString &sourcePath, BiblePackWriter &writer, QString *errorString);
+    static bool importUsfmBook(const QString &filePath, int fallbackBookId, BiblePackWriter &writer,
+                               QString *errorString);
+};
+
+#endif // BIBLEIMPORTER_H
@@ -1,67 +1,71 @@
 #include "BibleManager.h"
+#include "BiblePack.h"
+#include "ScriptureReference.h"
 #include <QFile>
-#include <QXmlStreamReader>
 #include <QDir>
-#include <QRegularExpression>
 #include <QFileInfo>
 #include <QStandardPaths>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <climits>
+#include <algorithm>
+#include <QDebug>
 
 namespace {
 
-static const char *kDefaultBibleResources[] = {
-    ":/bibles/AMP.xml",
-    ":/bibles/ESV.xml",
-    ":/bibles/MBB.xml",
-    ":/bibles/MSG.xml",
-    ":/bibles/NASB.xml",
-    ":/bibles/NKJV.xml",
-    ":/bibles/NLT.xml"
-};
+// Bundled translations are compiled into .spbible packs at build time and
+// embedded uncompressed, so they are opened in place from the resource
+// instead of being copied out and parsed as XML on first launch.
+static const char kBundledBibleResourceDir[] = ":/bibles";
 
-static void copyDefaultBiblesToDir(const QString &targetDir)
+static QStringList bibleFileFilters()
 {
-    if (targetDir.isEmpty()) {
-        return;
-    }
-
-    QDir dir(targetDir);
-    if (!dir.exists()) {
-        if (!dir.mkpath(".")) {
-            return;
-        }
-    }
-
-    const int count = sizeof(kDefaultBibleResources) / sizeof(kDefaultBibleResources[0]);
-    for (int i = 0; i < count; ++i) {
-        const QString resPath = QString::fromLatin1(kDefaultBibleResources[i]);
-        QFileInfo resInfo(resPath);
-        const QString fileName = resInfo.fileName();
-        if (fileName.isEmpty()) {
-            continue;
-        }
+    return QStringList() << "*.xml" << QString("*.%1").arg(BiblePack::fileSuffix());
+}
 
-        const QString dstPath = dir.filePath(fileName);
-        if (QFile::exists(dstPath)) {
-            continue;
-        }
+static bool isLetterOrNumberAt(const QString &text, int index)
+{
+    return index >= 0 && index < text.size() && text.at(index).isLetterOrNumber();
+}
 
-        QFile src(resPath);
-        if (!src.open(QIODevice::ReadOnly)) {
-            continue;
-        }
+// Higher is better: a whole-word match in the exact case, in a verse the
+// phrase makes up most of, is almost certainly the verse being quoted
+static int searchScore(const QString &text, const QString &searchText, int position)
+{
+    int score = 1000 * searchText.size() / qMax(1, int(text.size()));
+    if (!isLetterOrNumberAt(text, position - 1) && !isLetterOrNumberAt(text, position + searchText.size())) {
+        score += 1000;
+    }
+    if (QStringView(text).mid(position, searchText.size()) == searchText) {
+        score += 500;
+    }
+    return score;
+}
 
-        QFile dst(dstPath);
-        if (!dst.open(QIODevice::WriteOnly)) {
-            src.close();
-            continue;
-        }
+static bool searchHitLessThan(const BibleSearchHit &a, const BibleSearchHit &b)
+{
+    if (a.score != b.score) {
+        return a.score > b.score;
+    }
+    if (a.bookId != b.bookId) {
+        return a.bookId < b.bookId;
+    }
+    if (a.verse.chapter != b.verse.chapter) {
+        return a.verse.chapter < b.verse.chapter;
+    }
+    if (a.verse.verse != b.verse.verse) {
+        return a.verse.verse < b.verse.verse;
+    }
+    return a.verse.translation < b.verse.translation;
+}
 
-        const QByteArray data = src.readAll();
-        if (!data.isEmpty()) {
-            dst.write(data);
-        }
-        dst.close();
-        src.close();
+static void keepTopHits(QVector<BibleSearchHit> &hits, int maxResults)
+{
+    if (hits.size() > maxResults) {
+        std::partial_sort(hits.begin(), hits.begin() + maxResults, hits.end(), searchHitLessThan);
+        hits.resize(maxResults);
+    } else {
+        std::sort(hits.begin(), hits.end(), searchHitLessThan);
     }
 }
 
@@ -69,258 +73,180 @@ static void copyDefaultBiblesToDir(const QString &targetDir)
 
 BibleManager::BibleManager(QObject *parent)
     : QObject(parent)
+    , resident(std::make_shared<const ResidentMap>())
 {
-    // Initialize common book name aliases
-    bookAliases["gen"] = "Genesis";
-    bookAliases["exo"] = "Exodus";
-    bookAliases["lev"] = "Leviticus";
-    bookAliases["num"] = "Numbers";
-    bookAliases["deu"] = "Deuteronomy";
-    bookAliases["jos"] = "Joshua";
-    bookAliases["jdg"] = "Judges";
-    bookAliases["rut"] = "Ruth";
-    bookAliases["1sa"] = "1 Samuel";
-    bookAliases["2sa"] = "2 Samuel";
-    bookAliases["1ki"] = "1 Kings";
-    bookAliases["2ki"] = "2 Kings";
-    bookAliases["1ch"] = "1 Chronicles";
-    bookAliases["2ch"] = "2 Chronicles";
-    bookAliases["ezr"] = "Ezra";
-    bookAliases["neh"] = "Nehemiah";
-    bookAliases["est"] = "Esther";
-    bookAliases["job"] = "Job";
-    bookAliases["psa"] = "Psalms";
-    bookAliases["pro"] = "Proverbs";
-    bookAliases["ecc"] = "Ecclesiastes";
-    bookAliases["sng"] = "Song of Solomon";
-    bookAliases["isa"] = "Isaiah";
-    bookAliases["jer"] = "Jeremiah";
-    bookAliases["lam"] = "Lamentations";
-    bookAliases["ezk"] = "Ezekiel";
-    bookAliases["dan"] = "Daniel";
-    bookAliases["hos"] = "Hosea";
-    bookAliases["jol"] = "Joel";
-    bookAliases["amo"] = "Amos";
-    bookAliases["oba"] = "Obadiah";
-    bookAliases["jon"] = "Jonah";
-    bookAliases["mic"] = "Micah";
-    bookAliases["nam"] = "Nahum";
-    bookAliases["hab"] = "Habakkuk";
-    bookAliases["zep"] = "Zephaniah";
-    bookAliases["hag"] = "Haggai";
-    bookAliases["zec"] = "Zechariah";
-    bookAliases["mal"] = "Malachi";
-    bookAliases["mat"] = "Matthew";
-    bookAliases["mrk"] = "Mark";
-    bookAliases["luk"] = "Luke";
-    bookAliases["jhn"] = "John";
-    bookAliases["act"] = "Acts";
-    bookAliases["rom"] = "Romans";
-    bookAliases["1co"] = "1 Corinthians";
-    bookAliases["2co"] = "2 Corinthians";
-    bookAliases["gal"] = "Galatians";
-    bookAliases["eph"] = "Ephesians";
-    bookAliases["php"] = "Philippians";
-    bookAliases["col"] = "Colossians";
-    bookAliases["1th"] = "1 Thessalonians";
-    bookAliases["2th"] = "2 Thessalonians";
-    bookAliases["1ti"] = "1 Timothy";
-    bookAliases["2ti"] = "2 Timothy";
-    bookAliases["tit"] = "Titus";
-    bookAliases["phm"] = "Philemon";
-    bookAliases["heb"] = "Hebrews";
-    bookAliases["jas"] = "James";
-    bookAliases["1pe"] = "1 Peter";
-    bookAliases["2pe"] = "2 Peter";
-    bookAliases["1jn"] = "1 John";
-    bookAliases["2jn"] = "2 John";
-    bookAliases["3jn"] = "3 John";
-    bookAliases["jud"] = "Jude";
-    bookAliases["rev"] = "Revelation";
 }
 
 BibleManager::~BibleManager()
 {
 }
 
-bool BibleManager::loadBible(const QString &filePath)
+std::shared_ptr<const BibleTranslation> BibleManager::snapshot() const
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit bibleLoadError(QString("Cannot open file: %1").arg(filePath));
-        return false;
-    }
-    
-    books.clear();
-    
-    QXmlStreamReader xml(&file);
-    QString currentBookName;
-    int currentChapter = 0;
-    
-    while (!xml.atEnd()) {
-        xml.readNext();
-        
-        if (xml.isStartElement()) {
-            // Support both formats: <XMLBIBLE> and <bible>
-            if (xml.name() == QString("XMLBIBLE") || xml.name() == QString("bible")) {
-                // Try biblename first (new format), then translation (old format)
-                const QString biblename = xml.attributes().value("biblename").toString();
-                const QString translationCode = xml.attributes().value("translation").toString();
-
-                currentTranslation = biblename;
-                if (currentTranslation.isEmpty()) {
-                    currentTranslation = translationCode;
-                }
-                if (currentTranslation.isEmpty()) {
-                    currentTranslation = QFileInfo(filePath).baseName();
-                }
+    return std::atomic_load(&current);
+}
 
-                // Derive a short acronym for the translation (e.g., NKJV, NASB, AMP)
-                currentTranslationAcronym.clear();
+std::shared_ptr<const BibleManager::ResidentMap> BibleManager::residentSnapshot() const
+{
+    return std::atomic_load(&resident);
+}
 
-                auto normalizeLetters = [](const QString &input) {
-                    QString lettersOnly;
-                    for (const QChar &ch : input) {
-                        if (ch.isLetter()) {
-                            lettersOnly.append(ch.toUpper());
-                        }
-                    }
-                    return lettersOnly;
-                };
+std::shared_ptr<const BibleTranslation> BibleManager::residentTranslation(const QString &filePath) const
+{
+    return residentSnapshot()->value(filePath);
+}
 
-                // 1) Prefer the translation attribute if present (often already an acronym)
-                QString candidate = normalizeLetters(translationCode.trimmed());
-                if (!candidate.isEmpty() && candidate.length() <= 12) {
-                    currentTranslationAcronym = candidate;
-                }
+void BibleManager::publish(const std::shared_ptr<const BibleTranslation> &translation)
+{
+    std::atomic_store(&current, translation);
+    emit bibleLoaded(translation->name());
+}
 
-                auto deriveFromName = [&](const QString &source) -> QString {
-                    if (source.isEmpty()) {
-                        return QString();
-                    }
+void BibleManager::addResident(const std::shared_ptr<const BibleTranslation> &translation)
+{
+    // Copy on write: readers holding the previous map keep a consistent view
+    auto map = std::make_shared<ResidentMap>(*residentSnapshot());
+    map->insert(translation->filePath(), translation);
+    std::atomic_store(&resident, std::shared_ptr<const ResidentMap>(std::move(map)));
+}
 
-                    // Use text inside the last parentheses if available, e.g. "New King James (NKJV)"
-                    int openIdx = source.lastIndexOf('(');
-                    int closeIdx = source.lastIndexOf(')');
-                    if (openIdx != -1 && closeIdx > openIdx + 1) {
-                        QString inside = normalizeLetters(source.mid(openIdx + 1, closeIdx - openIdx - 1));
-                        if (!inside.isEmpty() && inside.length() <= 12) {
-                            return inside;
-                        }
-                    }
+void BibleManager::unloadBible(const QString &filePath)
+{
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (translation && translation->filePath() == filePath) {
+        std::atomic_store(&current, std::shared_ptr<const BibleTranslation>());
+    }
+    if (isResident(filePath)) {
+        auto map = std::make_shared<ResidentMap>(*residentSnapshot());
+        map->remove(filePath);
+        std::atomic_store(&resident, std::shared_ptr<const ResidentMap>(std::move(map)));
+    }
+}
 
-                    // Otherwise, take the last word and use its letters
-                    QRegularExpression wordRe("[A-Za-z]+");
-                    QRegularExpressionMatchIterator it = wordRe.globalMatch(source);
-                    QString lastToken;
-                    while (it.hasNext()) {
-                        lastToken = it.next().captured(0);
-                    }
-                    if (!lastToken.isEmpty()) {
-                        QString letters = normalizeLetters(lastToken);
-                        if (letters.length() >= 2 && letters.length() <= 12) {
-                            return letters;
-                        }
-                    }
+bool BibleManager::loadBible(const QString &filePath)
+{
+    pendingLoadPath.clear();
+
+    std::shared_ptr<const BibleTranslation> translation = residentTranslation(filePath);
+    if (!translation) {
+        QString error;
+        translation = BibleTranslation::load(filePath, &error);
+        if (!translation) {
+            emit bibleLoadError(error);
+            return false;
+        }
+        addResident(translation);
+    }
 
-                    return QString();
-                };
+    publish(translation);
+    return true;
+}
 
-                // 2) Fallback: derive from the file base name (often an acronym like AMP, NKJV, NASB)
-                if (currentTranslationAcronym.isEmpty()) {
-                    currentTranslationAcronym = deriveFromName(QFileInfo(filePath).baseName());
-                }
+void BibleManager::loadBibleAsync(const QString &filePath)
+{
+    if (std::shared_ptr<const BibleTranslation> translation = residentTranslation(filePath)) {
+        pendingLoadPath.clear();
+        publish(translation);
+        return;
+    }
 
-                // 3) Fallback: derive from the human-readable translation name
-                if (currentTranslationAcronym.isEmpty()) {
-                    currentTranslationAcronym = deriveFromName(currentTranslation);
-                }
+    // Until the load finishes, lookups keep answering from the current
+    // snapshot. Only the most recent request is published.
+    pendingLoadPath = filePath;
+    auto *watcher = new QFutureWatcher<QPair<std::shared_ptr<const BibleTranslation>, QString>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, filePath]() {
+        watcher->deleteLater();
+        const QPair<std::shared_ptr<const BibleTranslation>, QString> result = watcher->result();
+        if (!result.first) {
+            if (pendingLoadPath == filePath) {
+                pendingLoadPath.clear();
+                emit bibleLoadError(result.second);
+            }
+            return;
+        }
 
-                // 4) Final fallback: use initials of each word
-                if (currentTranslationAcronym.isEmpty()) {
-                    QStringList words = currentTranslation.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-                    QString initials;
-                    for (const QString &w : words) {
-                        if (!w.isEmpty()) {
-                            initials.append(w.at(0).toUpper());
-                            if (initials.length() >= 8) {
-                                break;
-                            }
-                        }
-                    }
-                    currentTranslationAcronym = initials;
-                }
+        if (!residentSnapshot()->contains(filePath)) {
+            addResident(result.first);
+        }
+        if (pendingLoadPath == filePath) {
+            pendingLoadPath.clear();
+            publish(residentTranslation(filePath));
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([filePath]() {
+        QString error;
+        std::shared_ptr<const BibleTranslation> translation = BibleTranslation::load(filePath, &error);
+        return qMakePair(translation, error);
+    }));
+}
 
-                if (currentTranslationAcronym.isEmpty()) {
-                    currentTranslationAcronym = currentTranslation;
-                }
-            }
-            // Support both formats: <BIBLEBOOK> and <book>
-            else if (xml.name() == QString("BIBLEBOOK") || xml.name() == QString("book")) {
-                // Try bname first (new format), then name (old format)
-                currentBookName = xml.attributes().value("bname").toString();
-                if (currentBookName.isEmpty()) {
-                    currentBookName = xml.attributes().value("name").toString();
-                }
-                if (!currentBookName.isEmpty() && !books.contains(currentBookName)) {
-                    BibleBook book;
-                    book.name = currentBookName;
-                    books[currentBookName] = book;
-                }
-            }
-            // Support both formats: <CHAPTER> and <chapter>
-            else if (xml.name() == QString("CHAPTER") || xml.name() == QString("chapter")) {
-                // Try cnumber first (new format), then number (old format)
-                currentChapter = xml.attributes().value("cnumber").toInt();
-                if (currentChapter == 0) {
-                    currentChapter = xml.attributes().value("number").toInt();
-                }
-            }
-            // Support both formats: <VERS> and <verse>
-            else if (xml.name() == QString("VERS") || xml.name() == QString("verse")) {
-                // Try vnumber first (new format), then number (old format)
-                int verseNumber = xml.attributes().value("vnumber").toInt();
-                if (verseNumber == 0) {
-                    verseNumber = xml.attributes().value("number").toInt();
-                }
-                QString verseText = xml.readElementText().trimmed();
-                
-                if (!currentBookName.isEmpty() && currentChapter > 0 && verseNumber > 0) {
-                    books[currentBookName].chapters[currentChapter][verseNumber] = verseText;
-                }
-            }
+void BibleManager::preloadBibles(const QStringList &filePaths)
+{
+    QStringList pending;
+    for (const QString &path : filePaths) {
+        if (!path.isEmpty() && !isResident(path) && !pending.contains(path)) {
+            pending.append(path);
         }
     }
-    
-    if (xml.hasError()) {
-        emit bibleLoadError(QString("XML parse error: %1").arg(xml.errorString()));
-        return false;
+    if (pending.isEmpty()) {
+        return;
     }
-    
-    file.close();
-    
-    emit bibleLoaded(currentTranslation);
-    return true;
+
+    auto *watcher = new QFutureWatcher<std::shared_ptr<const BibleTranslation>>(this);
+    connect(watcher, &QFutureWatcherBase::resultReadyAt, this, [this, watcher](int index) {
+        const std::shared_ptr<const BibleTranslation> translation = watcher->resultAt(index);
+        if (!translation || isResident(translation->filePath())) {
+            return;
+        }
+        addResident(translation);
+    });
+    connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+
+    watcher->setFuture(QtConcurrent::mapped(pending, [](const QString &path) {
+        QString error;
+        std::shared_ptr<const BibleTranslation> translation = BibleTranslation::load(path, &error);
+        if (!translation) {
+            qWarning() << "BibleManager: failed to preload" << path << ":" << error;
+        }
+        return translation;
+    }));
 }
 
 QStringList BibleManager::getAvailableBibles() const
 {
     QStringList bibles;
+    QStringList packBaseNames;
     const QString dirPath = bibleDirectory();
     QDir dir(dirPath);
-    QStringList filters;
-    filters << "*.xml";
-    
-    QFileInfoList files = dir.entryInfoList(filters, QDir::Files);
-    if (files.isEmpty()) {
-        copyDefaultBiblesToDir(dirPath);
-        QDir refreshedDir(dirPath);
-        files = refreshedDir.entryInfoList(filters, QDir::Files);
+
+    const QFileInfoList bundled = QDir(QString::fromLatin1(kBundledBibleResourceDir))
+        .entryInfoList(QStringList() << QString("*.%1").arg(BiblePack::fileSuffix()), QDir::Files, QDir::Name);
+    QStringList bundledBaseNames;
+    for (const QFileInfo &fileInfo : bundled) {
+        bundledBaseNames.append(fileInfo.baseName().toLower());
     }
+
+    QFileInfoList files = dir.entryInfoList(bibleFileFilters(), QDir::Files);
     for (const QFileInfo &fileInfo : files) {
+        const QString baseName = fileInfo.baseName().toLower();
+        const bool isPack = fileInfo.suffix().compare(BiblePack::fileSuffix(), Qt::CaseInsensitive) == 0;
+        // Older versions copied the bundled XML out on first launch; the
+        // bundled pack replaces those copies. Imported packs replace it.
+        if (!isPack && bundledBaseNames.contains(baseName)) {
+            continue;
+        }
         bibles.append(fileInfo.absoluteFilePath());
+        if (isPack) {
+            packBaseNames.append(baseName);
+        }
     }
-    
+
+    for (const QFileInfo &fileInfo : bundled) {
+        if (!packBaseNames.contains(fileInfo.baseName().toLower())) {
+            bibles.append(fileInfo.filePath());
+        }
+    }
+
     return bibles;
 }
 
@@ -347,11 +273,10 @@ QString BibleManager::bibleDirectory()
     }
 
 #ifdef Q_OS_WIN
-    // On Windows, prefer the AppData Bible folder when it contains any XMLs.
+    // On Windows, prefer the AppData Bible folder when it contains any Bibles.
     // Fall back to the legacy C:/SimplePresenter/Bible folder when that is
     // where existing Bibles live.
-    QStringList filters;
-    filters << "*.xml";
+    const QStringList filters = bibleFileFilters();
 
     bool appDataHasBibles = !appDataPath.isEmpty() &&
         !QDir(appDataPath).entryInfoList(filters, QDir::Files).isEmpty();
@@ -375,96 +300,189 @@ QString BibleManager::bibleDirectory()
 #endif
 }
 
+QString BibleManager::getCurrentTranslation() const
+{
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    return translation ? translation->name() : QString();
+}
+
+QString BibleManager::getCurrentTranslationAcronym() const
+{
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    return translation ? translation->acronym() : QString();
+}
+
 QStringList BibleManager::getBookNames() const
 {
-    return books.keys();
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    return translation ? translation->bookNames() : QStringList();
 }
 
 QString BibleManager::getVerse(const QString &book, int chapter, int verse) const
 {
-    QString normalizedBook = normalizeBookName(book);
-    
-    if (books.contains(normalizedBook)) {
-        const BibleBook &bibleBook = books[normalizedBook];
-        if (bibleBook.chapters.contains(chapter)) {
-            if (bibleBook.chapters[chapter].contains(verse)) {
-                return bibleBook.chapters[chapter][verse];
-            }
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return QString();
+    }
+
+    const BibleBook *bibleBook = translation->book(bookIdIn(translation.get(), book));
+    if (bibleBook) {
+        auto chapterIt = bibleBook->chapters.constFind(chapter);
+        if (chapterIt != bibleBook->chapters.constEnd()) {
+            return chapterIt.value().value(verse);
         }
     }
     
     return QString();
 }
 
-QVector<BibleVerse> BibleManager::getVerses(const QString &book, int chapter, int startVerse, int endVerse) const
+QVector<BibleVerse> BibleManager::versesFrom(const BibleTranslation &translation, int bookId,
+                                             int chapter, int startVerse, int endVerse)
 {
     QVector<BibleVerse> verses;
-    QString normalizedBook = normalizeBookName(book);
-    
-    if (books.contains(normalizedBook)) {
-        const BibleBook &bibleBook = books[normalizedBook];
-        if (bibleBook.chapters.contains(chapter)) {
-            for (int v = startVerse; v <= endVerse; ++v) {
-                if (bibleBook.chapters[chapter].contains(v)) {
-                    BibleVerse verse;
-                    verse.book = normalizedBook;
-                    verse.chapter = chapter;
-                    verse.verse = v;
-                    verse.text = bibleBook.chapters[chapter][v];
-                    verses.append(verse);
-                }
+    const BibleBook *bibleBook = translation.book(bookId);
+    if (!bibleBook) {
+        return verses;
+    }
+
+    auto chapterIt = bibleBook->chapters.constFind(chapter);
+    if (chapterIt == bibleBook->chapters.constEnd()) {
+        return verses;
+    }
+
+    const QMap<int, QString> &chapterVerses = chapterIt.value();
+    for (auto it = chapterVerses.lowerBound(startVerse);
+         it != chapterVerses.constEnd() && it.key() <= endVerse; ++it) {
+        BibleVerse verse;
+        verse.book = bibleBook->name;
+        verse.chapter = chapter;
+        verse.verse = it.key();
+        verse.text = it.value();
+        verses.append(verse);
+    }
+    return verses;
+}
+
+QVector<BibleVerse> BibleManager::getVerses(const QString &book, int chapter, int startVerse, int endVerse) const
+{
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return QVector<BibleVerse>();
+    }
+    return versesFrom(*translation, bookIdIn(translation.get(), book), chapter, startVerse, endVerse);
+}
+
+QVector<BibleParallelPassage> BibleManager::getParallelVerses(const QStringList &translationPaths, const QString &book,
+                                                              int chapter, int startVerse, int endVerse) const
+{
+    QVector<BibleParallelPassage> passages;
+    const std::shared_ptr<const BibleTranslation> currentTranslation = snapshot();
+    const std::shared_ptr<const ResidentMap> translations = residentSnapshot();
+    const int bookId = bookIdIn(currentTranslation.get(), book);
+    if (bookId <= 0) {
+        return passages;
+    }
+
+    QStringList paths = translationPaths;
+    if (paths.isEmpty()) {
+        // Current translation first, then the rest in a stable order
+        if (currentTranslation) {
+            paths.append(currentTranslation->filePath());
+        }
+        for (auto it = translations->constBegin(); it != translations->constEnd(); ++it) {
+            if (!paths.contains(it.key())) {
+                paths.append(it.key());
             }
         }
     }
-    
-    return verses;
+
+    passages.reserve(paths.size());
+    for (const QString &path : paths) {
+        const std::shared_ptr<const BibleTranslation> translation = translations->value(path);
+        if (!translation) {
+            continue;
+        }
+
+        BibleParallelPassage passage;
+        passage.translationPath = path;
+        passage.translation = translation->name();
+        passage.acronym = translation->acronym();
+        passage.verses = versesFrom(*translation, bookId, chapter, startVerse, endVerse);
+        passages.append(passage);
+    }
+    return passages;
+}
+
+bool BibleManager::parseReference(QStringView text, ScriptureReference &result) const
+{
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    const BookNameTrie &bookNames = translation ? translation->bookNameTrie() : BibleTranslation::canonicalBookNameTrie();
+    return ScriptureReferenceParser(&bookNames).parse(text, result);
 }
 
 bool BibleManager::parseReference(const QString &reference, QString &book, int &chapter, int &startVerse, int &endVerse) const
 {
-    // Parse formats like:
-    // "John 3:16"
-    // "John 3:16-18"
-    // "1 John 2:1"
-    
-    QRegularExpression re(R"(^((?:\d\s)?[A-Za-z]+)\s+(\d+):(\d+)(?:-(\d+))?$)");
-    QRegularExpressionMatch match = re.match(reference.trimmed());
-    
-    if (match.hasMatch()) {
-        book = normalizeBookName(match.captured(1).trimmed());
-        chapter = match.captured(2).toInt();
-        startVerse = match.captured(3).toInt();
-        
-        if (match.captured(4).isEmpty()) {
-            endVerse = startVerse;
-        } else {
-            endVerse = match.captured(4).toInt();
+    // Single-passage view of the first span, e.g.
+    // "John 3:16"     -> John 3, verses 16-16
+    // "John 3:16-18"  -> John 3, verses 16-18
+    // "Ps 23"         -> Psalms 23, verses 1-999
+    // "Gen 1:26-2:3"  -> Genesis 1, verses 26-999
+    ScriptureReference parsed;
+    if (!parseReference(QStringView(reference), parsed)) {
+        return false;
+    }
+
+    const ScriptureSpan &span = parsed.spans[0];
+    book = bookNameIn(snapshot().get(), span.bookId);
+    chapter = span.startChapter;
+    startVerse = span.startVerse > 0 ? span.startVerse : 1;
+    endVerse = (span.endChapter == span.startChapter && span.endVerse > 0) ? span.endVerse : 999;
+    return true;
+}
+
+QVector<BibleVerse> BibleManager::getVerses(const ScriptureReference &reference) const
+{
+    QVector<BibleVerse> verses;
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return verses;
+    }
+
+    for (int i = 0; i < reference.spanCount; ++i) {
+        const ScriptureSpan &span = reference.spans[i];
+        for (int chapter = span.startChapter; chapter <= span.endChapter; ++chapter) {
+            const int startVerse = (chapter == span.startChapter && span.startVerse > 0) ? span.startVerse : 1;
+            const int endVerse = (chapter == span.endChapter && span.endVerse > 0) ? span.endVerse : INT_MAX;
+            verses += versesFrom(*translation, span.bookId, chapter, startVerse, endVerse);
         }
-        
-        return true;
     }
-    
-    return false;
+    return verses;
 }
 
 QVector<BibleVerse> BibleManager::search(const QString &searchText, int maxResults) const
 {
     QVector<BibleVerse> results;
-    QString lowerSearch = searchText.toLower();
-    
-    for (auto bookIt = books.constBegin(); bookIt != books.constEnd(); ++bookIt) {
-        const BibleBook &book = bookIt.value();
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return results;
+    }
+    const QVector<int> bookIds = translation->bookIds();
+    for (int bookId : bookIds) {
+        const BibleBook *book = translation->book(bookId);
+        if (!book) {
+            continue;
+        }
         
-        for (auto chapterIt = book.chapters.constBegin(); chapterIt != book.chapters.constEnd(); ++chapterIt) {
+        for (auto chapterIt = book->chapters.constBegin(); chapterIt != book->chapters.constEnd(); ++chapterIt) {
             int chapterNum = chapterIt.key();
             
             for (auto verseIt = chapterIt.value().constBegin(); verseIt != chapterIt.value().constEnd(); ++verseIt) {
                 int verseNum = verseIt.key();
-                QString verseText = verseIt.value();
+                const QString &verseText = verseIt.value();
                 
-                if (verseText.toLower().contains(lowerSearch)) {
+                if (verseText.contains(searchText, Qt::CaseInsensitive)) {
                     BibleVerse verse;
-                    verse.book = book.name;
+                    verse.book = book->name;
                     verse.chapter = chapterNum;
                     verse.verse = verseNum;
                     verse.text = verseText;
@@ -481,25 +499,113 @@ QVector<BibleVerse> BibleManager::search(const QString &searchText, int maxResul
     return results;
 }
 
+QVector<BibleSearchHit> BibleManager::searchTranslation(const BibleTranslation &translation,
+                                                        const QString &searchText, int maxResults)
+{
+    // Score every match cheaply first and only build verses for the winners
+    struct Candidate {
+        int score;
+        int bookId;
+        int chapter;
+        int verse;
+        const QString *text;
+        const QString *bookName;
+    };
+    QVector<Candidate> candidates;
+
+    for (int bookId : translation.bookIds()) {
+        const BibleBook *book = translation.book(bookId);
+        if (!book) {
+            continue;
+        }
+        for (auto chapterIt = book->chapters.constBegin(); chapterIt != book->chapters.constEnd(); ++chapterIt) {
+            for (auto verseIt = chapterIt.value().constBegin(); verseIt != chapterIt.value().constEnd(); ++verseIt) {
+                const QString &verseText = verseIt.value();
+                const int position = verseText.indexOf(searchText, 0, Qt::CaseInsensitive);
+                if (position >= 0) {
+                    candidates.append({ searchScore(verseText, searchText, position), bookId, chapterIt.key(),
+                                        verseIt.key(), &verseText, &book->name });
+                }
+            }
+        }
+    }
+
+    const int keep = qMin(maxResults, int(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                      [](const Candidate &a, const Candidate &b) { return a.score > b.score; });
+
+    QVector<BibleSearchHit> hits;
+    hits.reserve(keep);
+    for (int i = 0; i < keep; ++i) {
+        const Candidate &candidate = candidates.at(i);
+        BibleSearchHit hit;
+        hit.verse.book = *candidate.bookName;
+        hit.verse.chapter = candidate.chapter;
+        hit.verse.verse = candidate.verse;
+        hit.verse.text = *candidate.text;
+        hit.verse.translation = translation.acronym();
+        hit.translationPath = translation.filePath();
+        hit.bookId = candidate.bookId;
+        hit.score = candidate.score;
+        hits.append(hit);
+    }
+    return hits;
+}
+
+QFuture<QVector<BibleSearchHit>> BibleManager::searchAllAsync(const QString &searchText, int maxResults) const
+{
+    // Every installed translation, preferring the resident copy; the rest are
+    // read for this search only. The workers share nothing but the snapshot.
+    QStringList paths = getAvailableBibles();
+    const std::shared_ptr<const ResidentMap> translations = residentSnapshot();
+    for (auto it = translations->constBegin(); it != translations->constEnd(); ++it) {
+        if (!paths.contains(it.key())) {
+            paths.append(it.key());
+        }
+    }
+    if (searchText.isEmpty() || maxResults <= 0) {
+        paths.clear();
+    }
+
+    return QtConcurrent::mappedReduced<QVector<BibleSearchHit>>(
+        paths,
+        [translations, searchText, maxResults](const QString &path) {
+            std::shared_ptr<const BibleTranslation> translation = translations->value(path);
+            if (!translation) {
+                translation = BibleTranslation::load(path);
+            }
+            return translation ? searchTranslation(*translation, searchText, maxResults)
+                               : QVector<BibleSearchHit>();
+        },
+        [maxResults](QVector<BibleSearchHit> &merged, const QVector<BibleSearchHit> &hits) {
+            merged += hits;
+            keepTopHits(merged, maxResults);
+        });
+}
+
 int BibleManager::getChapterCount(const QString &book) const
 {
-    QString normalizedBook = normalizeBookName(book);
-    
-    if (books.contains(normalizedBook)) {
-        return books[normalizedBook].chapters.size();
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return 0;
     }
-    
-    return 0;
+
+    const BibleBook *bibleBook = translation->book(bookIdIn(translation.get(), book));
+    return bibleBook ? bibleBook->chapters.size() : 0;
 }
 
 int BibleManager::getVerseCount(const QString &book, int chapter) const
 {
-    QString normalizedBook = normalizeBookName(book);
-    
-    if (books.contains(normalizedBook)) {
-        const BibleBook &bibleBook = books[normalizedBook];
-        if (bibleBook.chapters.contains(chapter)) {
-            return bibleBook.chapters[chapter].size();
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return 0;
+    }
+
+    const BibleBook *bibleBook = translation->book(bookIdIn(translation.get(), book));
+    if (bibleBook) {
+        auto chapterIt = bibleBook->chapters.constFind(chapter);
+        if (chapterIt != bibleBook->chapters.constEnd()) {
+            return chapterIt.value().size();
         }
     }
     
@@ -509,43 +615,32 @@ int BibleManager::getVerseCount(const QString &book, int chapter) const
 QStringList BibleManager::autocompleteBook(const QString &partial) const
 {
     QStringList matches;
-    QString lowerPartial = partial.toLower();
-    
-    // Check full names
-    for (const QString &bookName : books.keys()) {
-        if (bookName.toLower().startsWith(lowerPartial)) {
-            matches.append(bookName);
-        }
+    const std::shared_ptr<const BibleTranslation> translation = snapshot();
+    if (!translation) {
+        return matches;
     }
-    
-    // Check aliases
-    for (auto it = bookAliases.constBegin(); it != bookAliases.constEnd(); ++it) {
-        if (it.key().startsWith(lowerPartial) && books.contains(it.value())) {
-            if (!matches.contains(it.value())) {
-                matches.append(it.value());
-            }
-        }
+    for (int bookId : translation->completeBookName(partial)) {
+        matches.append(translation->bookName(bookId));
     }
-    
     return matches;
 }
 
-QString BibleManager::normalizeBookName(const QString &name) const
+int BibleManager::resolveBookId(const QString &name) const
 {
-    QString lower = name.toLower().trimmed();
-    
-    // Check if it's an alias
-    if (bookAliases.contains(lower)) {
-        return bookAliases[lower];
-    }
-    
-    // Check if it matches a book name (case-insensitive)
-    for (const QString &bookName : books.keys()) {
-        if (bookName.toLower() == lower) {
-            return bookName;
-        }
+    return bookIdIn(snapshot().get(), name);
+}
+
+int BibleManager::bookIdIn(const BibleTranslation *translation, const QString &name)
+{
+    // The translation's table holds its own names followed by the shared
+    // canonical names and abbreviations (gen, exo, jhn, ...)
+    return translation ? translation->bookIdForName(name) : BibleTranslation::canonicalBookId(name);
+}
+
+QString BibleManager::bookNameIn(const BibleTranslation *translation, int bookId)
+{
+    if (translation && translation->hasBook(bookId)) {
+        return translation->bookName(bookId);
     }
-    
-    // Return as-is if no match
-    return name;
+    return BibleTranslation::canonicalBookName(bookId);
 }
@@ -6,41 +6,77 @@
 #include <QMap>
 #include <QVector>
 #include <QStringList>
+#include <QFuture>
+#include <memory>
+#include "BibleTranslation.h"
+#include "ScriptureReference.h"
 
-struct BibleVerse {
-    QString book;
-    int chapter;
-    int verse;
-    QString text;
-    
-    QString reference() const {
-        return QString("%1 %2:%3").arg(book).arg(chapter).arg(verse);
-    }
+// The same passage taken from one resident translation
+struct BibleParallelPassage {
+    QString translationPath;
+    QString translation;
+    QString acronym;
+    QVector<BibleVerse> verses;
 };
 
-struct BibleBook {
-    QString name;
-    QMap<int, QMap<int, QString>> chapters; // chapter -> verse -> text
+// One verse found by searchAllAsync, tagged with the translation it came from
+struct BibleSearchHit {
+    BibleVerse verse; // verse.translation holds the acronym
+    QString translationPath;
+    int bookId = 0;
+    int score = 0;
 };
 
+// Translations are immutable once loaded and are published as shared
+// snapshots: a load swaps the current pointer (and the resident map) with
+// std::atomic_store, and every lookup works on the snapshot it took on
+// entry. Lookups are therefore safe from worker threads without locks and
+// never see a half-loaded translation. Loads and signals stay on the thread
+// that owns the manager.
+
 class BibleManager : public QObject
 {
     Q_OBJECT
 
 public:
+    using ResidentMap = QMap<QString, std::shared_ptr<const BibleTranslation>>; // file path -> translation
+
     explicit BibleManager(QObject *parent = nullptr);
     ~BibleManager();
     
-    // Load Bible from XML file
+    // Load Bible from XML file and make it the current translation. Files
+    // that are already resident are switched to without re-reading them.
     bool loadBible(const QString &filePath);
+
+    // Same as loadBible, but reads a non-resident file on the thread pool.
+    // The previous translation keeps answering lookups until the new one is
+    // published; bibleLoaded or bibleLoadError is emitted when done. A newer
+    // loadBible/loadBibleAsync call supersedes a load still in flight.
+    void loadBibleAsync(const QString &filePath);
+
+    // The translation lookups currently use; hold on to it to read a
+    // consistent translation across several calls
+    std::shared_ptr<const BibleTranslation> snapshot() const;
+    std::shared_ptr<const ResidentMap> residentSnapshot() const;
+    std::shared_ptr<const BibleTranslation> residentTranslation(const QString &filePath) const;
+
+    // Load several Bibles in parallel on the global thread pool so they stay
+    // resident next to the current one. Each becomes resident as soon as it
+    // finishes; files that fail to load are skipped with a warning.
+    void preloadBibles(const QStringList &filePaths);
+    bool isResident(const QString &filePath) const { return residentSnapshot()->contains(filePath); }
+    // Drops the resident copy of a file that was replaced on disk (and the
+    // current translation, if it is that file) so the next load re-reads it
+    void unloadBible(const QString &filePath);
+    QStringList residentBiblePaths() const { return residentSnapshot()->keys(); }
     
     // Get list of available Bibles
     QStringList getAvailableBibles() const;
     
     // Get current Bible translation name
-    QString getCurrentTranslation() const { return currentTranslation; }
+    QString getCurrentTranslation() const;
     // Get short acronym for the current Bible translation (e.g., NKJV, NASB, AMP)
-    QString getCurrentTranslationAcronym() const { return currentTranslationAcronym; }
+    QString getCurrentTranslationAcronym() const;
     
     // Get list of book names
     QStringList getBookNames() const;
@@ -50,12 +86,35 @@ public:
     
     // Get multiple verses
     QVector<BibleVerse> getVerses(const QString &book, int chapter, int startVerse, int endVerse) const;
+
+    // Get the same passage from several resident translations in one call
+    // (all resident translations when translationPaths is empty). The book
+    // is resolved once against the current translation and matched across
+    // translations by canonical book ID, so localised names line up.
+    QVector<BibleParallelPassage> getParallelVerses(const QStringList &translationPaths, const QString &book,
+                                                    int chapter, int startVerse, int endVerse) const;
     
-    // Parse reference string (e.g., "John 3:16" or "John 3:16-18")
+    // Parse a full reference such as "John 3:16,18; 4:1-3", "Gen 1:26-2:3",
+    // "Ps 23" or "1st John 2:1" into spans. Does not allocate, so it is safe
+    // to call on every keystroke; see ScriptureReference::Status for partial input.
+    bool parseReference(QStringView text, ScriptureReference &result) const;
+
+    // Parse reference string (e.g., "John 3:16" or "John 3:16-18"). Only the
+    // first span is returned; whole chapters give verses 1-999.
     bool parseReference(const QString &reference, QString &book, int &chapter, int &startVerse, int &endVerse) const;
+
+    // All verses covered by a parsed reference, in the order given
+    QVector<BibleVerse> getVerses(const ScriptureReference &reference) const;
     
     // Search for verses containing text
     QVector<BibleVerse> search(const QString &searchText, int maxResults = 50) const;
+
+    // Search every available translation at once, one translation per
+    // thread-pool task, and merge the best maxResults hits. Whole-word,
+    // exact-case matches in verses the phrase makes up most of rank first,
+    // so a quoted phrase finds the version it came from. The future can be
+    // cancelled.
+    QFuture<QVector<BibleSearchHit>> searchAllAsync(const QString &searchText, int maxResults = 50) const;
     
     // Get chapter count for a book
     int getChapterCount(const QString &book) const;
@@ -63,9 +122,13 @@ public:
     // Get verse count for a chapter
     int getVerseCount(const QString &book, int chapter) const;
     
-    // Autocomplete book names
+    // Autocomplete book names: the current translation's books whose names
+    // or abbreviations start with partial, in canonical order
     QStringList autocompleteBook(const QString &partial) const;
 
+    // Book ID for a local name, canonical name or abbreviation; 0 if unknown
+    int resolveBookId(const QString &name) const;
+
     static QString bibleDirectory();
 
 signals:
@@ -73,11 +136,19 @@ signals:
     void bibleLoadError(const QString &error);
 
 private:
-    QString normalizeBookName(const QString &name) const;
-    QString currentTranslation;
-    QString currentTranslationAcronym;
-    QMap<QString, BibleBook> books;
-    QMap<QString, QString> bookAliases; // Abbreviations to full names
+    static int bookIdIn(const BibleTranslation *translation, const QString &name);
+    static QString bookNameIn(const BibleTranslation *translation, int bookId);
+    void publish(const std::shared_ptr<const BibleTranslation> &translation);
+    void addResident(const std::shared_ptr<const BibleTranslation> &translation);
+    static QVector<BibleVerse> versesFrom(const BibleTranslation &translation, int bookId,
+                                          int chapter, int startVerse, int endVerse);
+    static QVector<BibleSearchHit> searchTranslation(const BibleTranslation &translation,
+                                                     const QString &searchText, int maxResults);
+
+    // Only accessed through std::atomic_load / std::atomic_store
+    std::shared_ptr<const BibleTranslation> current;
+    std::shared_ptr<const ResidentMap> resident;
+    QString pendingLoadPath; // latest loadBibleAsync request still in flight
 };
 
 #endif // BIBLEMANAGER_H
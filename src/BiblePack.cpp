@@ -0,0 +1,178 @@
+#include "BiblePack.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace {
+
+static const char kPackMagic[] = "SPBP";
+static const quint32 kPackFormatVersion = 1;
+static const int kPackHeaderSize = 12; // magic + format version + index size
+
+} // namespace
+
+bool BiblePack::isPack(const QByteArray &data)
+{
+    return data.size() >= kPackHeaderSize && data.startsWith(kPackMagic);
+}
+
+bool BiblePack::readIndex(const QByteArray &data, Index &index, QString *errorString)
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) {
+            *errorString = message;
+        }
+        return false;
+    };
+
+    if (!isPack(data)) {
+        return fail(QStringLiteral("Not a compiled Bible pack"));
+    }
+
+    QDataStream header(data);
+    header.setVersion(QDataStream::Qt_6_0);
+    header.skipRawData(4);
+    quint32 formatVersion = 0;
+    quint32 indexSize = 0;
+    header >> formatVersion >> indexSize;
+    if (formatVersion != kPackFormatVersion) {
+        return fail(QString("Unsupported Bible pack version: %1").arg(formatVersion));
+    }
+    if (indexSize > static_cast<quint32>(data.size() - kPackHeaderSize)) {
+        return fail(QStringLiteral("Truncated Bible pack index"));
+    }
+
+    quint32 bookCount = 0;
+    header >> index.name >> index.acronym >> bookCount;
+    index.books.clear();
+    index.books.reserve(static_cast<int>(qMin<quint32>(bookCount, 256)));
+    index.dataOffset = kPackHeaderSize + static_cast<int>(indexSize);
+
+    for (quint32 i = 0; i < bookCount && header.status() == QDataStream::Ok; ++i) {
+        qint32 bookId = 0;
+        quint32 offset = 0;
+        quint32 size = 0;
+        BookEntry entry;
+        header >> bookId >> entry.name >> offset >> size;
+        entry.bookId = bookId;
+        entry.offset = static_cast<int>(offset);
+        entry.size = static_cast<int>(size);
+        if (static_cast<qint64>(index.dataOffset) + offset + size > data.size()) {
+            return fail(QString("Truncated Bible pack data for %1").arg(entry.name));
+        }
+        index.books.append(entry);
+    }
+
+    if (header.status() != QDataStream::Ok) {
+        return fail(QStringLiteral("Corrupt Bible pack index"));
+    }
+    return true;
+}
+
+bool BiblePack::unpackBook(const QByteArray &blob, BibleBook &book)
+{
+    const QByteArray raw = qUncompress(blob);
+    if (raw.isEmpty()) {
+        return false;
+    }
+
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_6_0);
+    in >> book.chapters;
+    return in.status() == QDataStream::Ok;
+}
+
+void BiblePackWriter::setTranslation(const QString &name, const QString &acronym)
+{
+    QMutexLocker locker(&mutex);
+    translationName = name;
+    translationAcronym = acronym;
+}
+
+void BiblePackWriter::addBook(int bookId, const BibleBook &book)
+{
+    QByteArray raw;
+    {
+        QDataStream out(&raw, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << book.chapters;
+    }
+
+    PackedBook packed;
+    packed.bookId = bookId;
+    packed.name = book.name;
+    packed.data = qCompress(raw, 9);
+
+    QMutexLocker locker(&mutex);
+    books.append(packed);
+}
+
+int BiblePackWriter::bookCount() const
+{
+    QMutexLocker locker(&mutex);
+    return books.size();
+}
+
+bool BiblePackWriter::save(const QString &filePath, QString *errorString) const
+{
+    QMutexLocker locker(&mutex);
+
+    // Books may have been added out of order by parallel importers
+    QVector<PackedBook> ordered = books;
+    std::stable_sort(ordered.begin(), ordered.end(), [](const PackedBook &a, const PackedBook &b) {
+        return a.bookId < b.bookId;
+    });
+
+    QByteArray index;
+    {
+        QDataStream out(&index, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << translationName << translationAcronym << static_cast<quint32>(ordered.size());
+        quint32 offset = 0;
+        for (const PackedBook &book : ordered) {
+            out << static_cast<qint32>(book.bookId) << book.name << offset << static_cast<quint32>(book.data.size());
+            offset += static_cast<quint32>(book.data.size());
+        }
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = QString("Cannot write file: %1").arg(filePath);
+        }
+        return false;
+    }
+
+    {
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_6_0);
+        out.writeRawData(kPackMagic, 4);
+        out << kPackFormatVersion << static_cast<quint32>(index.size());
+    }
+    file.write(index);
+    for (const PackedBook &book : ordered) {
+        file.write(book.data);
+    }
+
+    if (!file.commit()) {
+        if (errorString) {
+            *errorString = QString("Cannot write file: %1").arg(filePath);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool BiblePackWriter::writeTranslation(const BibleTranslation &translation, const QString &filePath,
+                                       QString *errorString)
+{
+    BiblePackWriter writer;
+    writer.setTranslation(translation.name(), translation.acronym());
+    for (int bookId : translation.bookIds()) {
+        if (const BibleBook *book = translation.book(bookId)) {
+            writer.addBook(bookId, *book);
+        }
+    }
+    return writer.save(filePath, errorString);
+}
@@ -0,0 +1,71 @@
+#ifndef BIBLEPACK_H
+#define BIBLEPACK_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include "BibleTranslation.h"
+
+// Compiled Bible format (.spbible). A small index of books followed by one
+// zlib-compressed blob per book, so a pack can be opened straight from
+// memory (including an uncompressed Qt resource) and each book inflated
+// only when it is first read.
+//
+//   "SPBP" | quint32 format version | quint32 index size | index | blobs
+//
+// The index is a QDataStream of translation name, acronym and, per book,
+// book ID, local name, blob offset (relative to the first blob) and size.
+class BiblePack
+{
+public:
+    struct BookEntry {
+        int bookId = 0;
+        QString name;
+        int offset = 0;
+        int size = 0;
+    };
+
+    struct Index {
+        QString name;
+        QString acronym;
+        QVector<BookEntry> books;
+        int dataOffset = 0; // where the first blob starts in the pack
+    };
+
+    static QString fileSuffix() { return QStringLiteral("spbible"); }
+    static bool isPack(const QByteArray &data);
+    static bool readIndex(const QByteArray &data, Index &index, QString *errorString = nullptr);
+    static bool unpackBook(const QByteArray &blob, BibleBook &book);
+};
+
+class BiblePackWriter
+{
+public:
+    void setTranslation(const QString &name, const QString &acronym);
+
+    // Compresses the book straight away and keeps only the packed bytes, so
+    // a writer fed one book at a time never holds more than one book of
+    // verse text. Safe to call from several threads at once.
+    void addBook(int bookId, const BibleBook &book);
+    int bookCount() const;
+
+    bool save(const QString &filePath, QString *errorString = nullptr) const;
+
+    static bool writeTranslation(const BibleTranslation &translation, const QString &filePath,
+                                 QString *errorString = nullptr);
+
+private:
+    struct PackedBook {
+        int bookId = 0;
+        QString name;
+        QByteArray data;
+    };
+
+    QString translationName;
+    QString translationAcronym;
+    QVector<PackedBook> books;
+    mutable QMutex mutex;
+};
+
+#endif // BIBLEPACK_H
@@ -6,11 +6,23 @@
 #include <QStringListModel>
 #include <QTimer>
 #include <QFileInfo>
+#include <QDir>
 #include <QFile>
 #include <QSettings>
 #include <QMenu>
 #include <QToolButton>
 #include <QSignalBlocker>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QTextBrowser>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include "BibleImporter.h"
+#include "BiblePack.h"
+#include "BibleVerseModel.h"
+#include "AddToPlaylistDelegate.h"
 
 BiblePanel::BiblePanel(QWidget *parent)
     : QWidget(parent)
@@ -35,9 +47,19 @@ BiblePanel::BiblePanel(QWidget *parent)
 
 BiblePanel::~BiblePanel()
 {
+    allTranslationsSearch.cancel();
+    allTranslationsSearch.waitForFinished();
 }
 
-void BiblePanel::activateVerse(const QString &reference)
+QString BiblePanel::currentTranslationName() const
+{
+    if (!projectedTranslation.isEmpty()) {
+        return projectedTranslation;
+    }
+    return bibleManager ? bibleManager->getCurrentTranslationAcronym() : QString();
+}
+
+void BiblePanel::activateVerse(const QString &reference, bool project)
 {
     // Set the reference in the search box
     referenceSearchEdit->setText(reference);
@@ -47,11 +69,15 @@ void BiblePanel::activateVerse(const QString &reference)
     // 2. Display them in the results list
     
     // Now project the verse immediately
+    if (!project) {
+        return;
+    }
     QString book;
     int chapter, startVerse, endVerse;
     if (bibleManager->parseReference(reference, book, chapter, startVerse, endVerse)) {
         QString verseText = bibleManager->getVerse(book, chapter, startVerse);
         if (!verseText.isEmpty()) {
+            projectedTranslation.clear();
             emit verseSelected(reference, verseText);
         }
     }
@@ -97,6 +123,27 @@ void BiblePanel::setupUI()
     translationCombo->setMaxVisibleItems(10); // Limit dropdown height
     translationCombo->setMaximumWidth(200); // Limit width
     translationLayout->addWidget(translationCombo);
+
+    importBibleButton = new QToolButton();
+    importBibleButton->setText("Import...");
+    importBibleButton->setToolTip("Import an OSIS, USFM or Zefania Bible");
+    importBibleButton->setPopupMode(QToolButton::InstantPopup);
+    QMenu *importMenu = new QMenu(importBibleButton);
+    importMenu->addAction("From File (OSIS or Zefania XML, USFM)...", this, [this]() {
+        const QString path = QFileDialog::getOpenFileName(this, "Import Bible", QString(),
+                                                          BibleImporter::fileDialogFilter());
+        if (!path.isEmpty()) {
+            importBible(path);
+        }
+    });
+    importMenu->addAction("From USFM Folder...", this, [this]() {
+        const QString path = QFileDialog::getExistingDirectory(this, "Import USFM Bible");
+        if (!path.isEmpty()) {
+            importBible(path);
+        }
+    });
+    importBibleButton->setMenu(importMenu);
+    translationLayout->addWidget(importBibleButton);
     translationLayout->addStretch(); // Push combo box to the left
     mainLayout->addLayout(translationLayout);
     
@@ -105,25 +152,40 @@ void BiblePanel::setupUI()
     mainLayout->addWidget(refSearchLabel);
     
     referenceSearchEdit = new QLineEdit();
-    referenceSearchEdit->setPlaceholderText("e.g., John 3:16 or John 3:16-18");
+    referenceSearchEdit->setPlaceholderText("e.g., John 3:16-18; 4:1, Gen 1:26-2:3 or Ps 23");
     mainLayout->addWidget(referenceSearchEdit);
     
     // Text search box
     QLabel *textSearchLabel = new QLabel("Search in Text:");
     mainLayout->addWidget(textSearchLabel);
     
+    QHBoxLayout *textSearchLayout = new QHBoxLayout();
     textSearchEdit = new QLineEdit();
     textSearchEdit->setPlaceholderText("Search for words in Bible text...");
-    mainLayout->addWidget(textSearchEdit);
+    textSearchLayout->addWidget(textSearchEdit);
+    allTranslationsCheck = new QCheckBox("All translations");
+    allTranslationsCheck->setToolTip("Search every installed Bible and rank the closest matches");
+    textSearchLayout->addWidget(allTranslationsCheck);
+    mainLayout->addLayout(textSearchLayout);
     
     // Results list
-    resultsList = new QListWidget();
+    resultsModel = new BibleVerseModel(this);
+    resultsList = new QListView();
+    resultsList->setModel(resultsModel);
+    resultsList->setUniformItemSizes(true);
     resultsList->setDragEnabled(true);
     resultsList->setContextMenuPolicy(Qt::CustomContextMenu);
     mainLayout->addWidget(resultsList);
+
+    // '+' on each row adds the verse to the playlist
+    AddToPlaylistDelegate *addDelegate = new AddToPlaylistDelegate(resultsList);
+    resultsList->setItemDelegate(addDelegate);
+    connect(addDelegate, &AddToPlaylistDelegate::addClicked, this, [this](const QModelIndex &index) {
+        emit addVerseToPlaylist(index.data(Qt::UserRole).toString());
+    });
     
     // Connect context menu
-    connect(resultsList, &QListWidget::customContextMenuRequested,
+    connect(resultsList, &QListView::customContextMenuRequested,
             this, &BiblePanel::onContextMenuRequested);
     
     // Control buttons
@@ -148,9 +210,14 @@ void BiblePanel::setupUI()
             this, &BiblePanel::onReferenceTextEdited);
     connect(textSearchEdit, &QLineEdit::textChanged,
             this, &BiblePanel::onTextSearchChanged);
-    connect(resultsList, &QListWidget::itemClicked,
+    connect(allTranslationsCheck, &QCheckBox::toggled, this, [this]() {
+        onTextSearchChanged(textSearchEdit->text());
+    });
+    connect(&allTranslationsSearch, &QFutureWatcherBase::finished,
+            this, &BiblePanel::onAllTranslationsSearchFinished);
+    connect(resultsList, &QListView::clicked,
             this, &BiblePanel::onSearchResultClicked);
-    connect(resultsList, &QListWidget::itemDoubleClicked,
+    connect(resultsList, &QListView::doubleClicked,
             this, &BiblePanel::onProjectClicked);  // Double-click to project
     connect(projectButton, &QPushButton::clicked,
             this, &BiblePanel::onProjectClicked);
@@ -190,6 +257,10 @@ void BiblePanel::loadBibles()
 
         if (translationCombo->count() > 0) {
             int index = translationCombo->findData(targetPath);
+            if (index < 0 && !targetPath.isEmpty()) {
+                // A default saved as a copied-out XML now served from the bundled pack
+                index = translationCombo->findText(QFileInfo(targetPath).baseName(), Qt::MatchFixedString);
+            }
             if (index < 0) {
                 index = 0;
             }
@@ -204,38 +275,57 @@ void BiblePanel::loadBibles()
             bibleManager->loadBible(selectedPath);
         }
     }
+
+    // Keep the other translations resident so switching and side-by-side
+    // lookups never go back to disk. They load in parallel off the GUI thread.
+    bibleManager->preloadBibles(bibles);
 }
 
 void BiblePanel::onReferenceSearchChanged(const QString &text)
 {
     if (text.isEmpty()) {
-        resultsList->clear();
+        resultsModel->clear();
         return;
     }
     
-    // Parse as reference only
-    QString book;
-    int chapter, startVerse, endVerse;
-    
-    if (bibleManager->parseReference(text, book, chapter, startVerse, endVerse)) {
-        // Get from startVerse to end of chapter (999)
-        QVector<BibleVerse> verses = bibleManager->getVerses(book, chapter, startVerse, 999);
+    // Parse as reference only. Runs on every keystroke, so partial input
+    // such as "John 3:" already lists the chapter.
+    ScriptureReference reference;
+    if (bibleManager->parseReference(QStringView(text), reference)) {
+        // A single passage inside one chapter lists from its first verse to
+        // the end of the chapter, so Next keeps reading on; lists and
+        // cross-chapter ranges list exactly what was asked for
+        ScriptureReference listed = reference;
+        const ScriptureSpan &first = reference.spans[0];
+        if (reference.spanCount == 1 && first.startChapter == first.endChapter) {
+            listed.spans[0].endVerse = 0;
+        }
+
+        QVector<BibleVerse> verses = bibleManager->getVerses(listed);
         currentVerses = verses;
         if (!verses.isEmpty()) {
-            currentBook = book;
-            currentChapter = chapter;
-            currentVerse = startVerse;
+            currentBook = verses.first().book;
+            currentChapter = verses.first().chapter;
+            currentVerse = verses.first().verse;
         }
         displayVerses(verses);
     } else {
-        resultsList->clear();
+        resultsModel->clear();
     }
 }
 
 void BiblePanel::onTextSearchChanged(const QString &text)
 {
+    // A newer query replaces any all-translations search still running
+    allTranslationsSearch.cancel();
+
+    if (!text.isEmpty() && allTranslationsCheck->isChecked()) {
+        allTranslationsSearch.setFuture(bibleManager->searchAllAsync(text, 50));
+        return;
+    }
+
     if (text.isEmpty()) {
-        resultsList->clear();
+        resultsModel->clear();
         currentVerses.clear();
         projectButton->setEnabled(false);
         nextButton->setEnabled(false);
@@ -263,12 +353,30 @@ void BiblePanel::onTextSearchChanged(const QString &text)
     displayVerses(results);
 }
 
-void BiblePanel::onSearchResultClicked(QListWidgetItem *item)
+void BiblePanel::onAllTranslationsSearchFinished()
+{
+    if (allTranslationsSearch.isCanceled() || allTranslationsSearch.future().resultCount() == 0) {
+        return;
+    }
+
+    QVector<BibleVerse> results;
+    for (const BibleSearchHit &hit : allTranslationsSearch.result()) {
+        results.append(hit.verse);
+    }
+    currentVerses = results;
+
+    projectButton->setEnabled(!results.isEmpty());
+    nextButton->setEnabled(results.size() > 1);
+    previousButton->setEnabled(false);
+    displayVerses(results);
+}
+
+void BiblePanel::onSearchResultClicked(const QModelIndex &index)
 {
-    if (!item) return;
+    if (!index.isValid()) return;
     
     // Just select the verse, don't reload the list
-    QString reference = item->data(Qt::UserRole).toString();
+    QString reference = index.data(Qt::UserRole).toString();
     
     // Parse to set current verse for navigation
     QString book;
@@ -286,35 +394,30 @@ void BiblePanel::onSearchResultClicked(QListWidgetItem *item)
 
 void BiblePanel::onProjectClicked()
 {
-    // Get the currently selected verse from the list
-    QListWidgetItem *item = resultsList->currentItem();
-    if (!item) return;
-    
-    QString reference = item->data(Qt::UserRole).toString();
-    
-    // Find the verse in currentVerses
-    for (const BibleVerse &verse : currentVerses) {
-        if (verse.reference() == reference) {
-            emit verseSelected(reference, verse.text);
-            return;
-        }
-    }
+    // Rows match currentVerses one to one; the same reference can appear
+    // once per translation in an all-translations search
+    const int row = resultsList->currentIndex().row();
+    if (row < 0 || row >= currentVerses.size()) return;
+
+    const BibleVerse &verse = currentVerses.at(row);
+    projectedTranslation = verse.translation;
+    emit verseSelected(verse.reference(), verse.text);
 }
 
 void BiblePanel::onNextVerse()
 {
-    int currentRow = resultsList->currentRow();
-    if (currentRow < resultsList->count() - 1) {
-        resultsList->setCurrentRow(currentRow + 1);
+    int currentRow = resultsList->currentIndex().row();
+    if (currentRow < resultsModel->rowCount() - 1) {
+        resultsList->setCurrentIndex(resultsModel->index(currentRow + 1));
         onProjectClicked();  // Project the next verses
     }
 }
 
 void BiblePanel::onPreviousVerse()
 {
-    int currentRow = resultsList->currentRow();
+    int currentRow = resultsList->currentIndex().row();
     if (currentRow > 0) {
-        resultsList->setCurrentRow(currentRow - 1);
+        resultsList->setCurrentIndex(resultsModel->index(currentRow - 1));
         onProjectClicked();  // Project the previous verses
     }
 }
@@ -354,7 +457,9 @@ void BiblePanel::onTranslationChanged(int index)
     
     QString biblePath = translationCombo->itemData(index).toString();
     defaultBiblePath = biblePath;
-    bibleManager->loadBible(biblePath);
+    // Verses on screen keep resolving against the previous translation
+    // until the new one is ready
+    bibleManager->loadBibleAsync(biblePath);
 }
 
 void BiblePanel::refreshAvailableBibles()
@@ -367,6 +472,49 @@ void BiblePanel::refreshAvailableBibles()
     loadBibles();
 }
 
+void BiblePanel::importBible(const QString &sourcePath)
+{
+    const QFileInfo sourceInfo(sourcePath);
+    const QString baseName = sourceInfo.isDir() ? sourceInfo.fileName() : sourceInfo.completeBaseName();
+    const QString packPath = QDir(BibleManager::bibleDirectory())
+        .absoluteFilePath(QString("%1.%2").arg(baseName, BiblePack::fileSuffix()));
+
+    if (QFile::exists(packPath) &&
+        QMessageBox::question(this, "Import Bible",
+                              QString("A Bible named \"%1\" already exists. Replace it?").arg(baseName))
+            != QMessageBox::Yes) {
+        return;
+    }
+
+    // Large study Bibles take a few seconds; keep the panel responsive
+    importBibleButton->setEnabled(false);
+    importBibleButton->setText("Importing...");
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, packPath]() {
+        watcher->deleteLater();
+        importBibleButton->setEnabled(true);
+        importBibleButton->setText("Import...");
+
+        const QString error = watcher->result();
+        if (!error.isEmpty()) {
+            QMessageBox::warning(this, "Import Bible", QString("Failed to import Bible:\n%1").arg(error));
+            return;
+        }
+        // A replaced Bible must not keep showing its old text
+        bibleManager->unloadBible(packPath);
+        defaultBiblePath = packPath;
+        loadBibles();
+    });
+    watcher->setFuture(QtConcurrent::run([sourcePath, packPath]() {
+        QString error;
+        if (!BibleImporter::importBible(sourcePath, packPath, &error) && error.isEmpty()) {
+            error = QString("Unknown error importing %1").arg(sourcePath);
+        }
+        return error;
+    }));
+}
+
 void BiblePanel::parseAndDisplayVerse(const QString &reference)
 {
     QString book;
@@ -393,58 +541,70 @@ void BiblePanel::parseAndDisplayVerse(const QString &reference)
 
 void BiblePanel::displayVerses(const QVector<BibleVerse> &verses)
 {
-    resultsList->clear();
-    
-    for (const BibleVerse &verse : verses) {
-        QString displayText = QString("%1 - %2").arg(verse.reference()).arg(verse.text);
-        QListWidgetItem *item = new QListWidgetItem();
-        item->setData(Qt::UserRole, verse.reference());
-        item->setToolTip(verse.text);
-        resultsList->addItem(item);
-
-        QWidget *rowWidget = new QWidget(resultsList);
-        QHBoxLayout *rowLayout = new QHBoxLayout(rowWidget);
-        rowLayout->setContentsMargins(4, 0, 4, 0);
-        QToolButton *addButton = new QToolButton(rowWidget);
-        addButton->setText("+");
-        addButton->setFixedWidth(24);
-        addButton->setAutoRaise(true);
-        addButton->setToolTip("Add to playlist");
-        QLabel *label = new QLabel(displayText, rowWidget);
-        label->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-        // Place the '+' button on the left, verse text on the right.
-        rowLayout->addWidget(addButton);
-        rowLayout->addWidget(label);
-        rowWidget->setLayout(rowLayout);
-        resultsList->setItemWidget(item, rowWidget);
-
-        connect(addButton, &QToolButton::clicked, this, [this, reference = verse.reference()]() {
-            emit addVerseToPlaylist(reference);
-        });
-    }
+    resultsModel->setVerses(verses);
     
     // Don't auto-select when displaying - let user click
     if (!verses.isEmpty()) {
-        resultsList->setCurrentRow(0);
+        resultsList->setCurrentIndex(resultsModel->index(0));
     }
 }
 
 void BiblePanel::onContextMenuRequested(const QPoint &pos)
 {
-    QListWidgetItem *item = resultsList->itemAt(pos);
-    if (!item) return;
+    const QModelIndex item = resultsList->indexAt(pos);
+    if (!item.isValid()) return;
     
     QMenu contextMenu(this);
     QAction *addToPlaylistAction = contextMenu.addAction("Add to Playlist");
     QAction *projectAction = contextMenu.addAction("Project");
+    QAction *compareAction = contextMenu.addAction("Compare Translations");
+    compareAction->setEnabled(bibleManager->residentBiblePaths().size() > 1);
     
     QAction *selectedAction = contextMenu.exec(resultsList->mapToGlobal(pos));
     
     if (selectedAction == addToPlaylistAction) {
-        QString reference = item->data(Qt::UserRole).toString();
+        QString reference = item.data(Qt::UserRole).toString();
         emit addVerseToPlaylist(reference);
     } else if (selectedAction == projectAction) {
         onSearchResultClicked(item);
         onProjectClicked();
+    } else if (selectedAction == compareAction) {
+        showTranslationComparison(item.data(Qt::UserRole).toString());
+    }
+}
+
+void BiblePanel::showTranslationComparison(const QString &reference)
+{
+    QString book;
+    int chapter, startVerse, endVerse;
+    if (!bibleManager->parseReference(reference, book, chapter, startVerse, endVerse)) {
+        return;
+    }
+
+    const QVector<BibleParallelPassage> passages =
+        bibleManager->getParallelVerses(QStringList(), book, chapter, startVerse, endVerse);
+
+    QString html;
+    for (const BibleParallelPassage &passage : passages) {
+        if (passage.verses.isEmpty()) {
+            continue;
+        }
+        html += QString("<p><b>%1</b><br/>").arg(passage.acronym.toHtmlEscaped());
+        for (const BibleVerse &verse : passage.verses) {
+            html += QString("<sup>%1</sup> %2 ").arg(verse.verse).arg(verse.text.toHtmlEscaped());
+        }
+        html += "</p>";
     }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(QString("Compare Translations - %1").arg(reference));
+    dialog.resize(600, 480);
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    QTextBrowser *browser = new QTextBrowser(&dialog);
+    browser->setHtml(html);
+    layout->addWidget(browser);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+    dialog.exec();
 }
@@ -3,12 +3,17 @@
 
 #include <QWidget>
 #include <QLineEdit>
-#include <QListWidget>
+#include <QListView>
 #include <QTextEdit>
 #include <QPushButton>
 #include <QComboBox>
+#include <QToolButton>
+#include <QCheckBox>
+#include <QFutureWatcher>
 #include "BibleManager.h"
 
+class BibleVerseModel;
+
 class BiblePanel : public QWidget
 {
     Q_OBJECT
@@ -17,11 +22,15 @@ public:
     explicit BiblePanel(QWidget *parent = nullptr);
     ~BiblePanel();
     
-    // Public method to activate a verse from playlist
-    void activateVerse(const QString &reference);
+    // Public method to activate a verse from playlist. With project false
+    // the verse is only looked up, for items that bring their own text.
+    void activateVerse(const QString &reference, bool project = true);
     void refreshAvailableBibles();
+    BibleManager *manager() const { return bibleManager; }
 
-    QString currentTranslationName() const { return bibleManager ? bibleManager->getCurrentTranslationAcronym() : QString(); }
+    // Translation of the verse last projected from this panel; results from an
+    // all-translations search can come from other than the current one
+    QString currentTranslationName() const;
 
 signals:
     void verseSelected(const QString &reference, const QString &text);
@@ -31,7 +40,7 @@ private slots:
     void onReferenceSearchChanged(const QString &text);
     void onReferenceTextEdited(const QString &text);
     void onTextSearchChanged(const QString &text);
-    void onSearchResultClicked(QListWidgetItem *item);
+    void onSearchResultClicked(const QModelIndex &index);
     void onProjectClicked();
     void onNextVerse();
     void onPreviousVerse();
@@ -44,13 +53,19 @@ private:
     void loadBibles();
     void parseAndDisplayVerse(const QString &reference);
     void displayVerses(const QVector<BibleVerse> &verses);
+    void showTranslationComparison(const QString &reference);
+    void importBible(const QString &sourcePath);
+    void onAllTranslationsSearchFinished();
     
     BibleManager *bibleManager;
     
     QComboBox *translationCombo;
+    QToolButton *importBibleButton;
     QLineEdit *referenceSearchEdit;
     QLineEdit *textSearchEdit;
-    QListWidget *resultsList;
+    QCheckBox *allTranslationsCheck;
+    QListView *resultsList;
+    BibleVerseModel *resultsModel;
     QPushButton *projectButton;
     QPushButton *previousButton;
     QPushButton *nextButton;
@@ -61,6 +76,8 @@ private:
     int currentVerse;
     QVector<BibleVerse> currentVerses;
     QString defaultBiblePath;
+    QString projectedTranslation; // acronym of the last projected all-translations hit
+    QFutureWatcher<QVector<BibleSearchHit>> allTranslationsSearch;
 };
 
 #endif // BIBLEPANEL_H
@@ -0,0 +1,658 @@
+#include "BibleTranslation.h"
+#include "BiblePack.h"
+#include "BookAliasTable.h"
+#include <QFile>
+#include <QResource>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+#include <QRegularExpression>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+struct CanonicalBook {
+    const char *code;
+    const char *name;
+};
+
+// USFM-style codes, in canonical order. Index + 1 is the book ID.
+static const CanonicalBook kCanonicalBooks[] = {
+    { "gen", "Genesis" },
+    { "exo", "Exodus" },
+    { "lev", "Leviticus" },
+    { "num", "Numbers" },
+    { "deu", "Deuteronomy" },
+    { "jos", "Joshua" },
+    { "jdg", "Judges" },
+    { "rut", "Ruth" },
+    { "1sa", "1 Samuel" },
+    { "2sa", "2 Samuel" },
+    { "1ki", "1 Kings" },
+    { "2ki", "2 Kings" },
+    { "1ch", "1 Chronicles" },
+    { "2ch", "2 Chronicles" },
+    { "ezr", "Ezra" },
+    { "neh", "Nehemiah" },
+    { "est", "Esther" },
+    { "job", "Job" },
+    { "psa", "Psalms" },
+    { "pro", "Proverbs" },
+    { "ecc", "Ecclesiastes" },
+    { "sng", "Song of Solomon" },
+    { "isa", "Isaiah" },
+    { "jer", "Jeremiah" },
+    { "lam", "Lamentations" },
+    { "ezk", "Ezekiel" },
+    { "dan", "Daniel" },
+    { "hos", "Hosea" },
+    { "jol", "Joel" },
+    { "amo", "Amos" },
+    { "oba", "Obadiah" },
+    { "jon", "Jonah" },
+    { "mic", "Micah" },
+    { "nam", "Nahum" },
+    { "hab", "Habakkuk" },
+    { "zep", "Zephaniah" },
+    { "hag", "Haggai" },
+    { "zec", "Zechariah" },
+    { "mal", "Malachi" },
+    { "mat", "Matthew" },
+    { "mrk", "Mark" },
+    { "luk", "Luke" },
+    { "jhn", "John" },
+    { "act", "Acts" },
+    { "rom", "Romans" },
+    { "1co", "1 Corinthians" },
+    { "2co", "2 Corinthians" },
+    { "gal", "Galatians" },
+    { "eph", "Ephesians" },
+    { "php", "Philippians" },
+    { "col", "Colossians" },
+    { "1th", "1 Thessalonians" },
+    { "2th", "2 Thessalonians" },
+    { "1ti", "1 Timothy" },
+    { "2ti", "2 Timothy" },
+    { "tit", "Titus" },
+    { "phm", "Philemon" },
+    { "heb", "Hebrews" },
+    { "jas", "James" },
+    { "1pe", "1 Peter" },
+    { "2pe", "2 Peter" },
+    { "1jn", "1 John" },
+    { "2jn", "2 John" },
+    { "3jn", "3 John" },
+    { "jud", "Jude" },
+    { "rev", "Revelation" }
+};
+
+static const int kCanonicalBookCount = sizeof(kCanonicalBooks) / sizeof(kCanonicalBooks[0]);
+
+// Common spellings that differ from the canonical name
+static const struct { const char *name; int bookId; } kCanonicalVariants[] = {
+    { "psalm", 19 },
+    { "song of songs", 22 },
+    { "canticles", 22 },
+    { "revelations", 66 },
+    { "revelation of john", 66 },
+    // Common abbreviations that are not a unique prefix of one book name
+    { "jn", 43 },
+    { "mt", 40 },
+    { "mk", 41 },
+    { "lk", 42 },
+    { "phil", 50 }
+};
+
+bool isTagBoundary(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '>' || ch == '/';
+}
+
+// Find the next "<tag" start tag at or after 'from', skipping longer tag
+// names that merely share the prefix (e.g. <biblename> when looking for <bible>).
+int findStartTag(const QByteArray &data, const QByteArray &tag, int from)
+{
+    const QByteArray needle = "<" + tag;
+    int pos = data.indexOf(needle, from);
+    while (pos >= 0) {
+        const int after = pos + needle.size();
+        if (after < data.size() && isTagBoundary(data.at(after))) {
+            return pos;
+        }
+        pos = data.indexOf(needle, after);
+    }
+    return -1;
+}
+
+// Parse the attributes of a single start tag such as
+// <BIBLEBOOK bnumber="1" bname="Genesis"> by closing it and running it
+// through QXmlStreamReader, so entities and quoting are handled properly.
+QXmlStreamAttributes parseStartTagAttributes(const QByteArray &declaration, const QByteArray &startTag)
+{
+    QByteArray element = startTag;
+    if (!element.endsWith("/>")) {
+        element.chop(1);
+        element.append("/>");
+    }
+
+    QXmlStreamReader reader(declaration + element);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            return reader.attributes();
+        }
+    }
+    return QXmlStreamAttributes();
+}
+
+QString bookNameFromAttributes(const QXmlStreamAttributes &attributes)
+{
+    // Try bname first (new format), then name (old format)
+    QString name = attributes.value("bname").toString();
+    if (name.isEmpty()) {
+        name = attributes.value("name").toString();
+    }
+    return name;
+}
+
+// Canonical names, codes and variants in lookup priority order
+QVector<QPair<QString, int>> canonicalNameList()
+{
+    QVector<QPair<QString, int>> names;
+    for (int i = 0; i < kCanonicalBookCount; ++i) {
+        names.append(qMakePair(QString::fromLatin1(kCanonicalBooks[i].name), i + 1));
+        names.append(qMakePair(QString::fromLatin1(kCanonicalBooks[i].code), i + 1));
+    }
+    for (const auto &variant : kCanonicalVariants) {
+        names.append(qMakePair(QString::fromLatin1(variant.name), variant.bookId));
+    }
+    return names;
+}
+
+} // namespace
+
+int BibleTranslation::canonicalBookCount()
+{
+    return kCanonicalBookCount;
+}
+
+QString BibleTranslation::canonicalBookName(int bookId)
+{
+    if (bookId < 1 || bookId > kCanonicalBookCount) {
+        return QString();
+    }
+    return QString::fromLatin1(kCanonicalBooks[bookId - 1].name);
+}
+
+QString BibleTranslation::canonicalBookCode(int bookId)
+{
+    if (bookId < 1 || bookId > kCanonicalBookCount) {
+        return QString();
+    }
+    return QString::fromLatin1(kCanonicalBooks[bookId - 1].code);
+}
+
+int BibleTranslation::canonicalBookId(QStringView nameOrCode)
+{
+    static const BookAliasTable aliases = [] {
+        BookAliasTable table;
+        table.build(canonicalNameList());
+        return table;
+    }();
+    return aliases.lookup(nameOrCode);
+}
+
+const BookNameTrie &BibleTranslation::canonicalBookNameTrie()
+{
+    static const BookNameTrie trie = [] {
+        BookNameTrie names;
+        for (const QPair<QString, int> &name : canonicalNameList()) {
+            names.insert(name.first, name.second);
+        }
+        return names;
+    }();
+    return trie;
+}
+
+std::shared_ptr<const BibleTranslation> BibleTranslation::load(const QString &filePath, QString *errorString)
+{
+    std::shared_ptr<BibleTranslation> translation(new BibleTranslation());
+    translation->path = filePath;
+
+    // Uncompressed resources (the bundled packs) are used in place, without
+    // copying them out of the executable's read-only data.
+    QResource resource(filePath);
+    if (filePath.startsWith(QLatin1Char(':')) && resource.isValid() &&
+        resource.compressionAlgorithm() == QResource::NoCompression && resource.data()) {
+        translation->source = QByteArray::fromRawData(reinterpret_cast<const char *>(resource.data()),
+                                                      static_cast<int>(resource.size()));
+    } else {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            if (errorString) {
+                *errorString = QString("Cannot open file: %1").arg(filePath);
+            }
+            return nullptr;
+        }
+        translation->source = file.readAll();
+        file.close();
+    }
+
+    const bool ok = BiblePack::isPack(translation->source)
+        ? translation->indexPack(errorString)
+        : translation->indexXml(errorString);
+    if (!ok) {
+        return nullptr;
+    }
+    translation->buildNameLookups();
+    return translation;
+}
+
+void BibleTranslation::buildNameLookups()
+{
+    // The translation's own (possibly localised) names come first so they
+    // win over canonical English names and codes that normalise the same
+    QVector<QPair<QString, int>> names;
+    for (const std::unique_ptr<BookSlot> &slot : bookSlots) {
+        names.append(qMakePair(slot->name, slot->bookId));
+    }
+    names += canonicalNameList();
+
+    nameTrie.clear();
+    for (const QPair<QString, int> &name : names) {
+        nameTrie.insert(name.first, name.second);
+    }
+    aliases.build(names);
+}
+
+bool BibleTranslation::indexPack(QString *errorString)
+{
+    BiblePack::Index index;
+    if (!BiblePack::readIndex(source, index, errorString)) {
+        return false;
+    }
+
+    packed = true;
+    translationName = index.name;
+    translationAcronym = index.acronym;
+    if (translationName.isEmpty() || translationAcronym.isEmpty()) {
+        readTranslationAttributes(index.name, QString());
+    }
+
+    for (const BiblePack::BookEntry &entry : index.books) {
+        if (BookSlot *slot = addBookSlot(entry.bookId, entry.name)) {
+            slot->payload = QByteArray::fromRawData(source.constData() + index.dataOffset + entry.offset, entry.size);
+        }
+    }
+    return true;
+}
+
+void BibleTranslation::readTranslationAttributes(const QString &biblename, const QString &translationCode)
+{
+    // Try biblename first (new format), then translation (old format)
+    translationName = biblename;
+    if (translationName.isEmpty()) {
+        translationName = translationCode;
+    }
+    if (translationName.isEmpty()) {
+        translationName = QFileInfo(path).baseName();
+    }
+
+    // Derive a short acronym for the translation (e.g., NKJV, NASB, AMP)
+    translationAcronym.clear();
+
+    auto normalizeLetters = [](const QString &input) {
+        QString lettersOnly;
+        for (const QChar &ch : input) {
+            if (ch.isLetter()) {
+                lettersOnly.append(ch.toUpper());
+            }
+        }
+        return lettersOnly;
+    };
+
+    // 1) Prefer the translation attribute if present (often already an acronym)
+    QString candidate = normalizeLetters(translationCode.trimmed());
+    if (!candidate.isEmpty() && candidate.length() <= 12) {
+        translationAcronym = candidate;
+    }
+
+    auto deriveFromName = [&](const QString &source) -> QString {
+        if (source.isEmpty()) {
+            return QString();
+        }
+
+        // Use text inside the last parentheses if available, e.g. "New King James (NKJV)"
+        int openIdx = source.lastIndexOf('(');
+        int closeIdx = source.lastIndexOf(')');
+        if (openIdx != -1 && closeIdx > openIdx + 1) {
+            QString inside = normalizeLetters(source.mid(openIdx + 1, closeIdx - openIdx - 1));
+            if (!inside.isEmpty() && inside.length() <= 12) {
+                return inside;
+            }
+        }
+
+        // Otherwise, take the last word and use its letters
+        QRegularExpression wordRe("[A-Za-z]+");
+        QRegularExpressionMatchIterator it = wordRe.globalMatch(source);
+        QString lastToken;
+        while (it.hasNext()) {
+            lastToken = it.next().captured(0);
+        }
+        if (!lastToken.isEmpty()) {
+            QString letters = normalizeLetters(lastToken);
+            if (letters.length() >= 2 && letters.length() <= 12) {
+                return letters;
+            }
+        }
+
+        return QString();
+    };
+
+    // 2) Fallback: derive from the file base name (often an acronym like AMP, NKJV, NASB)
+    if (translationAcronym.isEmpty()) {
+        translationAcronym = deriveFromName(QFileInfo(path).baseName());
+    }
+
+    // 3) Fallback: derive from the human-readable translation name
+    if (translationAcronym.isEmpty()) {
+        translationAcronym = deriveFromName(translationName);
+    }
+
+    // 4) Final fallback: use initials of each word
+    if (translationAcronym.isEmpty()) {
+        QStringList words = translationName.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        QString initials;
+        for (const QString &w : words) {
+            if (!w.isEmpty()) {
+                initials.append(w.at(0).toUpper());
+                if (initials.length() >= 8) {
+                    break;
+                }
+            }
+        }
+        translationAcronym = initials;
+    }
+
+    if (translationAcronym.isEmpty()) {
+        translationAcronym = translationName;
+    }
+}
+
+BibleTranslation::BookSlot *BibleTranslation::addBookSlot(int bnumber, const QString &bookName)
+{
+    const QString lowerName = bookName.toLower();
+    if (bookName.isEmpty() || bookIdByLowerName.contains(lowerName)) {
+        return nullptr;
+    }
+
+    // Prefer the explicit book number, then the canonical name, then the
+    // position in the file. Anything left over (apocrypha, unknown names
+    // past the canon) gets an ID outside the canonical range.
+    const int position = static_cast<int>(bookSlots.size()) + 1;
+    int bookId = 0;
+    if (bnumber > 0 && !slotByBookId.contains(bnumber)) {
+        bookId = bnumber;
+    }
+    if (bookId == 0) {
+        const int canonicalId = canonicalBookId(bookName);
+        if (canonicalId > 0 && !slotByBookId.contains(canonicalId)) {
+            bookId = canonicalId;
+        }
+    }
+    if (bookId == 0 && position <= kCanonicalBookCount && !slotByBookId.contains(position)) {
+        bookId = position;
+    }
+    if (bookId == 0) {
+        bookId = 1000 + position;
+    }
+
+    std::unique_ptr<BookSlot> slot(new BookSlot());
+    slot->bookId = bookId;
+    slot->name = bookName;
+    slot->book.name = bookName;
+
+    slotByBookId.insert(bookId, static_cast<int>(bookSlots.size()));
+    bookIdByLowerName.insert(lowerName, bookId);
+    bookSlots.push_back(std::move(slot));
+    return bookSlots.back().get();
+}
+
+bool BibleTranslation::indexXml(QString *errorString)
+{
+    // UTF-16 sources cannot be sliced on ASCII tag bytes; parse them in one go.
+    if (source.startsWith("\xFF\xFE") || source.startsWith("\xFE\xFF")) {
+        return parseXmlEagerly(errorString);
+    }
+
+    int searchFrom = source.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    if (source.mid(searchFrom, 5) == "<?xml") {
+        const int declEnd = source.indexOf("?>", searchFrom);
+        if (declEnd > 0) {
+            xmlDeclaration = source.mid(searchFrom, declEnd + 2 - searchFrom);
+            searchFrom = declEnd + 2;
+        }
+    }
+
+    // Support both formats: <XMLBIBLE> and <bible>
+    QByteArray bookTag = "BIBLEBOOK";
+    int rootPos = findStartTag(source, "XMLBIBLE", searchFrom);
+    if (rootPos < 0) {
+        rootPos = findStartTag(source, "bible", searchFrom);
+        bookTag = "book";
+    }
+    if (rootPos < 0) {
+        return parseXmlEagerly(errorString);
+    }
+
+    const int rootEnd = source.indexOf('>', rootPos);
+    if (rootEnd < 0) {
+        return parseXmlEagerly(errorString);
+    }
+    const QXmlStreamAttributes rootAttributes =
+        parseStartTagAttributes(xmlDeclaration, source.mid(rootPos, rootEnd + 1 - rootPos));
+    readTranslationAttributes(rootAttributes.value("biblename").toString(),
+                              rootAttributes.value("translation").toString());
+
+    // Record where each book lives; its verses are parsed on first use.
+    const QByteArray closeTag = "</" + bookTag + ">";
+    int pos = findStartTag(source, bookTag, rootEnd + 1);
+    while (pos >= 0) {
+        const int tagEnd = source.indexOf('>', pos);
+        if (tagEnd < 0) {
+            break;
+        }
+
+        const QByteArray startTag = source.mid(pos, tagEnd + 1 - pos);
+        int bookEnd = tagEnd + 1;
+        if (!startTag.endsWith("/>")) {
+            const int closePos = source.indexOf(closeTag, tagEnd + 1);
+            if (closePos < 0) {
+                if (errorString) {
+                    *errorString = QString("XML parse error: unterminated <%1> in %2")
+                                       .arg(QString::fromLatin1(bookTag), path);
+                }
+                return false;
+            }
+            bookEnd = closePos + closeTag.size();
+        }
+
+        const QXmlStreamAttributes attributes = parseStartTagAttributes(xmlDeclaration, startTag);
+        if (BookSlot *slot = addBookSlot(attributes.value("bnumber").toInt(), bookNameFromAttributes(attributes))) {
+            // Shares the bytes of 'source', which is never modified after load
+            slot->payload = QByteArray::fromRawData(source.constData() + pos, bookEnd - pos);
+        }
+
+        pos = findStartTag(source, bookTag, bookEnd);
+    }
+
+    if (bookSlots.empty()) {
+        // Unknown layout: let the full parser decide whether it is valid.
+        return parseXmlEagerly(errorString);
+    }
+    return true;
+}
+
+bool BibleTranslation::parseXmlEagerly(QString *errorString)
+{
+    QXmlStreamReader xml(source);
+    BookSlot *currentBook = nullptr;
+    int currentChapter = 0;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isStartElement()) {
+            // Support both formats: <XMLBIBLE> and <bible>
+            if (xml.name() == QString("XMLBIBLE") || xml.name() == QString("bible")) {
+                readTranslationAttributes(xml.attributes().value("biblename").toString(),
+                                          xml.attributes().value("translation").toString());
+            }
+            // Support both formats: <BIBLEBOOK> and <book>
+            else if (xml.name() == QString("BIBLEBOOK") || xml.name() == QString("book")) {
+                const QString bookName = bookNameFromAttributes(xml.attributes());
+                currentBook = addBookSlot(xml.attributes().value("bnumber").toInt(), bookName);
+                if (!currentBook && !bookName.isEmpty()) {
+                    // Same book split across several elements: keep appending to it
+                    const int bookId = bookIdByLowerName.value(bookName.toLower());
+                    currentBook = bookSlots[slotByBookId.value(bookId)].get();
+                }
+            }
+            // Support both formats: <CHAPTER> and <chapter>
+            else if (xml.name() == QString("CHAPTER") || xml.name() == QString("chapter")) {
+                // Try cnumber first (new format), then number (old format)
+                currentChapter = xml.attributes().value("cnumber").toInt();
+                if (currentChapter == 0) {
+                    currentChapter = xml.attributes().value("number").toInt();
+                }
+            }
+            // Support both formats: <VERS> and <verse>
+            else if (xml.name() == QString("VERS") || xml.name() == QString("verse")) {
+                // Try vnumber first (new format), then number (old format)
+                int verseNumber = xml.attributes().value("vnumber").toInt();
+                if (verseNumber == 0) {
+                    verseNumber = xml.attributes().value("number").toInt();
+                }
+                QString verseText = xml.readElementText().trimmed();
+
+                if (currentBook && currentChapter > 0 && verseNumber > 0) {
+                    currentBook->book.chapters[currentChapter][verseNumber] = verseText;
+                }
+            }
+        }
+    }
+
+    if (xml.hasError()) {
+        if (errorString) {
+            *errorString = QString("XML parse error: %1").arg(xml.errorString());
+        }
+        return false;
+    }
+
+    if (translationName.isEmpty()) {
+        readTranslationAttributes(QString(), QString());
+    }
+
+    // Everything is already parsed; mark each book as materialised.
+    for (const std::unique_ptr<BookSlot> &slot : bookSlots) {
+        std::call_once(slot->materialised, []() {});
+    }
+    source.clear();
+    return true;
+}
+
+void BibleTranslation::materialise(const BookSlot &slot) const
+{
+    if (packed) {
+        if (!BiblePack::unpackBook(slot.payload, slot.book)) {
+            qWarning() << "BibleTranslation: corrupt book" << slot.name << "in" << path;
+        }
+        return;
+    }
+
+    QXmlStreamReader xml(xmlDeclaration + slot.payload);
+
+    int currentChapter = 0;
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (!xml.isStartElement()) {
+            continue;
+        }
+        if (xml.name() == QString("CHAPTER") || xml.name() == QString("chapter")) {
+            currentChapter = xml.attributes().value("cnumber").toInt();
+            if (currentChapter == 0) {
+                currentChapter = xml.attributes().value("number").toInt();
+            }
+        } else if (xml.name() == QString("VERS") || xml.name() == QString("verse")) {
+            int verseNumber = xml.attributes().value("vnumber").toInt();
+            if (verseNumber == 0) {
+                verseNumber = xml.attributes().value("number").toInt();
+            }
+            QString verseText = xml.readElementText().trimmed();
+
+            if (currentChapter > 0 && verseNumber > 0) {
+                slot.book.chapters[currentChapter][verseNumber] = verseText;
+            }
+        }
+    }
+
+    if (xml.hasError() && xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        qWarning() << "BibleTranslation: XML error in" << slot.name << "of" << path << ":" << xml.errorString();
+    }
+}
+
+QVector<int> BibleTranslation::bookIds() const
+{
+    QVector<int> ids;
+    ids.reserve(static_cast<int>(bookSlots.size()));
+    for (const std::unique_ptr<BookSlot> &slot : bookSlots) {
+        ids.append(slot->bookId);
+    }
+    return ids;
+}
+
+QStringList BibleTranslation::bookNames() const
+{
+    QStringList names;
+    names.reserve(static_cast<int>(bookSlots.size()));
+    for (const std::unique_ptr<BookSlot> &slot : bookSlots) {
+        names.append(slot->name);
+    }
+    return names;
+}
+
+QString BibleTranslation::bookName(int bookId) const
+{
+    auto it = slotByBookId.constFind(bookId);
+    if (it == slotByBookId.constEnd()) {
+        return QString();
+    }
+    return bookSlots[it.value()]->name;
+}
+
+int BibleTranslation::bookIdForName(QStringView name) const
+{
+    return aliases.lookup(name);
+}
+
+QVector<int> BibleTranslation::completeBookName(QStringView prefix) const
+{
+    QVector<int> bookIds = nameTrie.completions(prefix);
+    bookIds.erase(std::remove_if(bookIds.begin(), bookIds.end(),
+                                 [this](int bookId) { return !hasBook(bookId); }),
+                  bookIds.end());
+    return bookIds;
+}
+
+const BibleBook *BibleTranslation::book(int bookId) const
+{
+    auto it = slotByBookId.constFind(bookId);
+    if (it == slotByBookId.constEnd()) {
+        return nullptr;
+    }
+
+    const BookSlot &slot = *bookSlots[it.value()];
+    std::call_once(slot.materialised, [this, &slot]() { materialise(slot); });
+    return &slot.book;
+}
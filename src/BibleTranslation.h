@@ -0,0 +1,109 @@
+#ifndef BIBLETRANSLATION_H
+#define BIBLETRANSLATION_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMap>
+#include <QHash>
+#include <QVector>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "BookNameTrie.h"
+#include "BookAliasTable.h"
+
+struct BibleVerse {
+    QString book;
+    int chapter;
+    int verse;
+    QString text;
+    QString translation; // acronym, set when results mix several translations
+
+    QString reference() const {
+        return QString("%1 %2:%3").arg(book).arg(chapter).arg(verse);
+    }
+};
+
+struct BibleBook {
+    QString name;
+    QMap<int, QMap<int, QString>> chapters; // chapter -> verse -> text
+};
+
+// One loaded Bible translation, read from either Bible XML or a compiled
+// .spbible pack. Instances are shared between every caller that has the
+// same file resident and are never modified after load(): the book index
+// is built up front, while the verse text of each book is only parsed (or
+// inflated) the first time that book is requested.
+class BibleTranslation
+{
+public:
+    // Canonical (Protestant, 66 book) table shared by every translation.
+    // Book IDs are 1-based and stable across translations, so the same ID
+    // addresses "John" in NKJV and "Johannes" in a German Bible.
+    static int canonicalBookCount();
+    static QString canonicalBookName(int bookId);
+    static QString canonicalBookCode(int bookId);
+    static int canonicalBookId(QStringView nameOrCode);
+    // Canonical names, codes and common abbreviations, for when no
+    // translation is loaded
+    static const BookNameTrie &canonicalBookNameTrie();
+
+    static std::shared_ptr<const BibleTranslation> load(const QString &filePath, QString *errorString = nullptr);
+
+    QString filePath() const { return path; }
+    QString name() const { return translationName; }
+    QString acronym() const { return translationAcronym; }
+
+    // Book IDs and names in the order they appear in the source file
+    QVector<int> bookIds() const;
+    QStringList bookNames() const;
+
+    bool hasBook(int bookId) const { return slotByBookId.contains(bookId); }
+    QString bookName(int bookId) const;
+
+    // Book name lookups cover this translation's own names (including
+    // localised bname attributes) followed by the canonical names, codes and
+    // abbreviations. Matching ignores case, '.' and extra whitespace.
+    int bookIdForName(QStringView name) const;
+    // Books present in this translation with a name starting with prefix
+    QVector<int> completeBookName(QStringView prefix) const;
+    const BookNameTrie &bookNameTrie() const { return nameTrie; }
+
+    // Returns nullptr when the translation has no such book. The first call
+    // for a given book parses its verses; later calls are a plain lookup.
+    const BibleBook *book(int bookId) const;
+
+private:
+    struct BookSlot {
+        int bookId = 0;
+        QString name;
+        QByteArray payload; // XML fragment or compressed pack blob holding just this book
+        mutable std::once_flag materialised;
+        mutable BibleBook book;
+    };
+
+    BibleTranslation() = default;
+
+    bool indexXml(QString *errorString);
+    bool indexPack(QString *errorString);
+    bool parseXmlEagerly(QString *errorString);
+    void readTranslationAttributes(const QString &biblename, const QString &translationCode);
+    BookSlot *addBookSlot(int bnumber, const QString &bookName);
+    void materialise(const BookSlot &slot) const;
+    void buildNameLookups();
+
+    QString path;
+    QString translationName;
+    QString translationAcronym;
+    QByteArray source;
+    QByteArray xmlDeclaration;
+    bool packed = false;
+    std::vector<std::unique_ptr<BookSlot>> bookSlots;
+    QHash<int, int> slotByBookId;           // book ID -> index into bookSlots
+    QHash<QString, int> bookIdByLowerName;  // lower-cased local name -> book ID, while indexing
+    BookNameTrie nameTrie;
+    BookAliasTable aliases;
+};
+
+#endif // BIBLETRANSLATION_H
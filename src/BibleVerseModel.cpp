@@ -0,0 +1,57 @@
+#include "BibleVerseModel.h"
+
+BibleVerseModel::BibleVerseModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void BibleVerseModel::setVerses(const QVector<BibleVerse> &verses)
+{
+    beginResetModel();
+    verseList = verses;
+    endResetModel();
+}
+
+void BibleVerseModel::clear()
+{
+    if (verseList.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    verseList.clear();
+    endResetModel();
+}
+
+int BibleVerseModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : verseList.size();
+}
+
+QVariant BibleVerseModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= verseList.size()) {
+        return QVariant();
+    }
+
+    const BibleVerse &verse = verseList[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+        return verse.translation.isEmpty()
+            ? QString("%1 - %2").arg(verse.reference(), verse.text)
+            : QString("%1 (%2) - %3").arg(verse.reference(), verse.translation, verse.text);
+    case Qt::ToolTipRole:
+        return verse.text;
+    case Qt::UserRole:
+        return verse.reference();
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags BibleVerseModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+}
@@ -0,0 +1,31 @@
+#ifndef BIBLEVERSEMODEL_H
+#define BIBLEVERSEMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "BibleTranslation.h"
+
+// Verse list behind the Bible panel's results: a looked-up chapter or the
+// hits of a text search. Rows are drawn from the verses on demand, so
+// listing a whole chapter allocates nothing per verse. Qt::UserRole holds
+// the verse reference.
+class BibleVerseModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit BibleVerseModel(QObject *parent = nullptr);
+
+    void setVerses(const QVector<BibleVerse> &verses);
+    void clear();
+    const QVector<BibleVerse> &verses() const { return verseList; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    QVector<BibleVerse> verseList;
+};
+
+#endif // BIBLEVERSEMODEL_H
@@ -0,0 +1,169 @@
+#include "BookAliasTable.h"
+#include "BookNameTrie.h"
+#include <QHash>
+#include <algorithm>
+
+namespace {
+
+// Walks the name as BookNameTrie normalises it (case folded, '.' dropped,
+// whitespace collapsed and trimmed) without building the normalised string.
+template <typename Visitor>
+bool forEachFoldedChar(QStringView name, Visitor visit)
+{
+    bool started = false;
+    bool pendingSpace = false;
+    for (QChar ch : name) {
+        const char16_t folded = BookNameTrie::foldChar(ch);
+        if (folded == 0) {
+            continue;
+        }
+        if (folded == u' ') {
+            pendingSpace = started;
+            continue;
+        }
+        if (pendingSpace) {
+            pendingSpace = false;
+            if (!visit(u' ')) {
+                return false;
+            }
+        }
+        started = true;
+        if (!visit(folded)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+quint32 mix(quint32 h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+} // namespace
+
+quint32 BookAliasTable::hashName(QStringView name, quint32 seed)
+{
+    quint32 h = 2166136261u ^ (seed * 0x9e3779b9u);
+    forEachFoldedChar(name, [&h](char16_t ch) {
+        h ^= ch;
+        h *= 16777619u;
+        return true;
+    });
+    return mix(h);
+}
+
+bool BookAliasTable::matches(QStringView name, const QString &key)
+{
+    int i = 0;
+    const bool same = forEachFoldedChar(name, [&key, &i](char16_t ch) {
+        return i < key.size() && key.at(i++).unicode() == ch;
+    });
+    return same && i == key.size();
+}
+
+void BookAliasTable::build(const QVector<QPair<QString, int>> &names)
+{
+    QVector<QString> entryKeys;
+    QVector<int> entryIds;
+    QHash<QString, int> seen;
+    for (const QPair<QString, int> &name : names) {
+        if (name.second <= 0) {
+            continue;
+        }
+        for (const QString &key : BookNameTrie::normalisedKeys(name.first)) {
+            if (!seen.contains(key)) {
+                seen.insert(key, name.second);
+                entryKeys.append(key);
+                entryIds.append(name.second);
+            }
+        }
+    }
+
+    entryCount = entryKeys.size();
+    bucketSeeds.clear();
+    keys.clear();
+    bookIds.clear();
+    if (entryCount == 0) {
+        return;
+    }
+
+    // About four keys per bucket over a table at ~80% load finds seeds
+    // within a few tries; grow the table in the rare case a bucket cannot fit.
+    const int bucketCount = entryCount / 4 + 1;
+    int slotCount = entryCount + entryCount / 4 + 1;
+    for (;;) {
+        QVector<QVector<int>> buckets(bucketCount);
+        for (int i = 0; i < entryCount; ++i) {
+            buckets[hashName(entryKeys[i], 0) % bucketCount].append(i);
+        }
+        QVector<int> order(bucketCount);
+        for (int b = 0; b < bucketCount; ++b) {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(), [&buckets](int a, int b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        bucketSeeds = QVector<quint32>(bucketCount, 0);
+        keys = QVector<QString>(slotCount);
+        bookIds = QVector<int>(slotCount, 0);
+        QVector<bool> used(slotCount, false);
+
+        bool placedAll = true;
+        for (int b : order) {
+            const QVector<int> &bucket = buckets[b];
+            if (bucket.isEmpty()) {
+                break;
+            }
+
+            bool placed = false;
+            QVector<int> slots(bucket.size());
+            for (quint32 seed = 1; seed < 100000 && !placed; ++seed) {
+                placed = true;
+                for (int k = 0; k < bucket.size() && placed; ++k) {
+                    const int slot = hashName(entryKeys[bucket[k]], seed) % slotCount;
+                    if (used[slot] || std::find(slots.begin(), slots.begin() + k, slot) != slots.begin() + k) {
+                        placed = false;
+                    }
+                    slots[k] = slot;
+                }
+                if (placed) {
+                    bucketSeeds[b] = seed;
+                    for (int k = 0; k < bucket.size(); ++k) {
+                        used[slots[k]] = true;
+                        keys[slots[k]] = entryKeys[bucket[k]];
+                        bookIds[slots[k]] = entryIds[bucket[k]];
+                    }
+                }
+            }
+            if (!placed) {
+                placedAll = false;
+                break;
+            }
+        }
+
+        if (placedAll) {
+            return;
+        }
+        slotCount += slotCount / 2;
+    }
+}
+
+int BookAliasTable::lookup(QStringView name) const
+{
+    if (keys.isEmpty()) {
+        return 0;
+    }
+    const quint32 seed = bucketSeeds[hashName(name, 0) % bucketSeeds.size()];
+    if (seed == 0) {
+        return 0;
+    }
+    const int slot = hashName(name, seed) % keys.size();
+    return matches(name, keys[slot]) ? bookIds[slot] : 0;
+}
@@ -0,0 +1,36 @@
+#ifndef BOOKALIASTABLE_H
+#define BOOKALIASTABLE_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QPair>
+
+// Exact book name -> book ID lookup through a minimal perfect hash built
+// once from a fixed set of names (hash and displace: every bucket of keys
+// gets a seed that spreads it over free slots). A lookup hashes the name
+// twice and compares one stored key, folding the input with the same rules
+// as BookNameTrie on the fly, so it never allocates.
+class BookAliasTable
+{
+public:
+    // Earlier entries win when several normalise to the same key
+    void build(const QVector<QPair<QString, int>> &names);
+
+    bool isEmpty() const { return keys.isEmpty(); }
+    int size() const { return entryCount; }
+
+    // 0 when the name is unknown
+    int lookup(QStringView name) const;
+
+private:
+    static quint32 hashName(QStringView name, quint32 seed);
+    static bool matches(QStringView name, const QString &key);
+
+    QVector<quint32> bucketSeeds;
+    QVector<QString> keys; // normalised key per slot, empty when unused
+    QVector<int> bookIds;
+    int entryCount = 0;
+};
+
+#endif // BOOKALIASTABLE_H
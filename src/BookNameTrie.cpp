@@ -0,0 +1,203 @@
+#include "BookNameTrie.h"
+#include <algorithm>
+
+BookNameTrie::BookNameTrie()
+{
+    clear();
+}
+
+void BookNameTrie::clear()
+{
+    nodes.clear();
+    nodes.append(Node()); // root
+}
+
+char16_t BookNameTrie::foldChar(QChar ch)
+{
+    if (ch.isSpace()) {
+        return u' ';
+    }
+    if (ch == QLatin1Char('.')) {
+        return 0;
+    }
+    return ch.toCaseFolded().unicode();
+}
+
+int BookNameTrie::child(int node, char16_t ch) const
+{
+    for (const QPair<char16_t, int> &edge : nodes[node].children) {
+        if (edge.first == ch) {
+            return edge.second;
+        }
+    }
+    return -1;
+}
+
+QStringList BookNameTrie::normalisedKeys(QStringView name)
+{
+    QString key;
+    key.reserve(name.size());
+    for (QChar ch : name) {
+        const char16_t folded = foldChar(ch);
+        if (folded == 0) {
+            continue;
+        }
+        if (folded == u' ' && (key.isEmpty() || key.endsWith(QLatin1Char(' ')))) {
+            continue;
+        }
+        key.append(QChar(folded));
+    }
+    while (key.endsWith(QLatin1Char(' '))) {
+        key.chop(1);
+    }
+    if (key.isEmpty()) {
+        return QStringList();
+    }
+
+    QStringList keys;
+    keys.append(key);
+
+    // "1 John" <-> "1John"
+    int digits = 0;
+    while (digits < key.size() && key.at(digits).isDigit()) {
+        ++digits;
+    }
+    if (digits > 0 && digits < key.size()) {
+        if (key.at(digits) == QLatin1Char(' ')) {
+            keys.append(key.left(digits) + key.mid(digits + 1));
+        } else {
+            keys.append(key.left(digits) + QLatin1Char(' ') + key.mid(digits));
+        }
+    }
+    return keys;
+}
+
+void BookNameTrie::insert(QStringView name, int bookId)
+{
+    if (bookId <= 0) {
+        return;
+    }
+    for (const QString &key : normalisedKeys(name)) {
+        insertNormalised(key, bookId);
+    }
+}
+
+void BookNameTrie::insertNormalised(const QString &key, int bookId)
+{
+    int node = 0;
+    for (QChar ch : key) {
+        int next = child(node, ch.unicode());
+        if (next < 0) {
+            next = nodes.size();
+            nodes.append(Node());
+            nodes[node].children.append(qMakePair(ch.unicode(), next));
+        }
+        node = next;
+
+        Node &current = nodes[node];
+        if (current.uniqueBookId == 0) {
+            current.uniqueBookId = bookId;
+        } else if (current.uniqueBookId != bookId) {
+            current.uniqueBookId = -1;
+        }
+    }
+
+    if (nodes[node].bookId == 0) {
+        nodes[node].bookId = bookId;
+    }
+}
+
+BookNameTrie::Cursor BookNameTrie::cursor() const
+{
+    Cursor c;
+    c.trie = this;
+    c.node = 0;
+    return c;
+}
+
+bool BookNameTrie::Cursor::step(QChar ch)
+{
+    if (node < 0) {
+        return false;
+    }
+
+    const char16_t folded = foldChar(ch);
+    if (folded == 0) {
+        return true;
+    }
+    if (folded == u' ') {
+        // Only matters if more name follows; leading and trailing spaces are free
+        if (node != 0) {
+            pendingSpace = true;
+        }
+        return true;
+    }
+
+    if (pendingSpace) {
+        pendingSpace = false;
+        node = trie->child(node, u' ');
+        if (node < 0) {
+            return false;
+        }
+    }
+
+    node = trie->child(node, folded);
+    return node >= 0;
+}
+
+int BookNameTrie::Cursor::bookId() const
+{
+    return node > 0 ? trie->nodes[node].bookId : 0;
+}
+
+int BookNameTrie::Cursor::uniqueBookId() const
+{
+    if (node <= 0) {
+        return 0;
+    }
+    const int id = trie->nodes[node].uniqueBookId;
+    return id > 0 ? id : 0;
+}
+
+int BookNameTrie::lookup(QStringView name) const
+{
+    Cursor c = cursor();
+    for (QChar ch : name) {
+        if (!c.step(ch)) {
+            return 0;
+        }
+    }
+    return c.bookId();
+}
+
+QVector<int> BookNameTrie::completions(QStringView prefix) const
+{
+    QVector<int> bookIds;
+    Cursor c = cursor();
+    for (QChar ch : prefix) {
+        if (!c.step(ch)) {
+            return bookIds;
+        }
+    }
+    if (c.pendingSpace) {
+        c.node = child(c.node, u' ');
+        if (c.node < 0) {
+            return bookIds;
+        }
+    }
+
+    QVarLengthArray<int, 64> pending;
+    pending.append(c.node);
+    while (!pending.isEmpty()) {
+        const int node = pending.takeLast();
+        const int bookId = nodes[node].bookId;
+        if (bookId > 0 && !bookIds.contains(bookId)) {
+            bookIds.append(bookId);
+        }
+        for (const QPair<char16_t, int> &edge : nodes[node].children) {
+            pending.append(edge.second);
+        }
+    }
+    std::sort(bookIds.begin(), bookIds.end());
+    return bookIds;
+}
@@ -0,0 +1,80 @@
+#ifndef BOOKNAMETRIE_H
+#define BOOKNAMETRIE_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QPair>
+
+// Case-folded prefix tree of Bible book names and abbreviations mapping to
+// book IDs. Lookups walk one character at a time through a Cursor and never
+// allocate, so the reference parser can run it on every keystroke.
+//
+// Names are normalised on insert and while walking: letters are case
+// folded, '.' is ignored and runs of whitespace count as a single space.
+// A name starting with a number ("1 John") is also reachable without the
+// space ("1John"). BookAliasTable applies the same rules for exact lookups.
+class BookNameTrie
+{
+public:
+    BookNameTrie();
+
+    void clear();
+    bool isEmpty() const { return nodes.size() <= 1; }
+
+    // The first book inserted for a name keeps it; later duplicates are ignored.
+    void insert(QStringView name, int bookId);
+
+    class Cursor
+    {
+    public:
+        // Feed the next character. Returns false once the text no longer
+        // matches any name; the cursor stays invalid after that.
+        bool step(QChar ch);
+        bool isValid() const { return node >= 0; }
+
+        // Book named exactly by the text so far, or 0
+        int bookId() const;
+        // The only book whose names continue the text so far, or 0 when
+        // none or several do (lets "Matt" or "Rev" resolve on their own)
+        int uniqueBookId() const;
+
+    private:
+        friend class BookNameTrie;
+        const BookNameTrie *trie = nullptr;
+        int node = -1;
+        bool pendingSpace = false;
+    };
+
+    Cursor cursor() const;
+
+    // Exact lookup of a whole name; 0 when unknown
+    int lookup(QStringView name) const;
+
+    // IDs of every book with a name starting with prefix, in ascending order
+    QVector<int> completions(QStringView prefix) const;
+
+    // Folding applied to each character: 0 for characters that are ignored,
+    // ' ' for any whitespace, otherwise the case-folded character
+    static char16_t foldChar(QChar ch);
+
+    // Normalised spellings stored for a name: the folded name and, for
+    // numbered books, the variant with or without the space after the number
+    static QStringList normalisedKeys(QStringView name);
+
+private:
+    struct Node {
+        QVarLengthArray<QPair<char16_t, int>, 4> children;
+        int bookId = 0;
+        int uniqueBookId = 0; // -1 once several books share this prefix
+    };
+
+    int child(int node, char16_t ch) const;
+    void insertNormalised(const QString &key, int bookId);
+
+    QVector<Node> nodes;
+};
+
+#endif // BOOKNAMETRIE_H
@@ -357,103 +357,6 @@ void CanvasWidget::setOverlayConfig(const OverlayConfig &config)
 
 QImage CanvasWidget::getFrame() const
 {
-    QImage image(size(), QImage::Format_RGB32);
-    QPainter painter(&image);
-    
-    const_cast<CanvasWidget*>(this)->drawBackground(painter);
-    
-    const bool hasMainOverlayText = !overlayText.isEmpty() || !overlayReference.isEmpty();
-    const bool hasNotes = notesVisibleFlag && !notesHtml.trimmed().isEmpty();
-
-    if (hasMainOverlayText || hasNotes) {
-        const_cast<CanvasWidget*>(this)->drawOverlay(painter);
-    }
-    
-    return image;
-}
-
-QImage CanvasWidget::getNotesImage() const
-{
-    const int baseW = 1920;
-    const int baseH = 1080;
-
-    QImage image(baseW, baseH, QImage::Format_ARGB32_Premultiplied);
-    image.fill(Qt::transparent);
-
-    const bool hasNotes = notesVisibleFlag && !notesHtml.trimmed().isEmpty();
-    if (!hasNotes) {
-        return image;
-    }
-
-    QPainter painter(&image);
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.setRenderHint(QPainter::TextAntialiasing);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform);
-
-    QTextDocument notesDoc;
-    notesDoc.setDocumentMargin(0);
-    // Notes formatting comes solely from the editor HTML
-    notesDoc.setHtml(notesHtml);
-    notesDoc.setTextWidth(baseW);
-
-    qreal docHeight = notesDoc.size().height();
-    int h = qMin(static_cast<int>(std::ceil(docHeight)), baseH);
-
-    QRectF textRect(0, 0, baseW, docHeight);
-
-    painter.save();
-    painter.setClipRect(QRectF(0, 0, baseW, h));
-    notesDoc.drawContents(&painter, QRectF(0, 0, textRect.width(), h));
-    painter.restore();
-
-    return image;
-}
-
-void CanvasWidget::paintEvent(QPaintEvent *event)
-{
-    Q_UNUSED(event);
-
-    const bool hasMainOverlayText = !overlayText.isEmpty() || !overlayReference.isEmpty();
-    const bool hasNotes = notesVisibleFlag && !notesHtml.trimmed().isEmpty();
-
-    // Fast path: when we are just showing a video background (e.g. local media
-    // playback) with no Bible/song text and no notes overlay, draw the video
-    // frame directly to the widget. This avoids an extra 1920x1080 offscreen
-    // render + rescale, which can make playback feel choppy.
-    if (!hasNotes && !hasMainOverlayText && backgroundType == BackgroundType::Video) {
-        QPainter painter(this);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform);
-        drawBackground(painter);
-        return;
-    }
-
-    if (hasNotes) {
-        // Render notes at a fixed logical resolution (1920x1080) and then
-        // scale onto the widget. This keeps the visual relationship between
-        // Projection Notes and the Projection Canvas consistent at any
-        // preview size, while the underlying document/font sizes remain
-        // unchanged.
-        QPainter painter(this);
-        painter.setRenderHint(QPainter::Antialiasing);
-        painter.setRenderHint(QPainter::TextAntialiasing);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform);
-
-        // Draw background using widget coordinates
-        drawBackground(painter);
-
-        QImage notesImage = getNotesImage();
-        if (!notesImage.isNull()) {
-            QImage scaled = notesImage.scaled(size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            int x = (width() - scaled.width()) / 2;
-            int y = (height() - scaled.height()) / 2;
-            painter.drawImage(x, y, scaled);
-        }
-
-        return;
-    }
-
-    // For Bible verses and song lyrics, continue to render to 1920x1080
-    // and scale to widget size for consistent quality.
     QImage renderImage(1920, 1080, QImage::Format_RGB32);
     QPainter renderPainter(&renderImage);
     renderPainter.setRenderHint(QPainter::Antialiasing);
@@ -502,7 +405,13 @@ void CanvasWidget::paintEvent(QPaintEvent *event)
     // Draw overlay at 1920x1080
     renderPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
 
-    if (hasMainOverlayText) {
+    const bool hasMainOverlayText = !overlayText.isEmpty() || !overlayReference.isEmpty();
+    const bool hasNotes = notesVisibleFlag && !notesHtml.trimmed().isEmpty();
+
+    if (hasNotes) {
+        // Notes replace the main overlay, as on the canvas itself
+        renderPainter.drawImage(0, 0, getNotesImage());
+    } else if (hasMainOverlayText) {
         if (overlayText.trimmed().isEmpty() && overlayReference.trimmed().isEmpty()) {
             // Skip
         } else {
@@ -695,6 +604,95 @@ void CanvasWidget::paintEvent(QPaintEvent *event)
             }
         }
     }
+
+    return renderImage;
+}
+
+QImage CanvasWidget::getNotesImage() const
+{
+    const int baseW = 1920;
+    const int baseH = 1080;
+
+    QImage image(baseW, baseH, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    const bool hasNotes = notesVisibleFlag && !notesHtml.trimmed().isEmpty();
+    if (!hasNotes) {
+        return image;
+    }
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    QTextDocument notesDoc;
+    notesDoc.setDocumentMargin(0);
+    // Notes formatting comes solely from the editor HTML
+    notesDoc.setHtml(notesHtml);
+    notesDoc.setTextWidth(baseW);
+
+    qreal docHeight = notesDoc.size().height();
+    int h = qMin(static_cast<int>(std::ceil(docHeight)), baseH);
+
+    QRectF textRect(0, 0, baseW, docHeight);
+
+    painter.save();
+    painter.setClipRect(QRectF(0, 0, baseW, h));
+    notesDoc.drawContents(&painter, QRectF(0, 0, textRect.width(), h));
+    painter.restore();
+
+    return image;
+}
+
+void CanvasWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    ++paintSerial;
+
+    const bool hasMainOverlayText = !overlayText.isEmpty() || !overlayReference.isEmpty();
+    const bool hasNotes = notesVisibleFlag && !notesHtml.trimmed().isEmpty();
+
+    // Fast path: when we are just showing a video background (e.g. local media
+    // playback) with no Bible/song text and no notes overlay, draw the video
+    // frame directly to the widget. This avoids an extra 1920x1080 offscreen
+    // render + rescale, which can make playback feel choppy.
+    if (!hasNotes && !hasMainOverlayText && backgroundType == BackgroundType::Video) {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        drawBackground(painter);
+        return;
+    }
+
+    if (hasNotes) {
+        // Render notes at a fixed logical resolution (1920x1080) and then
+        // scale onto the widget. This keeps the visual relationship between
+        // Projection Notes and the Projection Canvas consistent at any
+        // preview size, while the underlying document/font sizes remain
+        // unchanged.
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+        // Draw background using widget coordinates
+        drawBackground(painter);
+
+        QImage notesImage = getNotesImage();
+        if (!notesImage.isNull()) {
+            QImage scaled = notesImage.scaled(size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            int x = (width() - scaled.width()) / 2;
+            int y = (height() - scaled.height()) / 2;
+            painter.drawImage(x, y, scaled);
+        }
+
+        return;
+    }
+
+    // For Bible verses and song lyrics, continue to render to 1920x1080
+    // and scale to widget size for consistent quality.
+    const QImage renderImage = getFrame();
     
     // Scale and draw to widget
     QPainter painter(this);
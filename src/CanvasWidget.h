@@ -122,8 +122,11 @@ public:
     void setOverlayConfig(const OverlayConfig &config);
     OverlayConfig getOverlayConfig() const { return overlayConfig; }
     
-    // Get rendered frame for streaming
+    // The composited program output at 1920x1080, as the canvas shows it
+    // (fade transitions aside); used for painting and for streaming
     QImage getFrame() const;
+    // Bumped on every repaint, so frame grabbers can tell when nothing was drawn
+    quint64 frameSerial() const { return paintSerial; }
 
     // Render only the notes overlay (no background) to an image so it can be
     // mirrored into external outputs like the OBS overlay.
@@ -175,6 +178,7 @@ protected:
 
     QPixmap cachedFrame;
     bool needsRedraw;
+    quint64 paintSerial = 0;
 
     // Fade transition support
     QTimer *fadeTimer;
@@ -0,0 +1,152 @@
+#include "HttpRequestParser.h"
+#include <QList>
+
+void HttpRequestParser::append(const QByteArray &data)
+{
+    if (error == 0) {
+        buffer.append(data);
+    }
+}
+
+HttpRequestParser::Status HttpRequestParser::next(Request &request)
+{
+    if (error != 0) {
+        return Failed;
+    }
+
+    // Clients may send stray blank lines between requests
+    int start = 0;
+    while (start + 1 < buffer.size() && buffer[start] == '\r' && buffer[start + 1] == '\n') {
+        start += 2;
+    }
+    if (start > 0) {
+        buffer.remove(0, start);
+    }
+    if (buffer.isEmpty()) {
+        return NeedMoreData;
+    }
+
+    const int headEnd = buffer.indexOf("\r\n\r\n");
+    if (headEnd < 0) {
+        return buffer.size() > MaxHeaderBytes ? fail(431) : NeedMoreData;
+    }
+    if (headEnd > MaxHeaderBytes) {
+        return fail(431);
+    }
+
+    Request parsed;
+    const int status = parseHead(buffer.left(headEnd), parsed);
+    if (status != 0) {
+        return fail(status);
+    }
+
+    // Only GETs are served, so chunked uploads are not worth supporting;
+    // a body with a length is read and passed along
+    if (parsed.headers.contains("transfer-encoding")) {
+        return fail(501);
+    }
+    qint64 length = 0;
+    if (parsed.headers.contains("content-length")) {
+        bool ok = false;
+        length = parsed.header("content-length").toLongLong(&ok);
+        if (!ok || length < 0) {
+            return fail(400);
+        }
+        if (length > MaxBodyBytes) {
+            return fail(413);
+        }
+    }
+
+    const int bodyStart = headEnd + 4;
+    if (buffer.size() - bodyStart < length) {
+        return NeedMoreData;
+    }
+    parsed.body = buffer.mid(bodyStart, static_cast<int>(length));
+    buffer.remove(0, bodyStart + static_cast<int>(length));
+    request = parsed;
+    return RequestReady;
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status)
+{
+    error = status;
+    buffer.clear();
+    return Failed;
+}
+
+int HttpRequestParser::parseHead(const QByteArray &head, Request &request)
+{
+    int lineEnd = head.indexOf("\r\n");
+    const QByteArray requestLine = lineEnd < 0 ? head : head.left(lineEnd);
+
+    const QList<QByteArray> parts = requestLine.split(' ');
+    if (parts.size() != 3 || parts[0].isEmpty() || parts[1].isEmpty()) {
+        return 400;
+    }
+    for (char ch : parts[0]) {
+        if (ch < 'A' || ch > 'Z') {
+            return 400;
+        }
+    }
+    request.method = parts[0];
+    request.target = parts[1];
+    request.version = parts[2];
+    if (request.version != "HTTP/1.1" && request.version != "HTTP/1.0") {
+        return request.version.startsWith("HTTP/") ? 505 : 400;
+    }
+
+    // Absolute form ("GET http://host/overlay") is allowed for proxies
+    QByteArray target = request.target;
+    if (target.startsWith("http://") || target.startsWith("https://")) {
+        const int pathStart = target.indexOf('/', target.indexOf("//") + 2);
+        target = pathStart < 0 ? QByteArray("/") : target.mid(pathStart);
+    } else if (!target.startsWith('/') && target != "*") {
+        return 400;
+    }
+    const int queryStart = target.indexOf('?');
+    request.path = queryStart < 0 ? target : target.left(queryStart);
+    request.query = queryStart < 0 ? QByteArray() : target.mid(queryStart + 1);
+
+    int count = 0;
+    while (lineEnd >= 0) {
+        const int lineStart = lineEnd + 2;
+        lineEnd = head.indexOf("\r\n", lineStart);
+        const QByteArray line = head.mid(lineStart, lineEnd < 0 ? -1 : lineEnd - lineStart);
+
+        // Folded continuation lines are obsolete and a smuggling risk
+        if (line.startsWith(' ') || line.startsWith('\t')) {
+            return 400;
+        }
+        const int colon = line.indexOf(':');
+        if (colon <= 0) {
+            return 400;
+        }
+        const QByteArray name = line.left(colon).toLower();
+        if (name.contains(' ') || name.contains('\t')) {
+            return 400;
+        }
+        if (++count > MaxHeaderCount) {
+            return 431;
+        }
+
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        auto existing = request.headers.find(name);
+        if (existing == request.headers.end()) {
+            request.headers.insert(name, value);
+        } else {
+            // Repeated Content-Length values then no longer parse as a number
+            existing.value() += ", " + value;
+        }
+    }
+
+    bool close = false;
+    bool keepAlive = false;
+    const QList<QByteArray> tokens = request.header("connection").toLower().split(',');
+    for (const QByteArray &token : tokens) {
+        const QByteArray option = token.trimmed();
+        close = close || option == "close";
+        keepAlive = keepAlive || option == "keep-alive";
+    }
+    request.keepAlive = request.version == "HTTP/1.1" ? !close : keepAlive;
+    return 0;
+}
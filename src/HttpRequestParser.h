@@ -0,0 +1,58 @@
+#ifndef HTTPREQUESTPARSER_H
+#define HTTPREQUESTPARSER_H
+
+#include <QByteArray>
+#include <QHash>
+
+// Incremental HTTP/1.x request parser for one connection. Bytes are
+// appended as they arrive and complete requests are taken off the front
+// one at a time, so a request split across TCP segments waits for the
+// rest and several pipelined requests in one segment are all served.
+//
+// The request line plus headers, the number of headers and the body are
+// bounded; going over a limit, or anything malformed, puts the parser in
+// an error state with the HTTP status to answer before closing. Request
+// bodies are only accepted with a Content-Length.
+class HttpRequestParser
+{
+public:
+    struct Request {
+        QByteArray method;
+        QByteArray target;   // as sent, including any query
+        QByteArray path;     // target without the query
+        QByteArray query;
+        QByteArray version;  // "HTTP/1.1"
+        QHash<QByteArray, QByteArray> headers; // lower-case names
+        QByteArray body;
+        bool keepAlive = false;
+
+        QByteArray header(const QByteArray &name) const { return headers.value(name); }
+    };
+
+    enum Status {
+        NeedMoreData,
+        RequestReady,
+        Failed
+    };
+
+    static constexpr int MaxHeaderBytes = 16 * 1024;
+    static constexpr int MaxHeaderCount = 100;
+    static constexpr int MaxBodyBytes = 64 * 1024;
+
+    void append(const QByteArray &data);
+    Status next(Request &request);
+
+    // Something has arrived that is not yet a whole request
+    bool hasPartialRequest() const { return !buffer.isEmpty(); }
+    // Status code to answer with once next() has returned Failed
+    int errorStatus() const { return error; }
+
+private:
+    Status fail(int status);
+    int parseHead(const QByteArray &head, Request &request);
+
+    QByteArray buffer;
+    int error = 0;
+};
+
+#endif // HTTPREQUESTPARSER_H
@@ -5,10 +5,17 @@
 #include "PowerPointPanel.h"
 #include "PlaylistPanel.h"
 #include "ProjectionCanvas.h"
+#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
+#include "YouTubeBridge.h"
+#endif
 #include "SettingsDialog.h"
 #include "OverlayServer.h"
+#include "ProgramFrameStream.h"
 
 #include "UpdateChecker.h"
+#include "ServiceBundle.h"
+#include "ServiceArchiveIndex.h"
+#include "ServiceHistoryDialog.h"
 #include <QDesktopServices>
 #include <QMenuBar>
 #include <QToolBar>
@@ -43,6 +50,8 @@
 #include <QJsonArray>
 #include <QPainter>
 #include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <climits>
 #include <QStandardPaths>
 #include <QDir>
@@ -89,13 +98,14 @@ MainWindow::MainWindow(QWidget *parent)
     , notesLastGoodHtml()
     , notesPageFull(false)
     , overlayServer(nullptr)
+    , programStream(nullptr)
+    , serviceArchive(nullptr)
     , mediaControlsWidget(nullptr)
     , mediaPlayPauseButton(nullptr)
     , mediaSeekSlider(nullptr)
     , mediaVolumeSlider(nullptr)
     , mediaSeekSliderDragging(false)
     , youtubePlaying(false)
-    , youtubePositionTimer(nullptr)
     , settings(nullptr)
 {
     setWindowTitle("SimplePresenter");
@@ -113,57 +123,27 @@ MainWindow::MainWindow(QWidget *parent)
     }
 
 #ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
-    connect(overlayServer, &OverlayServer::webSocketClientConnected,
-            this, [this]() {
-                if (!projectionCanvas) {
-                    return;
-                }
-                if (projectionCanvas->isYouTubeActive()) {
-                    QTimer::singleShot(1000, this, [this]() { syncYouTubeOverlayToProjection(); });
-                    QTimer::singleShot(3000, this, [this]() { syncYouTubeOverlayToProjection(); });
-                } else if (projectionCanvas->isMediaVideoActive()) {
-                    QTimer::singleShot(1000, this, [this]() { syncMediaOverlayToProjection(); });
-                    QTimer::singleShot(3000, this, [this]() { syncMediaOverlayToProjection(); });
-                }
-            });
-#endif
-
-#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
-    youtubePositionTimer = new QTimer(this);
-    youtubePositionTimer->setInterval(250);
-    youtubePositionTimer->setSingleShot(false);
-    connect(youtubePositionTimer, &QTimer::timeout,
-            this, [this]() {
-                if (!projectionCanvas || !mediaControlsWidget || !mediaControlsWidget->isVisible() ||
-                    mediaSeekSliderDragging || !mediaSeekSlider) {
-                    return;
-                }
-                if (!projectionCanvas->isYouTubeActive()) {
-                    return;
-                }
-
-                projectionCanvas->queryYouTubePositionRatio([this](double ratio) {
-                    if (ratio < 0.0) {
-                        return;
-                    }
-                    if (!mediaSeekSlider || !mediaControlsWidget || !mediaControlsWidget->isVisible() ||
-                        mediaSeekSliderDragging) {
-                        return;
-                    }
-
-                    int sliderValue = qBound(0, static_cast<int>(ratio * 1000.0 + 0.5), 1000);
-                    mediaSeekSlider->blockSignals(true);
-                    mediaSeekSlider->setValue(sliderValue);
-                    mediaSeekSlider->blockSignals(false);
-                });
-            });
+    // An OBS page says when its YouTube player has started; bring it to
+    // where the projection is. Local media needs nothing here: pages get
+    // the media clock with the full state and follow it.
+    connect(overlayServer, &OverlayServer::youTubeClientReady,
+            this, &MainWindow::syncYouTubeOverlayToProjection);
 #endif
     
     setupUI();
+
+    // Program output for capture clients, encoded only while watched
+    programStream = new ProgramFrameStream(projectionCanvas, overlayServer, this);
+
     setupMenuBar();
     setupToolBar();
     setupStatusBar();
     loadSettings();
+    recoverPlaylist();
+
+    // Built in the background; only services changed since last run are read
+    serviceArchive = new ServiceArchiveIndex(this);
+    serviceArchive->refresh(biblePanel->manager()->snapshot());
 
     
     // Initialize UpdateChecker
@@ -303,10 +283,8 @@ void MainWindow::syncMediaOverlayToProjection()
         return;
     }
 
-    overlayServer->broadcastMediaSeek(position);
-
     bool playing = (player->playbackState() == QMediaPlayer::PlayingState);
-    overlayServer->broadcastMediaPlayPause(playing);
+    overlayServer->updateMediaClock(playing, position, player->playbackRate());
 }
 
 void MainWindow::syncYouTubeOverlayToProjection()
@@ -319,17 +297,45 @@ void MainWindow::syncYouTubeOverlayToProjection()
         return;
     }
 
-    projectionCanvas->queryYouTubePositionRatio([this](double ratio) {
-        if (!overlayServer) {
-            return;
-        }
-        if (ratio < 0.0) {
-            return;
-        }
-
+    const double ratio = projectionCanvas->youTubeBridge()->positionRatio();
+    if (ratio >= 0.0) {
         overlayServer->broadcastYouTubeSeek(ratio);
-        overlayServer->broadcastYouTubePlayPause(youtubePlaying);
-    });
+    }
+    overlayServer->broadcastYouTubePlayPause(youtubePlaying);
+#endif
+}
+
+void MainWindow::onYouTubePositionChanged(double ratio)
+{
+#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
+    if (!projectionCanvas || !projectionCanvas->isYouTubeActive() || !mediaControlsWidget ||
+        !mediaControlsWidget->isVisible() || mediaSeekSliderDragging || !mediaSeekSlider) {
+        return;
+    }
+
+    int sliderValue = qBound(0, static_cast<int>(ratio * 1000.0 + 0.5), 1000);
+    mediaSeekSlider->blockSignals(true);
+    mediaSeekSlider->setValue(sliderValue);
+    mediaSeekSlider->blockSignals(false);
+#else
+    Q_UNUSED(ratio);
+#endif
+}
+
+void MainWindow::onYouTubePlayingChanged(bool playing)
+{
+#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
+    if (!projectionCanvas || !projectionCanvas->isYouTubeActive()) {
+        return;
+    }
+
+    // Autoplay, the end of the video, or resuming after a seek: OBS
+    // follows whatever the projection actually did
+    youtubePlaying = playing;
+    updateMediaPlayPauseIcon();
+    syncYouTubeOverlayToProjection();
+#else
+    Q_UNUSED(playing);
 #endif
 }
 
@@ -1104,23 +1110,14 @@ ytd-promoted-video-renderer,
             overlayServer->updateOverlay("", "");
             overlayServer->updateMedia("", false);
             overlayServer->updateYouTube(url);
-            // Force the OBS browser source to reload so the new YouTube
-            // video always appears without needing a manual refresh.
-            overlayServer->triggerRefresh();
         }
 
         // Enable media controls for YouTube playback so the user can
         // drive play/pause and scrubbing from the app. Assume autoplay
         // starts the YouTube video, so reflect an initial "playing" state.
+        // The OBS overlay is brought in sync when its player reports in.
         youtubePlaying = true;
         onMediaVideoStarted();
-
-        // After the OBS browser source reloads and the overlay's YouTube
-        // player has had time to initialise, resync its playback position
-        // to match the Projection Canvas so they stay in sync even if the
-        // overlay loaded a bit later.
-        QTimer::singleShot(1500, this, [this]() { syncYouTubeOverlayToProjection(); });
-        QTimer::singleShot(4000, this, [this]() { syncYouTubeOverlayToProjection(); });
     });
 
     connect(addToPlaylistButton, &QPushButton::clicked, this, [this]() {
@@ -1357,7 +1354,6 @@ ytd-promoted-video-renderer,
                         overlayServer->updateOverlay("", "");
                         overlayServer->updateYouTube("");
                         overlayServer->updateMedia(mediaPath, isVideo);
-                        overlayServer->triggerRefresh();
                     } else {
                         // Hide notes overlay in OBS; next Bible/lyrics/media projection
                         // will repopulate overlay content.
@@ -1377,14 +1373,19 @@ ytd-promoted-video-renderer,
     connect(playlistPanel, &PlaylistPanel::itemActivated,
             this, &MainWindow::projectPlaylistItem);
     connect(playlistPanel, &PlaylistPanel::bibleVerseActivated,
-            [this](const QString &reference) {
+            [this](const QString &reference, const QString &bundledText) {
                 contentTabs->setCurrentWidget(biblePanel);  // Switch to Bible tab
-                biblePanel->activateVerse(reference);
+                // Bundled items project the text they were prepared with,
+                // whichever Bible this machine has loaded
+                biblePanel->activateVerse(reference, bundledText.isEmpty());
+                if (!bundledText.isEmpty()) {
+                    projectBibleVerse(reference, bundledText);
+                }
             });
     connect(playlistPanel, &PlaylistPanel::songActivated,
-            [this](const QString &songTitle) {
+            [this](const QString &songTitle, int songId, const QJsonObject &bundledSong) {
                 contentTabs->setCurrentWidget(songPanel);  // Switch to Songs tab
-                songPanel->activateSong(songTitle);
+                songPanel->activateSong(songTitle, songId, bundledSong);
             });
     connect(playlistPanel, &PlaylistPanel::youtubeActivated,
             [this](const QString &url) {
@@ -1404,12 +1405,9 @@ ytd-promoted-video-renderer,
                         overlayServer->updateOverlay("", "");
                         overlayServer->updateMedia("", false);
                         overlayServer->updateYouTube(url);
-                        overlayServer->triggerRefresh();
                     }
                     youtubePlaying = true;
                     onMediaVideoStarted();
-                    QTimer::singleShot(1500, this, [this]() { syncYouTubeOverlayToProjection(); });
-                    QTimer::singleShot(4000, this, [this]() { syncYouTubeOverlayToProjection(); });
                 }
 #else
                 Q_UNUSED(url);
@@ -1420,15 +1418,17 @@ ytd-promoted-video-renderer,
     connect(biblePanel, &BiblePanel::addVerseToPlaylist,
             playlistPanel, &PlaylistPanel::addBibleVerse);
     connect(songPanel, &SongPanel::addSongToPlaylist,
-            [this](const QString &songTitle) { playlistPanel->addSong(songTitle); });
+            [this](const QString &songTitle, int songId) { playlistPanel->addSong(songTitle, QString(), songId); });
     connect(songPanel, &SongPanel::addSectionToPlaylist,
-            [this](const QString &songTitle, const QString &sectionText) {
-                playlistPanel->addSong(songTitle, sectionText);
+            [this](const QString &songTitle, const QString &sectionText, int songId) {
+                playlistPanel->addSong(songTitle, sectionText, songId);
             });
     connect(mediaPanel, &MediaPanel::mediaAddedToPlaylist,
             playlistPanel, &PlaylistPanel::addMedia);
     connect(mediaPanel, &MediaPanel::mediaSelected,
             this, &MainWindow::projectMediaItem);
+    connect(mediaPanel, &MediaPanel::mediaAdded,
+            overlayServer, &OverlayServer::prepareMedia);
     connect(mediaPanel, &MediaPanel::mediaAboutToRemove,
             this, &MainWindow::onMediaEntryAboutToRemove);
     connect(mediaPanel, &MediaPanel::mediaRemoved,
@@ -1466,6 +1466,12 @@ ytd-promoted-video-renderer,
         connect(player, &QMediaPlayer::durationChanged,
                 this, &MainWindow::onMediaDurationChanged);
     }
+#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
+    connect(projectionCanvas->youTubeBridge(), &YouTubeBridge::positionChanged,
+            this, &MainWindow::onYouTubePositionChanged);
+    connect(projectionCanvas->youTubeBridge(), &YouTubeBridge::playingChanged,
+            this, &MainWindow::onYouTubePlayingChanged);
+#endif
 }
 
 void MainWindow::setupMenuBar()
@@ -1488,6 +1494,10 @@ void MainWindow::setupMenuBar()
     QAction *saveAsAction = fileMenu->addAction("Save Playlist &As...");
     connect(saveAsAction, &QAction::triggered, this, &MainWindow::savePlaylistAs);
     
+    QAction *exportBundleAction = fileMenu->addAction("&Export Service Bundle...");
+    exportBundleAction->setToolTip("Save the playlist with its verse text, songs and media in one file");
+    connect(exportBundleAction, &QAction::triggered, this, &MainWindow::exportServiceBundle);
+    
     fileMenu->addSeparator();
     
     QAction *exitAction = fileMenu->addAction("E&xit");
@@ -1499,6 +1509,9 @@ void MainWindow::setupMenuBar()
     clearAction = toolsMenu->addAction("Clear Overlays");
     clearAction->setShortcut(Qt::Key_Escape);
     connect(clearAction, &QAction::triggered, this, &MainWindow::clearOverlays);
+    QAction *historyAction = toolsMenu->addAction("Service &History...");
+    historyAction->setToolTip("Find when songs and passages were used, and report song usage");
+    connect(historyAction, &QAction::triggered, this, &MainWindow::showServiceHistory);
     toolsMenu->addSeparator();
     settingsAction = toolsMenu->addAction("&Settings...");
     settingsAction->setShortcut(QKeySequence::Preferences);
@@ -1638,6 +1651,23 @@ void MainWindow::saveSettings()
     settings->setValue("lastPlaylist", currentPlaylistFile);
 }
 
+void MainWindow::recoverPlaylist()
+{
+    // The journal only outlives a run that did not close cleanly
+    QString fileName;
+    if (!playlistPanel->recoverPlaylist(&fileName)) {
+        return;
+    }
+
+    currentPlaylistFile = fileName;
+    loadServiceNotes(fileName);
+    const QString name = fileName.isEmpty() ? QString("New Playlist") : QFileInfo(fileName).fileName();
+    setWindowTitle(QString("SimplePresenter - %1").arg(name));
+    statusBar()->showMessage(playlistPanel->hasUnsavedChanges()
+                                 ? "Recovered unsaved playlist changes"
+                                 : "Reopened the last playlist", 5000);
+}
+
 void MainWindow::loadServiceNotes(const QString &filePath)
 {
     if (filePath.isEmpty() || !notesEditor) {
@@ -1657,7 +1687,15 @@ void MainWindow::loadServiceNotes(const QString &filePath)
         return;
     }
 
-    QJsonObject root = doc.object();
+    applyServiceNotes(doc.object());
+}
+
+void MainWindow::applyServiceNotes(const QJsonObject &root)
+{
+    if (!notesEditor) {
+        return;
+    }
+
     QJsonObject notesObj = root.value("notes").toObject();
 
     QJsonArray pagesArray = notesObj.value("pages").toArray();
@@ -1711,32 +1749,13 @@ void MainWindow::loadServiceNotes(const QString &filePath)
     onNotesTextChanged();
 }
 
-void MainWindow::saveServiceNotes(const QString &filePath)
+QJsonObject MainWindow::serviceNotesJson()
 {
-    if (filePath.isEmpty()) {
-        return;
-    }
-
     // Ensure the latest edits are captured in the current page
     if (notesEditor && currentNotesPageIndex >= 0 && currentNotesPageIndex < notesPages.size()) {
         notesPages[currentNotesPageIndex] = notesEditor->toHtml();
     }
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return;
-    }
-
-    QByteArray data = file.readAll();
-    file.close();
-
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) {
-        return;
-    }
-
-    QJsonObject root = doc.object();
-
     // Build notes JSON structure
     QJsonObject notesObj;
     QJsonArray pagesArray;
@@ -1751,7 +1770,31 @@ void MainWindow::saveServiceNotes(const QString &filePath)
 
     notesObj["pages"] = pagesArray;
     notesObj["currentPage"] = currentNotesPageIndex;
+    return notesObj;
+}
+
+void MainWindow::saveServiceNotes(const QString &filePath)
+{
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    const QJsonObject notesObj = serviceNotesJson();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QByteArray data = file.readAll();
+    file.close();
+
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (!doc.isObject()) {
+        return;
+    }
 
+    QJsonObject root = doc.object();
     root["notes"] = notesObj;
 
     doc.setObject(root);
@@ -1792,7 +1835,7 @@ void MainWindow::openPlaylist()
     QFileDialog dialog(this, "Open Playlist");
     dialog.setFileMode(QFileDialog::ExistingFile);
     dialog.setDirectory("data/services");
-    dialog.setNameFilter("Simple Presenter Playlists (*.spp);;All Files (*)");
+    dialog.setNameFilter("Simple Presenter Playlists (*.spp *.spbundle);;All Files (*)");
     dialog.setOption(QFileDialog::DontUseNativeDialog, true);
 
     if (dialog.exec() != QDialog::Accepted) {
@@ -1807,12 +1850,16 @@ void MainWindow::openPlaylist()
         this,
         "Open Playlist",
         "data/services",
-        "Simple Presenter Playlists (*.spp);;All Files (*)");
+        "Simple Presenter Playlists (*.spp *.spbundle);;All Files (*)");
 
     if (fileName.isEmpty()) {
         return;
     }
 #endif
+    if (ServiceBundle::isBundle(fileName)) {
+        openServiceBundle(fileName);
+        return;
+    }
     if (playlistPanel->loadPlaylist(fileName)) {
         currentPlaylistFile = fileName;
         setWindowTitle(QString("SimplePresenter - %1").arg(QFileInfo(fileName).fileName()));
@@ -1832,6 +1879,7 @@ void MainWindow::savePlaylist()
         if (playlistPanel->savePlaylist(currentPlaylistFile)) {
             // Persist notes together with the playlist JSON
             saveServiceNotes(currentPlaylistFile);
+            serviceArchive->updateService(currentPlaylistFile);
             statusBar()->showMessage("Playlist saved", 3000);
         } else {
             QMessageBox::warning(this, "Error", "Failed to save playlist");
@@ -1876,12 +1924,172 @@ void MainWindow::savePlaylistAs()
         setWindowTitle(QString("SimplePresenter - %1").arg(QFileInfo(fileName).fileName()));
         // Persist notes together with the playlist JSON
         saveServiceNotes(fileName);
+        serviceArchive->updateService(fileName);
         statusBar()->showMessage("Playlist saved", 3000);
     } else {
         QMessageBox::warning(this, "Error", "Failed to save playlist");
     }
 }
 
+void MainWindow::showServiceHistory()
+{
+    // Picks up services copied into the folder since startup
+    serviceArchive->refresh(biblePanel->manager()->snapshot());
+    ServiceHistoryDialog dialog(serviceArchive, songPanel->manager(), this);
+    dialog.exec();
+}
+
+void MainWindow::exportServiceBundle()
+{
+#ifdef Q_OS_MACOS
+    QFileDialog dialog(this, "Export Service Bundle");
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setFileMode(QFileDialog::AnyFile);
+    dialog.setDirectory("data/services");
+    dialog.setNameFilter("Simple Presenter Service Bundles (*.spbundle);;All Files (*)");
+    dialog.setOption(QFileDialog::DontUseNativeDialog, true);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    QString fileName = dialog.selectedFiles().value(0);
+    if (fileName.isEmpty()) {
+        return;
+    }
+#else
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        "Export Service Bundle",
+        "data/services",
+        "Simple Presenter Service Bundles (*.spbundle);;All Files (*)");
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+#endif
+    const QString suffix = "." + ServiceBundle::fileSuffix();
+    if (!fileName.endsWith(suffix, Qt::CaseInsensitive)) {
+        fileName += suffix;
+    }
+
+    // Resolve every item against this machine's Bible and song library now,
+    // so the bundle needs neither where it is opened
+    QJsonObject service = playlistPanel->playlistData();
+    service["notes"] = serviceNotesJson();
+
+    BibleManager *bibleManager = biblePanel->manager();
+    SongManager *songManager = songPanel->manager();
+    QJsonArray items = service.value("items").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        QJsonObject item = items[i].toObject();
+        QJsonObject data = item.value("data").toObject();
+        const QString type = item.value("type").toString();
+
+        if (type == "bible") {
+            ScriptureReference reference;
+            if (bibleManager->parseReference(item.value("reference").toString(), reference)) {
+                QJsonArray verses;
+                for (const BibleVerse &verse : bibleManager->getVerses(reference)) {
+                    QJsonObject verseObj;
+                    verseObj["reference"] = verse.reference();
+                    verseObj["text"] = verse.text;
+                    verses.append(verseObj);
+                }
+                data["verses"] = verses;
+                data["translation"] = bibleManager->getCurrentTranslationAcronym();
+            }
+        } else if (type == "song") {
+            const QString title = item.value("title").toString();
+            SongHandle song = songManager->song(data.value("songId").toInt());
+            if (!song || song->title != title) {
+                song = songManager->songByTitle(title);
+            }
+            if (song) {
+                data["song"] = SongManager::songToJson(*song);
+            }
+        }
+
+        item["data"] = data;
+        items[i] = item;
+    }
+    service["items"] = items;
+
+    // Hashing and copying video can take a while; keep the window responsive
+    statusBar()->showMessage("Exporting service bundle...");
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, fileName]() {
+        watcher->deleteLater();
+        const QString error = watcher->result();
+        if (!error.isEmpty()) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, "Error", QString("Failed to export service bundle:\n%1").arg(error));
+            return;
+        }
+        statusBar()->showMessage(QString("Service bundle saved to %1").arg(QFileInfo(fileName).fileName()), 3000);
+    });
+    watcher->setFuture(QtConcurrent::run([fileName, service]() {
+        QString error;
+        if (!ServiceBundle::write(fileName, service, &error) && error.isEmpty()) {
+            error = QString("Unknown error writing %1").arg(fileName);
+        }
+        return error;
+    }));
+}
+
+void MainWindow::openServiceBundle(const QString &fileName)
+{
+    struct Unpacked {
+        QJsonObject service;
+        QString error;
+    };
+
+    statusBar()->showMessage("Opening service bundle...");
+    auto *watcher = new QFutureWatcher<Unpacked>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, fileName]() {
+        watcher->deleteLater();
+        const Unpacked result = watcher->result();
+        if (!result.error.isEmpty()) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, "Error", QString("Failed to open service bundle:\n%1").arg(result.error));
+            return;
+        }
+
+        // Songs this library lacks are added to it, so they can be browsed
+        // and edited like any other; ones it already has are left alone.
+        // Either way the playlist projects the bundled copy.
+        QVector<Song> bundledSongs;
+        for (const QJsonValue &value : result.service.value("items").toArray()) {
+            const QJsonObject songObj = value.toObject().value("data").toObject().value("song").toObject();
+            if (!songObj.isEmpty()) {
+                bundledSongs.append(SongManager::songFromJson(songObj));
+            }
+        }
+        if (!bundledSongs.isEmpty()) {
+            songPanel->manager()->addSongs(bundledSongs);
+        }
+
+        if (!playlistPanel->loadPlaylistData(result.service)) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, "Error", "Failed to load playlist");
+            return;
+        }
+        applyServiceNotes(result.service);
+
+        // Saving writes an ordinary playlist, never over the bundle
+        currentPlaylistFile.clear();
+        setWindowTitle(QString("SimplePresenter - %1").arg(QFileInfo(fileName).fileName()));
+        statusBar()->showMessage("Service bundle loaded", 3000);
+    });
+    watcher->setFuture(QtConcurrent::run([fileName]() {
+        Unpacked result;
+        if (!ServiceBundle::read(fileName, ServiceBundle::mediaCacheDirectory(), result.service, &result.error)
+            && result.error.isEmpty()) {
+            result.error = QString("Unknown error reading %1").arg(fileName);
+        }
+        return result;
+    }));
+}
+
 void MainWindow::showSettings()
 {
     SettingsDialog dialog(this);
@@ -1919,8 +2127,9 @@ void MainWindow::showSettings()
         
         // Reload overlay server settings
         if (overlayServer) {
+            // Style changes reach OBS pages as a patch; no reload needed
             overlayServer->loadSettings();
-            overlayServer->triggerRefresh();  // Trigger OBS browser refresh
+            programStream->loadSettings();
         }
 
         // Force repaint to show new settings
@@ -2297,7 +2506,6 @@ void MainWindow::projectMediaItem(const QString &path, bool isVideo)
         // Broadcast media load to OBS via WebSocket
         qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
         overlayServer->broadcastMediaLoad(path, isVideo, timestamp);
-        overlayServer->triggerRefresh();
     }
     
     statusBar()->showMessage(QString("Projecting media: %1").arg(QFileInfo(path).fileName()), 3000);
@@ -2317,18 +2525,6 @@ void MainWindow::onMediaVideoStarted()
         mediaSeekSlider->setValue(0);
     }
 
-#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
-    if (projectionCanvas && projectionCanvas->isYouTubeActive()) {
-        if (youtubePositionTimer) {
-            youtubePositionTimer->start();
-        }
-    } else {
-        if (youtubePositionTimer) {
-            youtubePositionTimer->stop();
-        }
-    }
-#endif
-
     if (mediaVolumeSlider) {
         if (QAudioOutput *output = projectionCanvas->mediaAudioOutput()) {
             mediaVolumeSlider->blockSignals(true);
@@ -2395,11 +2591,6 @@ void MainWindow::onMediaVideoStopped()
         mediaSeekSlider->setRange(0, 1000);
         mediaSeekSlider->setValue(0);
     }
-#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
-    if (youtubePositionTimer) {
-        youtubePositionTimer->stop();
-    }
-#endif
     updateMediaPlayPauseIcon();
 }
 
@@ -2450,10 +2641,15 @@ void MainWindow::onMediaPlaybackStateChanged(QMediaPlayer::PlaybackState state)
         return;
     }
     updateMediaPlayPauseIcon();
+    syncMediaOverlayToProjection();
 }
 
 void MainWindow::onMediaPositionChanged(qint64 position)
 {
+    // Re-anchors the OBS overlay's media clock when the projector drifts
+    // from it; cheap when it has not
+    syncMediaOverlayToProjection();
+
     if (!mediaControlsWidget || !mediaControlsWidget->isVisible() || mediaSeekSliderDragging || !mediaSeekSlider) {
         return;
     }
@@ -2620,6 +2816,8 @@ void MainWindow::closeEvent(QCloseEvent *event)
         }
     }
     
+    // Closed cleanly, so there is nothing to recover next time
+    playlistPanel->discardJournal();
     saveSettings();
 
     if (fullscreenProjection) {
@@ -9,6 +9,7 @@
 #include <QSettings>
 #include <QMediaPlayer>
 #include <QVector>
+#include <QJsonObject>
 
 class BiblePanel;
 class SongPanel;
@@ -17,6 +18,8 @@ class ProjectionCanvas;
 class MediaPanel;
 class PowerPointPanel;
 class OverlayServer;
+class ProgramFrameStream;
+class ServiceArchiveIndex;
 class UpdateChecker;
 class QToolButton;
 class QSlider;
@@ -51,6 +54,8 @@ private slots:
     void openPlaylist();
     void savePlaylist();
     void savePlaylistAs();
+    void exportServiceBundle();
+    void showServiceHistory();
     void showSettings();
     void showAbout();
     void clearOverlays();
@@ -64,6 +69,8 @@ private slots:
     void onMediaPlaybackStateChanged(QMediaPlayer::PlaybackState state);
     void onMediaPositionChanged(qint64 position);
     void onMediaDurationChanged(qint64 duration);
+    void onYouTubePositionChanged(double ratio);
+    void onYouTubePlayingChanged(bool playing);
     void onMediaSeekSliderPressed();
     void onMediaSeekSliderReleased();
     void onMediaSeekSliderMoved(int value);
@@ -86,8 +93,12 @@ private:
     void updateMediaPlayPauseIcon();
     void loadSettings();
     void saveSettings();
+    void recoverPlaylist();
     void loadServiceNotes(const QString &filePath);
+    void applyServiceNotes(const QJsonObject &root);
+    QJsonObject serviceNotesJson();
     void saveServiceNotes(const QString &filePath);
+    void openServiceBundle(const QString &fileName);
     void updateProjectionAndNotesAspect();
     void updateNotesOverlayAsMedia();
     void syncYouTubeOverlayToProjection();
@@ -131,6 +142,10 @@ private:
     
     // Overlay server for OBS
     OverlayServer *overlayServer;
+    ProgramFrameStream *programStream;
+
+    // Index of saved services for usage queries
+    ServiceArchiveIndex *serviceArchive;
 
     // Update Checker
     UpdateChecker *updateChecker;
@@ -142,7 +157,6 @@ private:
     QSlider *mediaVolumeSlider;
     bool mediaSeekSliderDragging;
     bool youtubePlaying;
-    QTimer *youtubePositionTimer;
 
     // Toolbar actions
     QAction *newAction;
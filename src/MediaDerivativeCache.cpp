@@ -0,0 +1,360 @@
+#include "MediaDerivativeCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+namespace {
+
+// Bump when derivatives are made differently, so older ones are not served
+const QString kCacheSubdirectory = QStringLiteral("media-derivatives/v1");
+const int kJpegQuality = 90;
+
+qint64 modifiedTime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+} // namespace
+
+MediaDerivativeCache::MediaDerivativeCache(QObject *parent)
+    : QObject(parent)
+    , targetSize(1920, 1080)
+    , transcodeVideos(false)
+    , cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    dir.mkpath(kCacheSubdirectory);
+    cacheDirectory = dir.filePath(kCacheSubdirectory);
+
+    connect(&worker, &QFutureWatcher<Result>::finished, this, &MediaDerivativeCache::onJobFinished);
+    loadIndex();
+}
+
+MediaDerivativeCache::~MediaDerivativeCache()
+{
+    // A transcode can take minutes; stop it rather than wait for it
+    *cancelled = true;
+    worker.waitForFinished();
+}
+
+void MediaDerivativeCache::setTargetSize(const QSize &size)
+{
+    if (size.isValid() && !size.isEmpty()) {
+        targetSize = size;
+    }
+}
+
+void MediaDerivativeCache::setTranscodeVideos(bool enabled)
+{
+    transcodeVideos = enabled;
+    if (enabled && ffmpeg.isEmpty()) {
+        ffmpeg = findFfmpeg();
+        if (ffmpeg.isEmpty()) {
+            qWarning() << "ffmpeg not found; videos are served to OBS as they are";
+        }
+    }
+}
+
+QString MediaDerivativeCache::findFfmpeg()
+{
+    QString path = QStandardPaths::findExecutable("ffmpeg");
+    if (path.isEmpty()) {
+        // Apps started from the Finder do not get the shell's PATH
+        path = QStandardPaths::findExecutable("ffmpeg", {"/opt/homebrew/bin", "/usr/local/bin"});
+    }
+    return path;
+}
+
+const MediaDerivativeCache::Source *MediaDerivativeCache::freshSource(const QString &filePath) const
+{
+    const auto it = sources.constFind(filePath);
+    if (it == sources.constEnd()) {
+        return nullptr;
+    }
+    const QFileInfo info(filePath);
+    if (!info.exists() || info.size() != it->size || modifiedTime(info) != it->modified) {
+        return nullptr;
+    }
+    return &it.value();
+}
+
+QString MediaDerivativeCache::derivativePath(const QString &filePath) const
+{
+    const Source *source = freshSource(filePath);
+    if (!source || source->hash.isEmpty()) {
+        return QString();
+    }
+    const QString base = QDir(cacheDirectory).filePath(derivativeBaseName(source->hash, targetSize));
+    for (const char *extension : {".jpg", ".png", ".mp4"}) {
+        const QString path = base + QLatin1String(extension);
+        if (QFileInfo::exists(path)) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+void MediaDerivativeCache::prepare(const QString &filePath, bool isVideo)
+{
+    if (filePath.isEmpty() || (isVideo && (!transcodeVideos || ffmpeg.isEmpty()))) {
+        return;
+    }
+    // Already done, or already tried for this size (a failed transcode is
+    // not retried every time the video is shown)
+    const Source *source = freshSource(filePath);
+    if (source && source->attempted == targetSize) {
+        return;
+    }
+    if (!derivativePath(filePath).isEmpty() || filePath == runningPath) {
+        return;
+    }
+    for (const Job &queued : queue) {
+        if (queued.filePath == filePath) {
+            return;
+        }
+    }
+
+    Job job;
+    job.filePath = filePath;
+    job.isVideo = isVideo;
+    job.size = targetSize;
+    job.knownHash = source ? source->hash : QByteArray();
+    job.cacheDirectory = cacheDirectory;
+    job.ffmpeg = ffmpeg;
+    queue.append(job);
+    startNext();
+}
+
+void MediaDerivativeCache::startNext()
+{
+    if (worker.isRunning() || queue.isEmpty()) {
+        return;
+    }
+    const Job job = queue.takeFirst();
+    runningPath = job.filePath;
+    const std::shared_ptr<std::atomic<bool>> stop = cancelled;
+    worker.setFuture(QtConcurrent::run([job, stop]() {
+        return build(job, *stop);
+    }));
+}
+
+void MediaDerivativeCache::onJobFinished()
+{
+    const Result result = worker.result();
+    runningPath.clear();
+
+    if (result.size > 0) {
+        Source &source = sources[result.filePath];
+        const bool hashChanged = source.hash != result.hash;
+        source.size = result.size;
+        source.modified = result.modified;
+        source.hash = result.hash;
+        source.attempted = targetSize;
+        if (hashChanged && !result.hash.isEmpty()) {
+            saveIndex();
+        }
+    }
+    startNext();
+}
+
+MediaDerivativeCache::Result MediaDerivativeCache::build(const Job &job, const std::atomic<bool> &cancelled)
+{
+    Result result;
+    result.filePath = job.filePath;
+    const QFileInfo info(job.filePath);
+    if (!info.exists() || cancelled) {
+        return result;
+    }
+    result.size = info.size();
+    result.modified = modifiedTime(info);
+
+    if (!job.isVideo) {
+        // Images that already fit, and animations, are served as they are;
+        // reading the header is enough to tell
+        QImageReader reader(job.filePath);
+        QSize source = reader.size();
+        if (reader.transformation() & QImageIOHandler::TransformationRotate90) {
+            source.transpose();
+        }
+        if (!source.isValid() || (reader.supportsAnimation() && reader.imageCount() > 1)
+            || (source.width() <= job.size.width() && source.height() <= job.size.height())) {
+            return result;
+        }
+    }
+
+    result.hash = job.knownHash.isEmpty() ? contentHash(job.filePath, cancelled) : job.knownHash;
+    if (result.hash.isEmpty()) {
+        return result;
+    }
+
+    const QString basePath = QDir(job.cacheDirectory).filePath(derivativeBaseName(result.hash, job.size));
+    for (const char *extension : {".jpg", ".png", ".mp4"}) {
+        // Made before, possibly from a copy of this file
+        if (QFileInfo::exists(basePath + QLatin1String(extension))) {
+            result.derivativePath = basePath + QLatin1String(extension);
+            return result;
+        }
+    }
+
+    result.derivativePath = job.isVideo
+        ? transcodeVideo(job.ffmpeg, job.filePath, job.size, basePath, cancelled)
+        : scaleImage(job.filePath, job.size, basePath);
+    return result;
+}
+
+QByteArray MediaDerivativeCache::contentHash(const QString &filePath, const std::atomic<bool> &cancelled)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray buffer(1024 * 1024, Qt::Uninitialized);
+    for (;;) {
+        if (cancelled) {
+            return QByteArray();
+        }
+        const qint64 read = file.read(buffer.data(), buffer.size());
+        if (read < 0) {
+            return QByteArray();
+        }
+        if (read == 0) {
+            break;
+        }
+        hash.addData(QByteArrayView(buffer.constData(), read));
+    }
+    return hash.result().toHex();
+}
+
+QString MediaDerivativeCache::derivativeBaseName(const QByteArray &hash, const QSize &size)
+{
+    return QString::fromLatin1(hash) + QString("_%1x%2").arg(size.width()).arg(size.height());
+}
+
+QString MediaDerivativeCache::scaleImage(const QString &filePath, const QSize &size, const QString &basePath)
+{
+    QImageReader reader(filePath);
+    reader.setAutoTransform(true);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "Could not read image for OBS derivative:" << filePath << reader.errorString();
+        return QString();
+    }
+    image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    const bool transparent = image.hasAlphaChannel();
+    const QString path = basePath + (transparent ? ".png" : ".jpg");
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || !image.save(&file, transparent ? "PNG" : "JPG", transparent ? -1 : kJpegQuality)
+        || !file.commit()) {
+        qWarning() << "Could not write OBS derivative:" << path;
+        return QString();
+    }
+    return path;
+}
+
+QString MediaDerivativeCache::transcodeVideo(const QString &ffmpeg, const QString &filePath, const QSize &size,
+                                             const QString &basePath, const std::atomic<bool> &cancelled)
+{
+    if (ffmpeg.isEmpty()) {
+        return QString();
+    }
+    const QString path = basePath + ".mp4";
+    const QString partialPath = basePath + ".part.mp4";
+
+    // Video only (the overlay plays it muted), never scaled up, with the
+    // index at the front so the browser can start before it has it all
+    const QString scale = QString("scale='min(%1,iw)':'min(%2,ih)'"
+                                  ":force_original_aspect_ratio=decrease:force_divisible_by=2")
+                              .arg(size.width())
+                              .arg(size.height());
+    QProcess process;
+    process.setProgram(ffmpeg);
+    process.setArguments({"-nostdin", "-y", "-v", "error",
+                          "-i", filePath,
+                          "-map", "0:v:0", "-vf", scale,
+                          "-c:v", "libx264", "-preset", "veryfast", "-crf", "23", "-pix_fmt", "yuv420p",
+                          "-an", "-movflags", "+faststart",
+                          partialPath});
+    process.setProcessChannelMode(QProcess::MergedChannels);
+
+    process.start();
+    if (!process.waitForStarted(30000)) {
+        qWarning() << "Failed to start ffmpeg:" << ffmpeg;
+        return QString();
+    }
+    while (process.state() != QProcess::NotRunning) {
+        if (cancelled) {
+            process.kill();
+            process.waitForFinished(5000);
+            QFile::remove(partialPath);
+            return QString();
+        }
+        process.waitForFinished(500);
+    }
+
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        qWarning() << "ffmpeg could not make a proxy of" << filePath << ":"
+                   << QString::fromLocal8Bit(process.readAll()).trimmed();
+        QFile::remove(partialPath);
+        return QString();
+    }
+    QFile::remove(path);
+    if (!QFile::rename(partialPath, path)) {
+        QFile::remove(partialPath);
+        return QString();
+    }
+    return path;
+}
+
+void MediaDerivativeCache::loadIndex()
+{
+    QFile file(QDir(cacheDirectory).filePath("index.json"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonObject files = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        Source source;
+        source.size = static_cast<qint64>(entry.value("size").toDouble());
+        source.modified = static_cast<qint64>(entry.value("modified").toDouble());
+        source.hash = entry.value("hash").toString().toLatin1();
+        if (!source.hash.isEmpty()) {
+            sources.insert(it.key(), source);
+        }
+    }
+}
+
+void MediaDerivativeCache::saveIndex() const
+{
+    QJsonObject files;
+    for (auto it = sources.constBegin(); it != sources.constEnd(); ++it) {
+        if (it->hash.isEmpty()) {
+            continue;
+        }
+        QJsonObject entry;
+        entry["size"] = static_cast<double>(it->size);
+        entry["modified"] = static_cast<double>(it->modified);
+        entry["hash"] = QString::fromLatin1(it->hash);
+        files.insert(it.key(), entry);
+    }
+
+    QSaveFile file(QDir(cacheDirectory).filePath("index.json"));
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(files).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef MEDIADERIVATIVECACHE_H
+#define MEDIADERIVATIVECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QSize>
+#include <QHash>
+#include <QList>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+
+// Copies of media sized for the OBS canvas, for clients that should not be
+// sent the original: a 24-megapixel photo becomes a JPEG (or PNG, when it
+// has transparency) that fits the canvas, and a video, when enabled and
+// ffmpeg is installed, a light H.264 proxy.
+//
+// Derivatives are named by a hash of the source's content and the target
+// size, so copies of one file share them and an edited file gets new
+// ones. The hash of each source is remembered by path, size and
+// modification time so it is only computed once. Work is queued and done
+// one file at a time on a worker thread.
+class MediaDerivativeCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MediaDerivativeCache(QObject *parent = nullptr);
+    ~MediaDerivativeCache();
+
+    void setTargetSize(const QSize &size);
+    void setTranscodeVideos(bool enabled);
+
+    // Queues a derivative of filePath unless it has one or does not need one
+    void prepare(const QString &filePath, bool isVideo);
+
+    // The derivative to serve instead of filePath, or empty when none is ready
+    QString derivativePath(const QString &filePath) const;
+
+    static QString findFfmpeg();
+
+private:
+    struct Source {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray hash;  // empty when no derivative was needed
+        QSize attempted;  // target size last worked on this session
+    };
+
+    struct Job {
+        QString filePath;
+        bool isVideo = false;
+        QSize size;
+        QByteArray knownHash;
+        QString cacheDirectory;
+        QString ffmpeg;
+    };
+
+    struct Result {
+        QString filePath;
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray hash;
+        QString derivativePath;
+    };
+
+    static Result build(const Job &job, const std::atomic<bool> &cancelled);
+    static QByteArray contentHash(const QString &filePath, const std::atomic<bool> &cancelled);
+    static QString scaleImage(const QString &filePath, const QSize &size, const QString &basePath);
+    static QString transcodeVideo(const QString &ffmpeg, const QString &filePath, const QSize &size,
+                                  const QString &basePath, const std::atomic<bool> &cancelled);
+    static QString derivativeBaseName(const QByteArray &hash, const QSize &size);
+
+    const Source *freshSource(const QString &filePath) const;
+    void startNext();
+    void onJobFinished();
+    void loadIndex();
+    void saveIndex() const;
+
+    QString cacheDirectory;
+    QSize targetSize;
+    bool transcodeVideos;
+    QString ffmpeg;
+
+    QHash<QString, Source> sources;
+    QList<Job> queue;
+    QString runningPath;
+    QFutureWatcher<Result> worker;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+#endif // MEDIADERIVATIVECACHE_H
@@ -236,6 +236,10 @@ void MediaPanel::addMediaItem(const QString &filePath, bool isVideo, bool copyFi
         QIcon videoIcon = QIcon::fromTheme("video-x-generic", defaultIcon);
         item->setIcon(videoIcon);
     }
+
+    if (copyFile) {
+        emit mediaAdded(destinationPath, isVideo);
+    }
 }
 
 void MediaPanel::onAddImage()
@@ -25,6 +25,7 @@ public:
 
 signals:
     void mediaSelected(const QString &path, bool isVideo);
+    void mediaAdded(const QString &path, bool isVideo);
     void mediaAddedToPlaylist(const QString &displayName, const QString &path, bool isVideo);
     void mediaAboutToRemove(const QString &path, bool wasVideo);
     void mediaRemoved(const QString &path, bool wasVideo);
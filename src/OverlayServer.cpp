@@ -1,26 +1,24 @@
 #include "OverlayServer.h"
+#include "OverlayServerWorker.h"
+#include "MediaDerivativeCache.h"
 #include <QDateTime>
 #include <QJsonDocument>
-#include <QJsonObject>
 #include <QUrl>
 #include <QSettings>
-#include <QFile>
-#include <QFileInfo>
-#include <QTcpSocket>
-#include <QIcon>
-#include <QImage>
-#include <QBuffer>
+#include <QThread>
+#include <QTimer>
 
 namespace {
 
-QString escapeJsonString(QString value)
-{
-    value.replace("\\", "\\\\");
-    value.replace("\"", "\\\"");
-    value.replace("\n", "\\n");
-    value.replace("\r", "");
-    return value;
-}
+// The projector's position may differ this much from the running media
+// clock before pages are sent a new anchor. QMediaPlayer reports positions
+// in frame steps and late, so this is a frame at 30 fps plus reporting
+// jitter; pages trim smaller drift themselves.
+constexpr double kMediaClockToleranceMs = 40.0;
+
+// Resuming playback is anchored this far ahead, about what the projector
+// takes to start, so pages start on time rather than seek to catch up
+constexpr double kMediaStartLeadMs = 80.0;
 
 QString formatBracketTextPlain(const QString &input)
 {
@@ -79,12 +77,12 @@ QString formatBracketTextHtml(const QString &input)
 
 OverlayServer::OverlayServer(QObject *parent)
     : QObject(parent)
-    , server(new QTcpServer(this))
-    , wsServer(new QWebSocketServer("OverlayWebSocket", QWebSocketServer::NonSecureMode, this))
-    , notesVisible(false)
-    , currentMediaIsVideo(false)
-    , currentMediaTimestamp(0)
-    , refreshTimestamp(0)
+    , ioThread(new QThread(this))
+    , worker(new OverlayServerWorker())
+    , derivatives(new MediaDerivativeCache(this))
+    , running(false)
+    , listenPort(0)
+    , pendingStateFields(0)
     , canvasWidth(1920)
     , canvasHeight(1080)
     , textColor(Qt::white)
@@ -109,7 +107,6 @@ OverlayServer::OverlayServer(QObject *parent)
     , refOutlineColor(Qt::black)
     , refHighlight(false)
     , refHighlightColor(0, 0, 0, 180)
-    , notesImageTimestamp(0)
 {
     textFont.setFamily("Arial");
     textFont.setPointSize(42);
@@ -118,147 +115,244 @@ OverlayServer::OverlayServer(QObject *parent)
     referenceFont.setPointSize(28);
     
     loadSettings();
-    
-    connect(server, &QTcpServer::newConnection, this, &OverlayServer::onNewConnection);
-    connect(wsServer, &QWebSocketServer::newConnection, this, &OverlayServer::onWsNewConnection);
+
+    ioThread->setObjectName("OverlayServerIO");
+    worker->moveToThread(ioThread);
+    connect(ioThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &OverlayServerWorker::webSocketClientConnected, this, &OverlayServer::webSocketClientConnected);
+    connect(worker, &OverlayServerWorker::programStreamDemandChanged, this, &OverlayServer::programStreamDemandChanged);
+    connect(worker, &OverlayServerWorker::youTubeClientReady, this, &OverlayServer::youTubeClientReady);
+    ioThread->start();
 }
 
 OverlayServer::~OverlayServer()
 {
     stop();
+    ioThread->quit();
+    ioThread->wait();
 }
 
 bool OverlayServer::start(quint16 port)
 {
-    if (server->isListening()) {
-        return true;
+    // The worker must have a page to serve before the first client arrives
+    flushState();
+
+    bool ok = false;
+    QMetaObject::invokeMethod(worker, [this, port, &ok]() {
+        ok = worker->start(port);
+    }, Qt::BlockingQueuedConnection);
+    running = running || ok;
+    if (ok) {
+        listenPort = port;
     }
-    
-    bool httpOk = server->listen(QHostAddress::Any, port);
-    bool wsOk = wsServer->listen(QHostAddress::Any, port + 1);  // WebSocket on port 8081
-    
-    return httpOk && wsOk;
+    return ok;
 }
 
 void OverlayServer::stop()
 {
-    for (QTcpSocket *client : clients) {
-        client->disconnectFromHost();
-        client->deleteLater();
-    }
-    clients.clear();
-    
-    for (QWebSocket *wsClient : wsClients) {
-        wsClient->close();
-        wsClient->deleteLater();
-    }
-    wsClients.clear();
-    
-    if (server->isListening()) {
-        server->close();
-    }
-    
-    if (wsServer->isListening()) {
-        wsServer->close();
+    if (!running) {
+        return;
     }
+    QMetaObject::invokeMethod(worker, [this]() {
+        worker->stop();
+    }, Qt::BlockingQueuedConnection);
+    running = false;
 }
 
 bool OverlayServer::isRunning() const
 {
-    return server->isListening();
+    return running;
 }
 
 quint16 OverlayServer::port() const
 {
-    return server->serverPort();
+    return running ? listenPort : 0;
 }
 
 void OverlayServer::updateOverlay(const QString &reference, const QString &text)
 {
-    currentReference = reference;
+    if (reference == current.reference && text == currentText) {
+        return;
+    }
+    current.reference = reference;
     currentText = text;
+    // Formatted once here rather than for every page that asks
+    current.text = formatBracketTextPlain(text);
+    current.textHtml = formatBracketTextHtml(text);
+    markStateChanged(OverlayState::Text);
 }
 
 void OverlayServer::clearOverlay()
 {
-    currentReference.clear();
+    current.reference.clear();
     currentText.clear();
-    currentNotesHtml.clear();
-    notesVisible = false;
-    currentNotesPng.clear();
-    notesImageTimestamp = 0;
-    currentMediaPath.clear();
-    currentMediaIsVideo = false;
-    currentMediaTimestamp = QDateTime::currentMSecsSinceEpoch();
-    currentYouTubeUrl.clear();
+    current.text.clear();
+    current.textHtml.clear();
+    current.notesHtml.clear();
+    current.notesVisible = false;
+    current.notesImage = QImage();
+    current.notesImageTimestamp = 0;
+    current.mediaPath.clear();
+    current.mediaServePath.clear();
+    current.mediaIsVideo = false;
+    current.mediaTimestamp = QDateTime::currentMSecsSinceEpoch();
+    current.youTubeUrl.clear();
+    markStateChanged(OverlayState::Text | OverlayState::Media | OverlayState::YouTube | OverlayState::Notes);
 }
 
 void OverlayServer::updateNotes(const QString &notesHtml, bool visible)
 {
-    currentNotesHtml = notesHtml;
-    notesVisible = visible;
+    current.notesHtml = notesHtml;
+    current.notesVisible = visible;
+    markStateChanged(OverlayState::Notes);
 }
 
 void OverlayServer::updateNotesImage(const QImage &image, bool visible)
 {
-    notesVisible = visible;
-    currentNotesPng.clear();
+    current.notesVisible = visible;
 
+    // Scaling and PNG encoding happen on the I/O thread, once per image
     if (visible && !image.isNull()) {
-        QImage img = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
-
-        // The notes image comes from the Projection Canvas preview. To avoid
-        // the OBS overlay making the text look larger than it appears on the
-        // canvas, never upscale it beyond the size of the media card. If the
-        // preview image is larger than the card, gently scale it down to fit;
-        // otherwise, keep it at its original size.
-        if (canvasWidth > 0 && canvasHeight > 0) {
-            const int cardW = static_cast<int>(canvasWidth * 0.40);
-            const int cardH = static_cast<int>(canvasHeight * 0.40);
-            if (cardW > 0 && cardH > 0 && (img.width() > cardW || img.height() > cardH)) {
-                img = img.scaled(cardW, cardH, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            }
-        }
-        QBuffer buffer(&currentNotesPng);
-        buffer.open(QIODevice::WriteOnly);
-        img.save(&buffer, "PNG");
-        notesImageTimestamp = QDateTime::currentMSecsSinceEpoch();
+        current.notesImage = image;
+        current.notesImageTimestamp = QDateTime::currentMSecsSinceEpoch();
     } else {
-        notesImageTimestamp = 0;
+        current.notesImage = QImage();
+        current.notesImageTimestamp = 0;
     }
+    markStateChanged(OverlayState::Notes);
 }
 
 void OverlayServer::updateMedia(const QString &mediaPath, bool isVideo)
 {
     // Always update timestamp so the overlay reloads even if the same file path is reused
-    currentMediaTimestamp = QDateTime::currentMSecsSinceEpoch();
-    currentMediaPath = mediaPath;
-    currentMediaIsVideo = isVideo;
+    current.mediaTimestamp = QDateTime::currentMSecsSinceEpoch();
+    current.mediaPath = mediaPath;
+    current.mediaIsVideo = isVideo;
+    // Only a derivative that is ready now is used: switching files under a
+    // page that is already fetching ranges of this one would corrupt it
+    current.mediaServePath = derivatives->derivativePath(mediaPath);
+    if (current.mediaServePath.isEmpty()) {
+        derivatives->prepare(mediaPath, isVideo);
+    }
+    // Unknown until the projector reports on the new media
+    current.mediaPlaying = false;
+    current.mediaPositionMs = 0;
+    current.mediaClockTime = 0;
+    current.mediaRate = 1.0;
+    markStateChanged(OverlayState::Media | OverlayState::MediaClock);
+}
+
+void OverlayServer::prepareMedia(const QString &mediaPath, bool isVideo)
+{
+    derivatives->prepare(mediaPath, isVideo);
 }
 
 void OverlayServer::updateYouTube(const QString &youtubeUrl)
 {
-    currentYouTubeUrl = youtubeUrl;
+    if (youtubeUrl == current.youTubeUrl) {
+        return;
+    }
+    current.youTubeUrl = youtubeUrl;
+    markStateChanged(OverlayState::YouTube);
 }
 
 void OverlayServer::triggerRefresh()
 {
-    refreshTimestamp = QDateTime::currentMSecsSinceEpoch();
+    current.refreshTimestamp = QDateTime::currentMSecsSinceEpoch();
+    markStateChanged(OverlayState::Refresh);
 }
 
-void OverlayServer::broadcastMediaSeek(qint64 positionMs)
+void OverlayServer::markStateChanged(int fields)
 {
-    QJsonObject msg;
-    msg["type"] = "media_seek";
-    msg["positionMs"] = positionMs;
-    msg["timestamp"] = currentMediaTimestamp;
-    
-    QJsonDocument doc(msg);
-    QString json = doc.toJson(QJsonDocument::Compact);
-    
-    for (QWebSocket *wsClient : wsClients) {
-        wsClient->sendTextMessage(json);
+    ++current.version;
+    if (pendingStateFields == 0) {
+        // Setters usually come in a burst (text, media, YouTube, refresh);
+        // publish them as one snapshot once control returns to the event loop
+        QTimer::singleShot(0, this, &OverlayServer::flushState);
+    }
+    pendingStateFields |= fields;
+}
+
+void OverlayServer::flushState()
+{
+    int fields = pendingStateFields;
+    pendingStateFields = 0;
+
+    if (fields & OverlayState::Style) {
+        // Pages are sent only the properties that changed. The page is
+        // regenerated too, so that pages loaded later start out with them.
+        const QJsonObject style = styleVariables();
+        current.styleChanges = QJsonObject();
+        for (auto it = style.constBegin(); it != style.constEnd(); ++it) {
+            if (current.style.value(it.key()) != it.value()) {
+                current.styleChanges.insert(it.key(), it.value());
+            }
+        }
+        if (current.styleChanges.isEmpty()) {
+            fields &= ~OverlayState::Style;
+        } else {
+            current.style = style;
+            fields |= OverlayState::Page;
+        }
+    }
+    if (fields == 0) {
+        return;
     }
+
+    if (fields & OverlayState::Page) {
+        current.page = generateHTML().toUtf8();
+        ++current.pageVersion;
+    }
+
+    const OverlayStateSnapshot snapshot = std::make_shared<const OverlayState>(current);
+    QMetaObject::invokeMethod(worker, [worker = worker, snapshot, fields]() {
+        worker->setState(snapshot, fields);
+    }, Qt::QueuedConnection);
+}
+
+void OverlayServer::postToWebSockets(const QJsonObject &msg)
+{
+    // Pages must see the state a message refers to (e.g. the media a seek
+    // is for) before the message itself
+    flushState();
+    QMetaObject::invokeMethod(worker, [worker = worker, msg]() {
+        worker->sendToWebSockets(msg);
+    }, Qt::QueuedConnection);
+}
+
+double OverlayServer::expectedMediaPosition(double now) const
+{
+    if (!current.mediaPlaying || current.mediaClockTime <= 0) {
+        return static_cast<double>(current.mediaPositionMs);
+    }
+    // An anchor in the future is a position to start playing from
+    return current.mediaPositionMs + qMax(0.0, now - current.mediaClockTime) * current.mediaRate;
+}
+
+void OverlayServer::setMediaAnchor(bool playing, qint64 positionMs, double clockTime, double rate)
+{
+    current.mediaPlaying = playing;
+    current.mediaPositionMs = qMax<qint64>(0, positionMs);
+    current.mediaClockTime = clockTime;
+    current.mediaRate = rate > 0.0 ? rate : 1.0;
+    markStateChanged(OverlayState::MediaClock);
+}
+
+void OverlayServer::updateMediaClock(bool playing, qint64 positionMs, double rate)
+{
+    const double now = OverlayState::clockMs();
+    if (current.mediaClockTime > 0 && playing == current.mediaPlaying && rate == current.mediaRate
+        && qAbs(expectedMediaPosition(now) - positionMs) < kMediaClockToleranceMs) {
+        // Pages already extrapolate to this position; a fresh anchor
+        // would only add the jitter of this sample
+        return;
+    }
+    setMediaAnchor(playing, positionMs, now, rate);
+}
+
+void OverlayServer::broadcastMediaSeek(qint64 positionMs)
+{
+    setMediaAnchor(current.mediaPlaying, positionMs, OverlayState::clockMs(), current.mediaRate);
 }
 
 void OverlayServer::broadcastYouTubeSeek(double ratio)
@@ -267,12 +361,7 @@ void OverlayServer::broadcastYouTubeSeek(double ratio)
     msg["type"] = "youtube_seek";
     msg["ratio"] = ratio;
 
-    QJsonDocument doc(msg);
-    QString json = doc.toJson(QJsonDocument::Compact);
-
-    for (QWebSocket *wsClient : wsClients) {
-        wsClient->sendTextMessage(json);
-    }
+    postToWebSockets(msg);
 }
 
 void OverlayServer::broadcastYouTubePlayPause(bool playing)
@@ -281,27 +370,14 @@ void OverlayServer::broadcastYouTubePlayPause(bool playing)
     msg["type"] = "youtube_playpause";
     msg["playing"] = playing;
 
-    QJsonDocument doc(msg);
-    QString json = doc.toJson(QJsonDocument::Compact);
-
-    for (QWebSocket *wsClient : wsClients) {
-        wsClient->sendTextMessage(json);
-    }
+    postToWebSockets(msg);
 }
 
 void OverlayServer::broadcastMediaPlayPause(bool playing)
 {
-    QJsonObject msg;
-    msg["type"] = "media_playpause";
-    msg["playing"] = playing;
-    msg["timestamp"] = currentMediaTimestamp;
-    
-    QJsonDocument doc(msg);
-    QString json = doc.toJson(QJsonDocument::Compact);
-    
-    for (QWebSocket *wsClient : wsClients) {
-        wsClient->sendTextMessage(json);
-    }
+    const double now = OverlayState::clockMs();
+    const qint64 position = static_cast<qint64>(expectedMediaPosition(now));
+    setMediaAnchor(playing, position, playing ? now + kMediaStartLeadMs : now, current.mediaRate);
 }
 
 void OverlayServer::broadcastMediaLoad(const QString &mediaPath, bool isVideo, qint64 timestamp)
@@ -311,22 +387,26 @@ void OverlayServer::broadcastMediaLoad(const QString &mediaPath, bool isVideo, q
     msg["isVideo"] = isVideo;
     msg["timestamp"] = timestamp;
     
-    QJsonDocument doc(msg);
-    QString json = doc.toJson(QJsonDocument::Compact);
-    
-    for (QWebSocket *wsClient : wsClients) {
-        wsClient->sendTextMessage(json);
-    }
+    postToWebSockets(msg);
+}
+
+void OverlayServer::publishProgramFrame(const QByteArray &jpeg)
+{
+    QMetaObject::invokeMethod(worker, [worker = worker, jpeg]() {
+        worker->setProgramFrame(jpeg);
+    }, Qt::QueuedConnection);
 }
 
 void OverlayServer::setTextColor(const QColor &color)
 {
     textColor = color;
+    markStateChanged(OverlayState::Style);
 }
 
 void OverlayServer::setReferenceColor(const QColor &color)
 {
     referenceColor = color;
+    markStateChanged(OverlayState::Style);
 }
 
 void OverlayServer::setFont(const QFont &font)
@@ -335,6 +415,7 @@ void OverlayServer::setFont(const QFont &font)
     textBold = font.bold();
     textItalic = font.italic();
     textUnderline = font.underline();
+    markStateChanged(OverlayState::Style);
 }
 
 void OverlayServer::setReferenceFont(const QFont &refFont)
@@ -343,6 +424,7 @@ void OverlayServer::setReferenceFont(const QFont &refFont)
     refBold = refFont.bold();
     refItalic = refFont.italic();
     refUnderline = refFont.underline();
+    markStateChanged(OverlayState::Style);
 }
 
 void OverlayServer::loadSettings()
@@ -389,302 +471,73 @@ void OverlayServer::loadSettings()
     referenceFont.setBold(refBold);
     referenceFont.setItalic(refItalic);
     referenceFont.setUnderline(refUnderline);
+
+    const bool transcodeVideos = settings.value("transcodeVideoProxies", false).toBool();
     
     settings.endGroup();
-}
-
-void OverlayServer::onNewConnection()
-{
-    while (server->hasPendingConnections()) {
-        QTcpSocket *client = server->nextPendingConnection();
-        clients.append(client);
-        
-        connect(client, &QTcpSocket::disconnected, this, &OverlayServer::onClientDisconnected);
-        connect(client, &QTcpSocket::readyRead, this, &OverlayServer::onReadyRead);
-    }
-}
 
-void OverlayServer::onClientDisconnected()
-{
-    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
-    if (client) {
-        clients.removeAll(client);
-        client->deleteLater();
-    }
+    current.canvasSize = QSize(canvasWidth, canvasHeight);
+    derivatives->setTargetSize(current.canvasSize);
+    derivatives->setTranscodeVideos(transcodeVideos);
+    markStateChanged(OverlayState::Style);
 }
 
-void OverlayServer::onWsNewConnection()
+QJsonObject OverlayServer::styleVariables() const
 {
-    QWebSocket *wsClient = wsServer->nextPendingConnection();
-    if (wsClient) {
-        wsClients.append(wsClient);
-        connect(wsClient, &QWebSocket::disconnected, this, &OverlayServer::onWsDisconnected);
-        qDebug() << "WebSocket client connected";
-        emit webSocketClientConnected();
-    }
-}
+    auto fontStack = [](const QString &family) {
+        return QString("'%1', Arial, sans-serif").arg(family);
+    };
+    auto stroke = [](bool enabled, int width, const QColor &color) {
+        return enabled
+            ? QString("%1px rgba(%2,%3,%4,1)").arg(width).arg(color.red()).arg(color.green()).arg(color.blue())
+            : QString("0 transparent");
+    };
+    auto background = [](bool enabled, const QColor &color) {
+        return enabled
+            ? QString("rgba(%1,%2,%3,%4)")
+                .arg(color.red())
+                .arg(color.green())
+                .arg(color.blue())
+                .arg(color.alpha() / 255.0, 0, 'f', 2)
+            : QString("transparent");
+    };
 
-void OverlayServer::onWsDisconnected()
-{
-    QWebSocket *wsClient = qobject_cast<QWebSocket*>(sender());
-    if (wsClient) {
-        wsClients.removeAll(wsClient);
-        wsClient->deleteLater();
-        qDebug() << "WebSocket client disconnected";
-    }
+    // CSS custom properties used by the overlay page's stylesheet
+    QJsonObject style;
+    style["--canvas-width"] = QString("%1px").arg(canvasWidth);
+    style["--canvas-height"] = QString("%1px").arg(canvasHeight);
+
+    style["--text-font"] = fontStack(textFont.family());
+    style["--text-size"] = QString("%1pt").arg(textFont.pointSize());
+    style["--text-weight"] = textBold ? "bold" : "normal";
+    style["--text-style"] = textItalic ? "italic" : "normal";
+    style["--text-color"] = textColor.name();
+    style["--text-shadow"] = textShadow ? "2px 2px 6px rgba(0,0,0,0.9)" : "none";
+    style["--text-stroke"] = stroke(textOutline, textOutlineWidth, textOutlineColor);
+    style["--text-decoration"] = textUnderline ? "underline" : "none";
+    style["--text-transform"] = textUppercase ? "uppercase" : "none";
+    style["--text-background"] = background(textHighlight, textHighlightColor);
+
+    style["--ref-font"] = fontStack(referenceFont.family());
+    style["--ref-size"] = QString("%1pt").arg(referenceFont.pointSize());
+    style["--ref-weight"] = refBold ? "bold" : "normal";
+    style["--ref-style"] = refItalic ? "italic" : "normal";
+    style["--ref-color"] = referenceColor.name();
+    style["--ref-shadow"] = refShadow ? "2px 2px 4px rgba(0,0,0,0.8)" : "none";
+    style["--ref-stroke"] = stroke(refOutline, refOutlineWidth, refOutlineColor);
+    style["--ref-decoration"] = refUnderline ? "underline" : "none";
+    style["--ref-transform"] = refUppercase ? "uppercase" : "none";
+    style["--ref-background"] = background(refHighlight, refHighlightColor);
+    return style;
 }
 
-void OverlayServer::onReadyRead()
+QString OverlayServer::generateHTML() const
 {
-    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
-    if (!client) {
-        return;
-    }
-    
-    QString request = QString::fromUtf8(client->readAll());
-    QStringList lines = request.split("\r\n");
-    
-    if (lines.isEmpty()) {
-        sendNotFound(client);
-        return;
-    }
-    
-    QStringList requestLine = lines[0].split(" ");
-    if (requestLine.size() < 2) {
-        sendNotFound(client);
-        return;
+    QString rootStyle;
+    for (auto it = current.style.constBegin(); it != current.style.constEnd(); ++it) {
+        rootStyle += QString("            %1: %2;\n").arg(it.key(), it.value().toString());
     }
-    
-    QString method = requestLine[0];
-    QString path = requestLine[1];
-    
-    if (method == "GET") {
-        if (path == "/" || path == "/overlay") {
-            sendResponse(client, generateHTML(), "text/html; charset=utf-8");
-        } else if (path.startsWith("/media")) {
-            // Serve the current media file
-            if (currentMediaPath.isEmpty()) {
-                // No media to serve - return empty response instead of 404
-                QString response = 
-                    "HTTP/1.1 204 No Content\r\n"
-                    "Access-Control-Allow-Origin: *\r\n"
-                    "Connection: close\r\n"
-                    "\r\n";
-                client->write(response.toUtf8());
-                client->flush();
-                client->disconnectFromHost();
-                return;
-            }
-            
-            if (!QFile::exists(currentMediaPath)) {
-                qWarning() << "Media file does not exist:" << currentMediaPath;
-                sendNotFound(client);
-                return;
-            }
-            
-            QFile file(currentMediaPath);
-            if (!file.open(QIODevice::ReadOnly)) {
-                qWarning() << "Failed to open media file:" << currentMediaPath;
-                sendNotFound(client);
-                return;
-            }
-            
-            QByteArray data = file.readAll();
-            file.close();
-            
-            QString contentType;
-            if (currentMediaIsVideo) {
-                QString ext = QFileInfo(currentMediaPath).suffix().toLower();
-                if (ext == "mp4") contentType = "video/mp4";
-                else if (ext == "webm") contentType = "video/webm";
-                else if (ext == "avi") contentType = "video/x-msvideo";
-                else if (ext == "mov") contentType = "video/quicktime";
-                else contentType = "video/mp4";
-            } else {
-                QString ext = QFileInfo(currentMediaPath).suffix().toLower();
-                if (ext == "jpg" || ext == "jpeg") contentType = "image/jpeg";
-                else if (ext == "png") contentType = "image/png";
-                else if (ext == "gif") contentType = "image/gif";
-                else if (ext == "bmp") contentType = "image/bmp";
-                else if (ext == "webp") contentType = "image/webp";
-                else contentType = "image/jpeg";
-            }
-            
-            QString response = QString(
-                "HTTP/1.1 200 OK\r\n"
-                "Content-Type: %1\r\n"
-                "Content-Length: %2\r\n"
-                "Access-Control-Allow-Origin: *\r\n"
-                "Cache-Control: no-cache\r\n"
-                "Accept-Ranges: bytes\r\n"
-                "Connection: close\r\n"
-                "\r\n"
-            ).arg(contentType).arg(data.size());
-            
-            client->write(response.toUtf8());
-            client->write(data);
-            client->flush();
-            client->disconnectFromHost();
-        } else if (path.startsWith("/notes")) {
-            // Serve the current notes PNG (transparent text overlay)
-            if (currentNotesPng.isEmpty() || !notesVisible || notesImageTimestamp == 0) {
-                QString response =
-                    "HTTP/1.1 204 No Content\r\n"
-                    "Access-Control-Allow-Origin: *\r\n"
-                    "Connection: close\r\n"
-                    "\r\n";
-                client->write(response.toUtf8());
-                client->flush();
-                client->disconnectFromHost();
-            } else {
-                QString response = QString(
-                    "HTTP/1.1 200 OK\r\n"
-                    "Content-Type: image/png\r\n"
-                    "Content-Length: %1\r\n"
-                    "Access-Control-Allow-Origin: *\r\n"
-                    "Cache-Control: no-cache\r\n"
-                    "Connection: close\r\n"
-                    "\r\n"
-                ).arg(currentNotesPng.size());
-
-                client->write(response.toUtf8());
-                client->write(currentNotesPng);
-                client->flush();
-                client->disconnectFromHost();
-            }
-        } else if (path == "/data") {
-            // JSON endpoint for polling
-            QString escapedRef = currentReference;
-            escapedRef.replace("\\", "\\\\");
-            escapedRef.replace("\"", "\\\"");
-            
-            QString plainText = formatBracketTextPlain(currentText);
-            QString htmlText = formatBracketTextHtml(currentText);
-
-            QString escapedText = escapeJsonString(plainText);
-            QString escapedTextHtml = escapeJsonString(htmlText);
-
-            // Notes HTML is still sent for compatibility, but OBS now
-            // primarily uses the notes PNG image and timestamp.
-            QString escapedNotesHtml = escapeJsonString(currentNotesHtml);
-
-            // Only send a flag indicating media presence, not the full path
-            bool hasMedia = !currentMediaPath.isEmpty();
-            bool hasYouTube = !currentYouTubeUrl.isEmpty();
-            QString escapedYouTube = escapeJsonString(currentYouTubeUrl);
-            
-            QString json = QString(
-                "{\"reference\":\"%1\",\"text\":\"%2\",\"textHtml\":\"%3\"," 
-                "\"hasMedia\":%4,\"mediaIsVideo\":%5,\"mediaTimestamp\":%6,\"refreshTimestamp\":%7," 
-                "\"hasYouTube\":%8,\"youTubeUrl\":\"%9\",\"notesVisible\":%10,\"notesHtml\":\"%11\",\"notesImageTimestamp\":%12}")
-                .arg(escapedRef)
-                .arg(escapedText)
-                .arg(escapedTextHtml)
-                .arg(hasMedia ? "true" : "false")
-                .arg(currentMediaIsVideo ? "true" : "false")
-                .arg(currentMediaTimestamp)
-                .arg(refreshTimestamp)
-                .arg(hasYouTube ? "true" : "false")
-                .arg(escapedYouTube)
-                .arg(notesVisible ? "true" : "false")
-                .arg(escapedNotesHtml)
-                .arg(notesImageTimestamp);
-            sendResponse(client, json, "application/json");
-        } else {
-            sendNotFound(client);
-        }
-    } else {
-        sendNotFound(client);
-    }
-    
-    client->disconnectFromHost();
-}
-
-void OverlayServer::sendResponse(QTcpSocket *socket, const QString &content, const QString &contentType)
-{
-    QByteArray data = content.toUtf8();
-    QString response = QString(
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: %1\r\n"
-        "Content-Length: %2\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Cache-Control: no-cache\r\n"
-        "Connection: close\r\n"
-        "\r\n"
-    ).arg(contentType).arg(data.size());
-    
-    socket->write(response.toUtf8());
-    socket->write(data);
-    socket->flush();
-}
 
-void OverlayServer::sendNotFound(QTcpSocket *socket)
-{
-    QString response = 
-        "HTTP/1.1 404 Not Found\r\n"
-        "Content-Type: text/plain\r\n"
-        "Content-Length: 9\r\n"
-        "Connection: close\r\n"
-        "\r\n"
-        "Not Found";
-    
-    socket->write(response.toUtf8());
-    socket->flush();
-}
-
-QString OverlayServer::generateHTML() const
-{
-    QString fontFamily = textFont.family();
-    int fontSize = textFont.pointSize();
-    QString fontWeight = textBold ? "bold" : "normal";
-    QString fontStyle = textItalic ? "italic" : "normal";
-    QString textShadowStr = textShadow ? "2px 2px 6px rgba(0,0,0,0.9)" : "none";
-    
-    QString textStrokeStr = textOutline 
-        ? QString("-webkit-text-stroke: %1px rgba(%2,%3,%4,1);")
-            .arg(textOutlineWidth)
-            .arg(textOutlineColor.red())
-            .arg(textOutlineColor.green())
-            .arg(textOutlineColor.blue())
-        : "";
-    
-    QString textBgColor = textHighlight 
-        ? QString("rgba(%1,%2,%3,%4)")
-            .arg(textHighlightColor.red())
-            .arg(textHighlightColor.green())
-            .arg(textHighlightColor.blue())
-            .arg(textHighlightColor.alpha() / 255.0, 0, 'f', 2)
-        : "transparent";
-    
-    QString refFontFamily = referenceFont.family();
-    int refFontSize = referenceFont.pointSize();
-    QString refFontWeight = refBold ? "bold" : "normal";
-    QString refFontStyle = refItalic ? "italic" : "normal";
-    QString textDecoration = textUnderline ? "underline" : "none";
-    QString refDecoration = refUnderline ? "underline" : "none";
-    QString refShadowStr = refShadow ? "2px 2px 4px rgba(0,0,0,0.8)" : "none";
-    
-    QString refStrokeStr = refOutline 
-        ? QString("-webkit-text-stroke: %1px rgba(%2,%3,%4,1);")
-            .arg(refOutlineWidth)
-            .arg(refOutlineColor.red())
-            .arg(refOutlineColor.green())
-            .arg(refOutlineColor.blue())
-        : "";
-    
-    QString refBgColor = refHighlight
-        ? QString("rgba(%1,%2,%3,%4)")
-            .arg(refHighlightColor.red())
-            .arg(refHighlightColor.green())
-            .arg(refHighlightColor.blue())
-            .arg(refHighlightColor.alpha() / 255.0, 0, 'f', 2)
-        : "transparent";
-    QString textTransform = textUppercase ? "uppercase" : "none";
-    QString refTransform = refUppercase ? "uppercase" : "none";
-
-    QString textColorStr = textColor.name();
-    QString refColorStr = referenceColor.name();
-    
     QString html = QString(R"(<!DOCTYPE html>
 <html>
 <head>
@@ -693,20 +546,24 @@ QString OverlayServer::generateHTML() const
     <meta name="referrer" content="no-referrer-when-downgrade">
     <title>Overlay</title>
     <style>
+        /* Style settings; later changes are applied over these by the
+           "style" state field without reloading */
+        :root {
+%1        }
         * {
             margin: 0;
             padding: 0;
             box-sizing: border-box;
         }
         body {
-            width: %15px;
-            height: %16px;
+            width: var(--canvas-width);
+            height: var(--canvas-height);
             background: transparent;
             overflow: hidden;
             display: flex;
             align-items: flex-end;
             justify-content: center;
-            font-family: '%1', Arial, sans-serif;
+            font-family: var(--text-font);
             padding-bottom: 50px;
             position: relative;
         }
@@ -757,7 +614,7 @@ QString OverlayServer::generateHTML() const
             align-items: flex-start;
             justify-content: center;
             gap: 12px;
-            background-color: %13;
+            background-color: var(--text-background);
             padding: 16px 60px;
             border-radius: 4px;
             margin-bottom: 12px;
@@ -766,26 +623,26 @@ QString OverlayServer::generateHTML() const
             margin-right: 40px;
         }
         #verse-number {
-            font-family: '%1', Arial, sans-serif;
-            font-size: %2pt;
-            font-weight: %3;
+            font-family: var(--text-font);
+            font-size: var(--text-size);
+            font-weight: var(--text-weight);
             color: #4A9EFF;
-            text-shadow: %4;
-            %17
+            text-shadow: var(--text-shadow);
+            -webkit-text-stroke: var(--text-stroke);
             flex-shrink: 0;
             padding-top: 2px;
         }
         #text {
-            font-family: '%1', Arial, sans-serif;
-            font-size: %2pt;
-            font-weight: %3;
-            font-style: %5;
-            color: %6;
+            font-family: var(--text-font);
+            font-size: var(--text-size);
+            font-weight: var(--text-weight);
+            font-style: var(--text-style);
+            color: var(--text-color);
             line-height: 1.5;
-            text-shadow: %4;
-            %17
-            text-decoration: %19;
-            text-transform: %21;
+            text-shadow: var(--text-shadow);
+            -webkit-text-stroke: var(--text-stroke);
+            text-decoration: var(--text-decoration);
+            text-transform: var(--text-transform);
             white-space: pre-wrap;
             flex: 1;
             text-align: center;
@@ -794,18 +651,18 @@ QString OverlayServer::generateHTML() const
             font-style: italic;
         }
         #reference {
-            font-family: '%7', Arial, sans-serif;
-            font-size: %8pt;
-            font-weight: %9;
-            font-style: %10;
-            color: %11;
-            text-shadow: %12;
-            %18
-            text-decoration: %20;
-            text-transform: %22;
+            font-family: var(--ref-font);
+            font-size: var(--ref-size);
+            font-weight: var(--ref-weight);
+            font-style: var(--ref-style);
+            color: var(--ref-color);
+            text-shadow: var(--ref-shadow);
+            -webkit-text-stroke: var(--ref-stroke);
+            text-decoration: var(--ref-decoration);
+            text-transform: var(--ref-transform);
             letter-spacing: 1px;
             opacity: 0.95;
-            background-color: %14;
+            background-color: var(--ref-background);
             padding: 8px 20px;
             border-radius: 4px;
             display: block;
@@ -855,6 +712,7 @@ QString OverlayServer::generateHTML() const
             <div id="reference"></div>
         </div>
     </div>
+)" R"(
     <script src="https://www.youtube.com/iframe_api"></script>
     <script>
         let lastReference = '';
@@ -867,6 +725,7 @@ QString OverlayServer::generateHTML() const
         let isVisible = false;
         let ytPlayer = null;
         let pendingYouTubeUrl = null;
+        let ytReadyReported = false;
         let ytErrorActive = false;
         
         // WebSocket for video sync
@@ -875,7 +734,9 @@ QString OverlayServer::generateHTML() const
         
         function connectWebSocket() {
             try {
-                ws = new WebSocket('ws://localhost:8081');
+                // The host that served the page: OBS and stage displays
+                // are often on another machine
+                ws = new WebSocket('ws://' + (location.hostname || 'localhost') + ':8081');
                 
                 ws.onopen = () => {
                     console.log('WebSocket connected');
@@ -883,6 +744,9 @@ QString OverlayServer::generateHTML() const
                         clearTimeout(wsReconnectTimer);
                         wsReconnectTimer = null;
                     }
+                    startClockSync();
+                    ytReadyReported = false;
+                    reportYouTubeReady();
                 };
                 
                 ws.onmessage = (event) => {
@@ -913,21 +777,8 @@ QString OverlayServer::generateHTML() const
             const vidBg = document.getElementById('media-background-video');
             const ytFrame = document.getElementById('media-youtube');
             
-            if (msg.type === 'media_seek' && msg.timestamp === lastMediaTimestamp) {
-                // Only seek if this is the current media
-                if (vidBg && vidBg.style.display === 'block') {
-                    vidBg.currentTime = msg.positionMs / 1000;
-                    console.log('Synced video to:', msg.positionMs, 'ms');
-                }
-            } else if (msg.type === 'media_playpause' && msg.timestamp === lastMediaTimestamp) {
-                if (vidBg && vidBg.style.display === 'block') {
-                    if (msg.playing) {
-                        vidBg.play().catch(e => console.log('Play failed:', e));
-                    } else {
-                        vidBg.pause();
-                    }
-                    console.log('Video', msg.playing ? 'playing' : 'paused');
-                }
+            if (msg.type === 'time_sync') {
+                addClockSample(msg);
             } else if (msg.type === 'youtube_seek') {
                 try {
                     if (ytPlayer && ytFrame && ytFrame.style.display === 'block' &&
@@ -966,9 +817,11 @@ QString OverlayServer::generateHTML() const
                 } catch (e) {
                     console.error('YouTube play/pause via WebSocket failed:', e);
                 }
+            } else if (msg.type === 'state') {
+                applyState(msg);
             } else if (msg.type === 'media_load') {
                 console.log('Media load event, timestamp:', msg.timestamp);
-                // Media will be loaded via HTTP polling
+                // Media itself is loaded from the state delta
             }
         }
 
@@ -997,6 +850,7 @@ QString OverlayServer::generateHTML() const
                                 loadYouTubeVideo(url);
                             }
                         },
+                        'onStateChange': onYouTubeStateChange,
                         'onError': onYouTubeError
                     }
                 });
@@ -1005,6 +859,23 @@ QString OverlayServer::generateHTML() const
             }
         }
 
+        // The app brings a video in sync once it is actually playing here,
+        // rather than guessing how long loading takes
+        function reportYouTubeReady() {
+            if (ytReadyReported || !ws || ws.readyState !== WebSocket.OPEN || !ytPlayer ||
+                typeof ytPlayer.getPlayerState !== 'function' || ytPlayer.getPlayerState() !== 1) {
+                return;
+            }
+            ytReadyReported = true;
+            ws.send(JSON.stringify({ type: 'youtube_ready' }));
+        }
+
+        function onYouTubeStateChange(event) {
+            if (event && event.data === 1) {
+                reportYouTubeReady();
+            }
+        }
+
         function onYouTubeError(event) {
             ytErrorActive = true;
             console.error('YouTube player error:', event && event.data);
@@ -1016,6 +887,8 @@ QString OverlayServer::generateHTML() const
                 return;
             }
 
+            ytReadyReported = false;
+
             // Prefer the IFrame API when available
             if (typeof YT !== 'undefined' && YT.Player && ytPlayer && typeof ytPlayer.loadVideoById === 'function') {
                 try {
@@ -1130,198 +1003,336 @@ QString OverlayServer::generateHTML() const
             }
         }
         
-        function updateOverlay() {
-            fetch('/data')
-                .then(response => response.json())
-                .then(data => {
-                    // Check if settings changed and need to refresh
-                    if (data.refreshTimestamp !== lastRefreshTimestamp && lastRefreshTimestamp !== 0) {
-                        console.log('Settings changed, refreshing page...');
-                        location.reload();
-                        return;
-                    }
-                    lastRefreshTimestamp = data.refreshTimestamp;
-
-                    const hasContent = (!data.notesVisible) && (data.reference || data.text);
-
-                    // Update media / YouTube background
-                    const mediaContainer = document.getElementById('media-container');
-                    const imgBg = document.getElementById('media-background');
-                    const vidBg = document.getElementById('media-background-video');
-                    const ytFrame = document.getElementById('media-youtube');
-
-                    const hasYouTube = data.hasYouTube && data.youTubeUrl;
-
-                    if (hasYouTube && data.youTubeUrl !== lastYouTubeUrl) {
-                        // New YouTube video requested: clear any previous error
-                        // state and try to load this video.
-                        lastYouTubeUrl = data.youTubeUrl;
-                        ytErrorActive = false;
-                        const overlayContainer = document.getElementById('container');
-                        if (overlayContainer) {
-                            overlayContainer.style.display = '';
-                        }
-                        // Use the IFrame API-driven loader when available, with
-                        // an internal fallback to setting iframe src directly.
-                        loadYouTubeVideo(lastYouTubeUrl);
-                    }
+        // Overlay state as last pushed over the WebSocket or fetched from /data
+        let state = null;
+        let stateVersion = 0;
+
+        function applyState(msg) {
+            // Deltas arrive in order on one socket; a full snapshot (on
+            // connect, or from /data) replaces whatever we had
+            if (msg.full) {
+                state = Object.assign({}, msg);
+            } else {
+                if (!state || msg.version <= stateVersion) {
+                    return;
+                }
+                Object.assign(state, msg);
+            }
+            stateVersion = msg.version;
+            if (msg.style) {
+                // Only the properties that changed, or all of them in a
+                // full snapshot; restyles in place, no reload
+                const root = document.documentElement.style;
+                for (const name of Object.keys(msg.style)) {
+                    root.setProperty(name, msg.style[name]);
+                }
+            }
+            renderOverlay(state);
+            if (msg.mediaClock) {
+                mediaClock = msg.mediaClock;
+                followMediaClock();
+            }
+        }
 
-                    if (hasYouTube && ytErrorActive) {
-                        mediaContainer.style.display = 'none';
-                        ytFrame.style.display = 'none';
-                        imgBg.style.display = 'none';
-                        vidBg.style.display = 'none';
-                        const overlayContainer = document.getElementById('container');
-                        if (overlayContainer) {
-                            overlayContainer.style.display = 'none';
-                        }
-                        return;
-                    }
+)" R"(
+        // Clock sync: serverNow() estimates the server's clock from ours.
+        // Each sample assumes the request and reply took equally long, so
+        // the sample with the shortest round trip is the most accurate.
+        let clockSamples = [];
+        let clockOffset = null;
+        let clockSyncTimer = null;
+
+        function sendClockSample() {
+            if (ws && ws.readyState === WebSocket.OPEN) {
+                ws.send(JSON.stringify({ type: 'time_sync', t0: performance.now() }));
+            }
+        }
 
-                    if (hasYouTube) {
+        function startClockSync() {
+            clockSamples = [];
+            for (let i = 0; i < 5; i++) {
+                setTimeout(sendClockSample, i * 150);
+            }
+            if (!clockSyncTimer) {
+                clockSyncTimer = setInterval(sendClockSample, 10000);
+            }
+        }
+
+        function addClockSample(msg) {
+            const t1 = performance.now();
+            const rtt = t1 - msg.t0;
+            if (typeof msg.serverTime !== 'number' || rtt < 0) {
+                return;
+            }
+            clockSamples.push({ rtt: rtt, offset: msg.serverTime + rtt / 2 - t1 });
+            if (clockSamples.length > 8) {
+                clockSamples.shift();
+            }
+            let best = clockSamples[0];
+            for (const sample of clockSamples) {
+                if (sample.rtt < best.rtt) {
+                    best = sample;
+                }
+            }
+            clockOffset = best.offset;
+            followMediaClock();
+        }
+
+        function serverNow() {
+            return performance.now() + clockOffset;
+        }
+
+        // Media clock: keep the video where the projector's is. Small
+        // drift is trimmed by nudging the playback rate, which is
+        // invisible; only large jumps (seeks, stalls) seek the video.
+        let mediaClock = null;
+        let mediaStartTimer = null;
+        const driftToleranceMs = 10;
+        const driftSeekMs = 400;
+
+        function followMediaClock() {
+            const vidBg = document.getElementById('media-background-video');
+            if (!mediaClock || !mediaClock.serverTime || clockOffset === null || !vidBg ||
+                vidBg.style.display !== 'block' || mediaClock.timestamp !== lastMediaTimestamp ||
+                vidBg.readyState < 1) {
+                return;
+            }
+            const rate = mediaClock.rate || 1;
+            const durationMs = isFinite(vidBg.duration) ? vidBg.duration * 1000 : 0;
+
+            if (!mediaClock.playing) {
+                clearTimeout(mediaStartTimer);
+                if (!vidBg.paused) {
+                    vidBg.pause();
+                }
+                vidBg.playbackRate = rate;
+                if (Math.abs(vidBg.currentTime * 1000 - mediaClock.positionMs) > driftToleranceMs) {
+                    vidBg.currentTime = mediaClock.positionMs / 1000;
+                }
+                return;
+            }
+
+            const startIn = mediaClock.serverTime - serverNow();
+            if (startIn > 0) {
+                // Play-at: be ready on the first frame and start on time
+                clearTimeout(mediaStartTimer);
+                vidBg.pause();
+                vidBg.playbackRate = rate;
+                vidBg.currentTime = mediaClock.positionMs / 1000;
+                mediaStartTimer = setTimeout(() => {
+                    vidBg.play().catch(e => console.log('Video play failed:', e));
+                }, startIn);
+                return;
+            }
+
+            let expected = mediaClock.positionMs - startIn * rate;
+            if (durationMs > 0 && vidBg.loop) {
+                expected -= Math.floor(expected / durationMs) * durationMs;
+            }
+            const drift = vidBg.currentTime * 1000 - expected;
+            if (Math.abs(drift) > driftSeekMs) {
+                vidBg.currentTime = expected / 1000;
+                vidBg.playbackRate = rate;
+            } else if (Math.abs(drift) > driftToleranceMs) {
+                // Catch up over about a second, never more than a tenth off
+                const trim = Math.max(-0.1, Math.min(0.1, drift / 1000));
+                vidBg.playbackRate = rate * (1 - trim);
+            } else {
+                vidBg.playbackRate = rate;
+            }
+            if (vidBg.paused) {
+                vidBg.play().catch(e => console.log('Video play failed:', e));
+            }
+        }
+
+        setInterval(followMediaClock, 250);
+
+        function renderOverlay(data) {
+            // Check if settings changed and need to refresh
+            if (data.refreshTimestamp !== lastRefreshTimestamp && lastRefreshTimestamp !== 0) {
+                console.log('Settings changed, refreshing page...');
+                location.reload();
+                return;
+            }
+            lastRefreshTimestamp = data.refreshTimestamp;
+
+            const hasContent = (!data.notesVisible) && (data.reference || data.text);
+
+            // Update media / YouTube background
+            const mediaContainer = document.getElementById('media-container');
+            const imgBg = document.getElementById('media-background');
+            const vidBg = document.getElementById('media-background-video');
+            const ytFrame = document.getElementById('media-youtube');
+
+            const hasYouTube = data.hasYouTube && data.youTubeUrl;
+
+            if (hasYouTube && data.youTubeUrl !== lastYouTubeUrl) {
+                // New YouTube video requested: clear any previous error
+                // state and try to load this video.
+                lastYouTubeUrl = data.youTubeUrl;
+                ytErrorActive = false;
+                const overlayContainer = document.getElementById('container');
+                if (overlayContainer) {
+                    overlayContainer.style.display = '';
+                }
+                // Use the IFrame API-driven loader when available, with
+                // an internal fallback to setting iframe src directly.
+                loadYouTubeVideo(lastYouTubeUrl);
+            }
+
+            if (hasYouTube && ytErrorActive) {
+                mediaContainer.style.display = 'none';
+                ytFrame.style.display = 'none';
+                imgBg.style.display = 'none';
+                vidBg.style.display = 'none';
+                const overlayContainer = document.getElementById('container');
+                if (overlayContainer) {
+                    overlayContainer.style.display = 'none';
+                }
+                return;
+            }
+
+            if (hasYouTube) {
+                mediaContainer.style.display = 'block';
+                ytFrame.style.display = 'block';
+                imgBg.style.display = 'none';
+                vidBg.style.display = 'none';
+                vidBg.pause();
+            } else {
+                ytFrame.style.display = 'none';
+                ytFrame.src = '';
+                ytErrorActive = false;
+                // Clear lastYouTubeUrl so that if the same YouTube URL
+                // is projected again later (after showing local media
+                // or plain text), the overlay will treat it as a new
+                // video and reload it.
+                lastYouTubeUrl = '';
+                const overlayContainer = document.getElementById('container');
+                if (overlayContainer) {
+                    overlayContainer.style.display = '';
+                }
+
+                if (data.hasMedia !== lastHasMedia || data.mediaTimestamp !== lastMediaTimestamp) {
+                    console.log('Media update - hasMedia:', data.hasMedia, 'isVideo:', data.mediaIsVideo, 'timestamp:', data.mediaTimestamp);
+                    lastHasMedia = data.hasMedia;
+                    lastMediaTimestamp = data.mediaTimestamp;
+
+                    if (data.hasMedia) {
+                        const mediaUrl = '/media?t=' + data.mediaTimestamp;
+                        console.log('Loading media from:', mediaUrl);
+
+                        // Clear all error handlers first
+                        imgBg.onerror = null;
+                        imgBg.onload = null;
+                        vidBg.onerror = null;
+
+                        if (data.mediaIsVideo) {
+                            imgBg.style.display = 'none';
+                            imgBg.src = '';
+                            vidBg.onerror = (e) => console.error('Video load error:', e);
+                            vidBg.onloadeddata = () => console.log('Video loaded successfully');
+                            vidBg.src = mediaUrl;
+                            vidBg.style.display = 'block';
+                            vidBg.load();
+                            vidBg.play().catch(e => console.log('Video play failed:', e));
+                        } else {
+                            vidBg.style.display = 'none';
+                            vidBg.pause();
+                            vidBg.src = '';
+                            imgBg.onerror = (e) => console.error('Image load error:', e);
+                            imgBg.onload = () => console.log('Image loaded successfully');
+                            imgBg.src = mediaUrl;
+                            imgBg.style.display = 'block';
+                        }
                         mediaContainer.style.display = 'block';
-                        ytFrame.style.display = 'block';
+                    } else {
+                        mediaContainer.style.display = 'none';
                         imgBg.style.display = 'none';
                         vidBg.style.display = 'none';
                         vidBg.pause();
-                    } else {
-                        ytFrame.style.display = 'none';
-                        ytFrame.src = '';
-                        ytErrorActive = false;
-                        // Clear lastYouTubeUrl so that if the same YouTube URL
-                        // is projected again later (after showing local media
-                        // or plain text), the overlay will treat it as a new
-                        // video and reload it.
-                        lastYouTubeUrl = '';
-                        const overlayContainer = document.getElementById('container');
-                        if (overlayContainer) {
-                            overlayContainer.style.display = '';
-                        }
-
-                        if (data.hasMedia !== lastHasMedia || data.mediaTimestamp !== lastMediaTimestamp) {
-                            console.log('Media update - hasMedia:', data.hasMedia, 'isVideo:', data.mediaIsVideo, 'timestamp:', data.mediaTimestamp);
-                            lastHasMedia = data.hasMedia;
-                            lastMediaTimestamp = data.mediaTimestamp;
-
-                            if (data.hasMedia) {
-                                const mediaUrl = '/media?t=' + data.mediaTimestamp;
-                                console.log('Loading media from:', mediaUrl);
-
-                                // Clear all error handlers first
-                                imgBg.onerror = null;
-                                imgBg.onload = null;
-                                vidBg.onerror = null;
-
-                                if (data.mediaIsVideo) {
-                                    imgBg.style.display = 'none';
-                                    imgBg.src = '';
-                                    vidBg.onerror = (e) => console.error('Video load error:', e);
-                                    vidBg.onloadeddata = () => console.log('Video loaded successfully');
-                                    vidBg.src = mediaUrl;
-                                    vidBg.style.display = 'block';
-                                    vidBg.load();
-                                    vidBg.play().catch(e => console.log('Video play failed:', e));
-                                } else {
-                                    vidBg.style.display = 'none';
-                                    vidBg.pause();
-                                    vidBg.src = '';
-                                    imgBg.onerror = (e) => console.error('Image load error:', e);
-                                    imgBg.onload = () => console.log('Image loaded successfully');
-                                    imgBg.src = mediaUrl;
-                                    imgBg.style.display = 'block';
-                                }
-                                mediaContainer.style.display = 'block';
-                            } else {
-                                mediaContainer.style.display = 'none';
-                                imgBg.style.display = 'none';
-                                vidBg.style.display = 'none';
-                                vidBg.pause();
-                                imgBg.src = '';
-                                vidBg.src = '';
-                            }
-                        }
+                        imgBg.src = '';
+                        vidBg.src = '';
                     }
+                }
+            }
 
-                    const container = document.getElementById('container');
-                    const textRow = document.getElementById('text-row');
-                    const refDiv = document.getElementById('reference');
-                    const notesOverlay = document.getElementById('notes-overlay');
-                    const notesImage = document.getElementById('notes-image');
-
-                    const notesVisible = !!data.notesVisible;
-                    const notesImageTimestamp = data.notesImageTimestamp || 0;
-
-                    if (notesOverlay && notesImage) {
-                        if (notesVisible && notesImageTimestamp) {
-                            notesOverlay.style.display = 'block';
-                            if (lastNotesImageTimestamp !== notesImageTimestamp) {
-                                notesImage.src = '/notes?t=' + notesImageTimestamp;
-                                lastNotesImageTimestamp = notesImageTimestamp;
-                            }
-                        } else {
-                            notesOverlay.style.display = 'none';
-                            notesImage.src = '';
-                            lastNotesImageTimestamp = 0;
-                        }
+            const container = document.getElementById('container');
+            const textRow = document.getElementById('text-row');
+            const refDiv = document.getElementById('reference');
+            const notesOverlay = document.getElementById('notes-overlay');
+            const notesImage = document.getElementById('notes-image');
+
+            const notesVisible = !!data.notesVisible;
+            const notesImageTimestamp = data.notesImageTimestamp || 0;
+
+            if (notesOverlay && notesImage) {
+                if (notesVisible && notesImageTimestamp) {
+                    notesOverlay.style.display = 'block';
+                    if (lastNotesImageTimestamp !== notesImageTimestamp) {
+                        notesImage.src = '/notes?t=' + notesImageTimestamp;
+                        lastNotesImageTimestamp = notesImageTimestamp;
                     }
+                } else {
+                    notesOverlay.style.display = 'none';
+                    notesImage.src = '';
+                    lastNotesImageTimestamp = 0;
+                }
+            }
 
-                    if (!notesVisible && hasContent) {
-                        const verseNum = extractVerseNumber(data.reference || '');
-                        document.getElementById('verse-number').textContent = verseNum;
-                        const textDiv = document.getElementById('text');
-                        textDiv.innerHTML = data.textHtml || '';
-                        refDiv.textContent = data.reference || '';
+            if (!notesVisible && hasContent) {
+                const verseNum = extractVerseNumber(data.reference || '');
+                document.getElementById('verse-number').textContent = verseNum;
+                const textDiv = document.getElementById('text');
+                textDiv.innerHTML = data.textHtml || '';
+                refDiv.textContent = data.reference || '';
 
-                        textRow.style.display = data.text ? 'flex' : 'none';
-                        refDiv.style.display = data.reference ? 'inline-block' : 'none';
+                textRow.style.display = data.text ? 'flex' : 'none';
+                refDiv.style.display = data.reference ? 'inline-block' : 'none';
 
-                        if (!isVisible) {
-                            container.classList.add('visible');
-                            isVisible = true;
-                        }
-                    } else {
-                        if (isVisible) {
-                            container.classList.remove('visible');
-                            isVisible = false;
-                        }
+                if (!isVisible) {
+                    container.classList.add('visible');
+                    isVisible = true;
+                }
+            } else {
+                if (isVisible) {
+                    container.classList.remove('visible');
+                    isVisible = false;
+                }
 
-                        textRow.style.display = 'none';
-                        refDiv.style.display = 'none';
-                    }
+                textRow.style.display = 'none';
+                refDiv.style.display = 'none';
+            }
+
+            lastReference = data.reference || '';
+            lastText = data.text || '';
+        }
 
-                    lastReference = data.reference || '';
-                    lastText = data.text || '';
+        function pollOverlay() {
+            fetch('/data')
+                .then(response => response.json())
+                .then(data => {
+                    // May cross a newer delta on the socket; a restarted
+                    // server resends a full snapshot when it reconnects
+                    if (data.version > stateVersion) {
+                        data.full = true;
+                        applyState(data);
+                    }
                 })
                 .catch(err => console.error('Error fetching data:', err));
         }
 
-// Poll every 100ms for updates
-setInterval(updateOverlay, 100);
+// Poll every 100ms only while the WebSocket is down; otherwise just check
+// now and then in case a push was lost
+setInterval(() => {
+    if (!ws || ws.readyState !== WebSocket.OPEN) {
+        pollOverlay();
+    }
+}, 100);
+setInterval(pollOverlay, 5000);
 </script>
 </body>
 </html>
-)"    ).arg(fontFamily)
-     .arg(fontSize)
-     .arg(fontWeight)
-     .arg(textShadowStr)
-     .arg(fontStyle)
-     .arg(textColorStr)
-     .arg(refFontFamily)
-     .arg(refFontSize)
-     .arg(refFontWeight)
-     .arg(refFontStyle)
-     .arg(refColorStr)
-     .arg(refShadowStr)
-     .arg(textBgColor)
-     .arg(refBgColor)
-     .arg(canvasWidth)
-     .arg(canvasHeight)
-     .arg(textStrokeStr)
-     .arg(refStrokeStr)
-     .arg(textDecoration)
-     .arg(refDecoration)
-     .arg(textUppercase ? "uppercase" : "none")
-     .arg(refUppercase ? "uppercase" : "none");
+)"    ).arg(rootStyle);
     
     return html;
 }
@@ -2,15 +2,20 @@
 #define OVERLAYSERVER_H
 
 #include <QObject>
-#include <QTcpServer>
-#include <QTcpSocket>
-#include <QWebSocketServer>
-#include <QWebSocket>
-#include <QList>
 #include <QColor>
 #include <QFont>
 #include <QImage>
+#include <QJsonObject>
+#include "OverlayState.h"
 
+class QThread;
+class OverlayServerWorker;
+class MediaDerivativeCache;
+
+// Serves the OBS browser-source overlay. The public API is used from the
+// GUI thread and only edits an OverlayState; changes are published as
+// immutable snapshots to an OverlayServerWorker on a dedicated I/O thread,
+// which does all accepting, parsing, encoding and streaming.
 class OverlayServer : public QObject
 {
     Q_OBJECT
@@ -27,17 +32,26 @@ public:
     void updateOverlay(const QString &reference, const QString &text);
     void clearOverlay();
     void updateMedia(const QString &mediaPath, bool isVideo);
+    // Starts making a canvas-sized copy of newly added media in the background
+    void prepareMedia(const QString &mediaPath, bool isVideo);
     void updateYouTube(const QString &youtubeUrl);
     void updateNotes(const QString &notesHtml, bool visible);
     void updateNotesImage(const QImage &image, bool visible);
     void triggerRefresh();
     
-    // WebSocket methods for video sync
+    // WebSocket methods for video sync. Media seek and play/pause move
+    // the playback clock that pages follow; updateMediaClock() gives it
+    // the projector's actual position.
+    void updateMediaClock(bool playing, qint64 positionMs, double rate);
     void broadcastMediaSeek(qint64 positionMs);
     void broadcastMediaPlayPause(bool playing);
     void broadcastMediaLoad(const QString &mediaPath, bool isVideo, qint64 timestamp);
     void broadcastYouTubeSeek(double ratio);
     void broadcastYouTubePlayPause(bool playing);
+
+    // Hands a JPEG of the program output to /program.mjpg and
+    // ws://…:8081/program clients
+    void publishProgramFrame(const QByteArray &jpeg);
     
     void setTextColor(const QColor &color);
     void setReferenceColor(const QColor &color);
@@ -47,37 +61,32 @@ public:
 
 signals:
     void webSocketClientConnected();
-
-private slots:
-    void onNewConnection();
-    void onClientDisconnected();
-    void onReadyRead();
-    
-    // WebSocket slots
-    void onWsNewConnection();
-    void onWsDisconnected();
+    // A page's YouTube player started playing and can be brought in sync
+    void youTubeClientReady();
+    // Whether any client is watching the program stream
+    void programStreamDemandChanged(bool active);
 
 private:
-    void sendResponse(QTcpSocket *socket, const QString &content, const QString &contentType = "text/html");
-    void sendNotFound(QTcpSocket *socket);
+    void markStateChanged(int fields);
+    void flushState();
+    double expectedMediaPosition(double now) const;
+    void setMediaAnchor(bool playing, qint64 positionMs, double clockTime, double rate);
+    void postToWebSockets(const QJsonObject &msg);
+    QJsonObject styleVariables() const;
     QString generateHTML() const;
     QString generateUpdateScript() const;
 
-    QTcpServer *server;
-    QList<QTcpSocket*> clients;
-    
-    QWebSocketServer *wsServer;
-    QList<QWebSocket*> wsClients;
-    
-    QString currentReference;
-    QString currentText;
-    QString currentNotesHtml;
-    QString currentMediaPath;
-    QString currentYouTubeUrl;
-    bool notesVisible;
-    bool currentMediaIsVideo;
-    qint64 currentMediaTimestamp;
-    qint64 refreshTimestamp;
+    QThread *ioThread;
+    OverlayServerWorker *worker;
+    MediaDerivativeCache *derivatives;
+    bool running;
+    quint16 listenPort;
+
+    // The GUI thread's copy; snapshots of it go to the worker
+    OverlayState current;
+    QString currentText; // as given, with brackets
+    int pendingStateFields;
+
     int canvasWidth;
     int canvasHeight;
     QColor textColor;
@@ -104,9 +113,6 @@ private:
     QColor refOutlineColor;
     bool refHighlight;
     QColor refHighlightColor;
-
-    QByteArray currentNotesPng;
-    qint64 notesImageTimestamp;
 };
 
 #endif // OVERLAYSERVER_H
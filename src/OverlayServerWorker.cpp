@@ -0,0 +1,882 @@
+#include "OverlayServerWorker.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QFileInfo>
+#include <QTimer>
+#include <QBuffer>
+#include <QHostAddress>
+#include <QCryptographicHash>
+#include <array>
+
+namespace {
+
+// Connections kept open at once; several OBS scenes and stage displays
+// each hold one or two
+constexpr int kMaxConnections = 64;
+constexpr int kMaxRequestsPerConnection = 1000;
+constexpr int kIdleTimeoutMs = 15000;
+constexpr int kRequestTimeoutMs = 10000;
+
+// Media is written kStreamChunkBytes at a time, topped up from
+// bytesWritten while less than kStreamBufferBytes is queued on the socket
+constexpr qint64 kStreamChunkBytes = 64 * 1024;
+constexpr qint64 kStreamBufferBytes = 256 * 1024;
+
+// A program stream client with this much still queued skips frames until
+// it catches up, so a slow viewer only ever lags by about one frame
+constexpr qint64 kMaxFrameBacklogBytes = 1024 * 1024;
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 206: return "Partial Content";
+    case 304: return "Not Modified";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 416: return "Range Not Satisfiable";
+    case 431: return "Request Header Fields Too Large";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Error";
+    }
+}
+
+QByteArray responseHead(const HttpRequestParser::Request &request, int status, const QByteArray &contentType,
+                        qint64 contentLength, const QByteArray &extraHeaders)
+{
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n";
+    if (status != 204 && status != 304) {
+        if (!contentType.isEmpty()) {
+            head += "Content-Type: " + contentType + "\r\n";
+        }
+        head += "Content-Length: " + QByteArray::number(contentLength) + "\r\n";
+    }
+    head += "Access-Control-Allow-Origin: *\r\n"
+            "Cache-Control: no-cache\r\n";
+    head += extraHeaders;
+    if (request.keepAlive) {
+        head += "Connection: keep-alive\r\n"
+                "Keep-Alive: timeout=" + QByteArray::number(kIdleTimeoutMs / 1000) + "\r\n";
+    } else {
+        head += "Connection: close\r\n";
+    }
+    head += "\r\n";
+    return head;
+}
+
+// Reads a single "bytes=" range against a file of size bytes. Returns 206
+// with start and length set, 416 when the range lies past the end, or 200
+// when the header should be ignored (malformed, or several ranges).
+int parseByteRange(const QByteArray &header, qint64 size, qint64 &start, qint64 &length)
+{
+    start = 0;
+    length = size;
+    const QByteArray value = header.trimmed();
+    if (!value.startsWith("bytes=") || value.contains(',')) {
+        return 200;
+    }
+    const QByteArray spec = value.mid(6);
+    const int dash = spec.indexOf('-');
+    if (dash < 0) {
+        return 200;
+    }
+    const QByteArray first = spec.left(dash).trimmed();
+    const QByteArray last = spec.mid(dash + 1).trimmed();
+    bool ok = false;
+
+    if (first.isEmpty()) {
+        // Suffix range: the last N bytes
+        const qint64 suffix = last.toLongLong(&ok);
+        if (!ok || suffix < 0) {
+            return 200;
+        }
+        if (suffix == 0 || size == 0) {
+            return 416;
+        }
+        start = qMax<qint64>(0, size - suffix);
+        length = size - start;
+        return 206;
+    }
+
+    const qint64 from = first.toLongLong(&ok);
+    if (!ok || from < 0) {
+        return 200;
+    }
+    qint64 to = size - 1;
+    if (!last.isEmpty()) {
+        to = last.toLongLong(&ok);
+        if (!ok || to < from) {
+            return 200;
+        }
+        to = qMin(to, size - 1);
+    }
+    if (from >= size) {
+        return 416;
+    }
+    start = from;
+    length = to - from + 1;
+    return 206;
+}
+
+quint32 crc32(const QByteArray &data)
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> entries{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+        return entries;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (char ch : data) {
+        crc = table[(crc ^ static_cast<quint8>(ch)) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendLittleEndian32(QByteArray &out, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// gzip member for data. qCompress produces a 4-byte length followed by a
+// zlib stream (2-byte header, raw deflate data, 4-byte Adler-32); gzip
+// wraps the same deflate data in its own header and a CRC-32 trailer.
+QByteArray gzipCompress(const QByteArray &data)
+{
+    const QByteArray zlib = qCompress(data, 9);
+    if (zlib.size() < 4 + 2 + 4) {
+        return QByteArray();
+    }
+
+    static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 2, '\xff' };
+    QByteArray out;
+    out.reserve(zlib.size() + 8);
+    out.append(header, sizeof(header));
+    out.append(zlib.constData() + 6, zlib.size() - 10);
+    appendLittleEndian32(out, crc32(data));
+    appendLittleEndian32(out, static_cast<quint32>(data.size()));
+    return out;
+}
+
+bool acceptsGzip(const QByteArray &acceptEncoding)
+{
+    const QList<QByteArray> codings = acceptEncoding.split(',');
+    for (const QByteArray &coding : codings) {
+        const QList<QByteArray> parts = coding.split(';');
+        const QByteArray name = parts[0].trimmed().toLower();
+        if (name != "gzip" && name != "*") {
+            continue;
+        }
+        // "gzip;q=0" turns it down
+        for (int i = 1; i < parts.size(); ++i) {
+            const QByteArray parameter = parts[i].trimmed();
+            if (parameter.startsWith("q=") && parameter.mid(2).toDouble() <= 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+bool etagMatches(const QByteArray &ifNoneMatch, const QByteArray &etag)
+{
+    const QList<QByteArray> tags = ifNoneMatch.split(',');
+    for (QByteArray tag : tags) {
+        tag = tag.trimmed();
+        if (tag == "*") {
+            return true;
+        }
+        // Weak comparison, as If-None-Match asks for
+        if (tag.startsWith("W/")) {
+            tag = tag.mid(2);
+        }
+        if (tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+OverlayServerWorker::OverlayServerWorker(QObject *parent)
+    : QObject(parent)
+    , server(new QTcpServer(this))
+    , wsServer(new QWebSocketServer("OverlayWebSocket", QWebSocketServer::NonSecureMode, this))
+    , frameDemand(false)
+    , state(std::make_shared<OverlayState>())
+    , overlayPageVersion(0)
+    , stateResponseVersion(0)
+    , notesImageTimestamp(0)
+{
+    connect(server, &QTcpServer::newConnection, this, &OverlayServerWorker::onNewConnection);
+    connect(wsServer, &QWebSocketServer::newConnection, this, &OverlayServerWorker::onWsNewConnection);
+}
+
+OverlayServerWorker::~OverlayServerWorker()
+{
+    stop();
+}
+
+bool OverlayServerWorker::start(quint16 port)
+{
+    if (server->isListening()) {
+        return true;
+    }
+
+    bool httpOk = server->listen(QHostAddress::Any, port);
+    bool wsOk = wsServer->listen(QHostAddress::Any, port + 1);  // WebSocket on port 8081
+
+    return httpOk && wsOk;
+}
+
+void OverlayServerWorker::stop()
+{
+    const QList<QTcpSocket*> sockets = clients.keys();
+    clients.clear();
+    mjpegClients.clear();
+    for (QTcpSocket *client : sockets) {
+        client->disconnectFromHost();
+        client->deleteLater();
+    }
+
+    for (QWebSocket *wsClient : wsClients) {
+        wsClient->close();
+        wsClient->deleteLater();
+    }
+    wsClients.clear();
+
+    for (QWebSocket *wsClient : frameWsClients) {
+        wsClient->close();
+        wsClient->deleteLater();
+    }
+    frameWsClients.clear();
+    frameWsBacklog.clear();
+    updateFrameDemand();
+
+    if (server->isListening()) {
+        server->close();
+    }
+
+    if (wsServer->isListening()) {
+        wsServer->close();
+    }
+}
+
+void OverlayServerWorker::setState(const OverlayStateSnapshot &snapshot, int changed)
+{
+    state = snapshot;
+
+    const int fields = changed & ~OverlayState::Page;
+    if (fields == 0 || wsClients.isEmpty()) {
+        return;
+    }
+    QJsonObject msg = stateFields(fields, true);
+    msg["type"] = "state";
+    msg["version"] = static_cast<qint64>(state->version);
+    sendToWebSockets(msg);
+}
+
+QJsonObject OverlayServerWorker::stateFields(int fields, bool delta) const
+{
+    QJsonObject json;
+    if (fields & OverlayState::Text) {
+        json["reference"] = state->reference;
+        json["text"] = state->text;
+        json["textHtml"] = state->textHtml;
+    }
+    if (fields & OverlayState::Media) {
+        // Only send a flag indicating media presence, not the full path
+        json["hasMedia"] = !state->mediaPath.isEmpty();
+        json["mediaIsVideo"] = state->mediaIsVideo;
+        json["mediaTimestamp"] = state->mediaTimestamp;
+    }
+    if (fields & OverlayState::YouTube) {
+        json["hasYouTube"] = !state->youTubeUrl.isEmpty();
+        json["youTubeUrl"] = state->youTubeUrl;
+    }
+    if (fields & OverlayState::Notes) {
+        // Notes HTML is still sent for compatibility, but OBS now
+        // primarily uses the notes PNG image and timestamp.
+        json["notesVisible"] = state->notesVisible;
+        json["notesHtml"] = state->notesHtml;
+        json["notesImageTimestamp"] = state->notesImageTimestamp;
+    }
+    if (fields & OverlayState::MediaClock) {
+        QJsonObject clock;
+        clock["timestamp"] = state->mediaTimestamp;
+        clock["playing"] = state->mediaPlaying;
+        clock["positionMs"] = state->mediaPositionMs;
+        clock["serverTime"] = state->mediaClockTime;
+        clock["rate"] = state->mediaRate;
+        json["mediaClock"] = clock;
+    }
+    if (fields & OverlayState::Style) {
+        json["style"] = delta ? state->styleChanges : state->style;
+    }
+    if (fields & OverlayState::Refresh) {
+        json["refreshTimestamp"] = state->refreshTimestamp;
+    }
+    return json;
+}
+
+void OverlayServerWorker::sendToWebSockets(const QJsonObject &msg)
+{
+    const QString json = QString::fromUtf8(QJsonDocument(msg).toJson(QJsonDocument::Compact));
+    for (QWebSocket *wsClient : wsClients) {
+        wsClient->sendTextMessage(json);
+    }
+}
+
+void OverlayServerWorker::onNewConnection()
+{
+    while (server->hasPendingConnections()) {
+        QTcpSocket *client = server->nextPendingConnection();
+        connect(client, &QTcpSocket::disconnected, this, &OverlayServerWorker::onClientDisconnected);
+
+        // Make room by dropping a keep-alive connection that is doing
+        // nothing; if every connection is busy, turn the new one away
+        if (clients.size() >= kMaxConnections && !closeIdleClient()) {
+            qWarning() << "Overlay server at connection limit, refusing" << client->peerAddress().toString();
+            client->write("HTTP/1.1 503 Service Unavailable\r\n"
+                          "Content-Length: 0\r\n"
+                          "Retry-After: 1\r\n"
+                          "Connection: close\r\n"
+                          "\r\n");
+            client->disconnectFromHost();
+            continue;
+        }
+
+        HttpConnection &connection = clients[client];
+        connection.idleTimer = new QTimer(client);
+        connection.idleTimer->setSingleShot(true);
+        connect(connection.idleTimer, &QTimer::timeout, client, [client]() {
+            client->disconnectFromHost();
+        });
+        connection.idleTimer->start(kRequestTimeoutMs);
+
+        // Bounded so a client pipelining requests behind a long media
+        // response is held back by TCP rather than by our memory
+        client->setReadBufferSize(HttpRequestParser::MaxHeaderBytes + HttpRequestParser::MaxBodyBytes);
+        connect(client, &QTcpSocket::readyRead, this, &OverlayServerWorker::onReadyRead);
+        connect(client, &QTcpSocket::bytesWritten, this, &OverlayServerWorker::onBytesWritten);
+    }
+}
+
+void OverlayServerWorker::onClientDisconnected()
+{
+    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
+    if (client) {
+        clients.remove(client);
+        if (mjpegClients.removeAll(client) > 0) {
+            updateFrameDemand();
+        }
+        client->deleteLater();
+    }
+}
+
+bool OverlayServerWorker::closeIdleClient()
+{
+    for (auto it = clients.begin(); it != clients.end(); ++it) {
+        if (!it->closing && !it->streamMedia && !it->mjpeg && !it->parser.hasPartialRequest()
+            && it.key()->bytesToWrite() == 0) {
+            QTcpSocket *idle = it.key();
+            it->closing = true;
+            // May remove the entry straight away through disconnected()
+            idle->disconnectFromHost();
+            return true;
+        }
+    }
+    return false;
+}
+
+void OverlayServerWorker::onWsNewConnection()
+{
+    QWebSocket *wsClient = wsServer->nextPendingConnection();
+    if (wsClient && wsClient->requestUrl().path() == "/program") {
+        // Binary JPEG frames only; these clients get no state messages
+        frameWsClients.append(wsClient);
+        frameWsBacklog.insert(wsClient, 0);
+        connect(wsClient, &QWebSocket::disconnected, this, &OverlayServerWorker::onWsDisconnected);
+        connect(wsClient, &QWebSocket::bytesWritten, this, [this, wsClient](qint64 bytes) {
+            auto backlog = frameWsBacklog.find(wsClient);
+            if (backlog != frameWsBacklog.end()) {
+                *backlog = qMax<qint64>(0, *backlog - bytes);
+            }
+        });
+        sendProgramFrame(wsClient);
+        updateFrameDemand();
+    } else if (wsClient) {
+        wsClients.append(wsClient);
+        connect(wsClient, &QWebSocket::disconnected, this, &OverlayServerWorker::onWsDisconnected);
+        // Pages only send time sync requests and player reports
+        wsClient->setMaxAllowedIncomingMessageSize(1024);
+        connect(wsClient, &QWebSocket::textMessageReceived, this, &OverlayServerWorker::onWsTextMessage);
+        qDebug() << "WebSocket client connected";
+
+        // A page that just (re)connected may have missed deltas; give it
+        // the whole state before anything else
+        QJsonObject msg = stateFields(OverlayState::AllFields);
+        msg["type"] = "state";
+        msg["version"] = static_cast<qint64>(state->version);
+        msg["full"] = true;
+        wsClient->sendTextMessage(QString::fromUtf8(QJsonDocument(msg).toJson(QJsonDocument::Compact)));
+        emit webSocketClientConnected();
+    }
+}
+
+void OverlayServerWorker::onWsDisconnected()
+{
+    QWebSocket *wsClient = qobject_cast<QWebSocket*>(sender());
+    if (wsClient) {
+        wsClients.removeAll(wsClient);
+        if (frameWsClients.removeAll(wsClient) > 0) {
+            frameWsBacklog.remove(wsClient);
+            updateFrameDemand();
+        }
+        wsClient->deleteLater();
+        qDebug() << "WebSocket client disconnected";
+    }
+}
+
+void OverlayServerWorker::onWsTextMessage(const QString &message)
+{
+    QWebSocket *wsClient = qobject_cast<QWebSocket*>(sender());
+    const QJsonObject msg = QJsonDocument::fromJson(message.toUtf8()).object();
+    const QString type = msg.value("type").toString();
+    if (type == "youtube_ready") {
+        emit youTubeClientReady();
+        return;
+    }
+    if (!wsClient || type != "time_sync") {
+        return;
+    }
+
+    // NTP-style: the page pairs our clock with its send and receive times
+    // and keeps the sample with the shortest round trip. Answered here on
+    // the I/O thread so the GUI thread's load does not skew it.
+    QJsonObject reply;
+    reply["type"] = "time_sync";
+    reply["t0"] = msg.value("t0");
+    reply["serverTime"] = OverlayState::clockMs();
+    wsClient->sendTextMessage(QString::fromUtf8(QJsonDocument(reply).toJson(QJsonDocument::Compact)));
+}
+
+void OverlayServerWorker::onReadyRead()
+{
+    processRequests(qobject_cast<QTcpSocket*>(sender()));
+}
+
+void OverlayServerWorker::processRequests(QTcpSocket *client)
+{
+    auto it = clients.find(client);
+    if (it == clients.end()) {
+        return;
+    }
+    if (it->closing || it->mjpeg) {
+        client->readAll();
+        return;
+    }
+    if (it->streamMedia) {
+        // Picked up once the response in progress has been sent
+        return;
+    }
+
+    it->parser.append(client->readAll());
+
+    // Answer every complete request in the buffer, in order, so pipelined
+    // requests get their responses back in the order they were sent
+    HttpRequestParser::Request request;
+    for (;;) {
+        const HttpRequestParser::Status status = it->parser.next(request);
+        if (status == HttpRequestParser::NeedMoreData) {
+            break;
+        }
+        if (status == HttpRequestParser::Failed) {
+            it->closing = true;
+            sendError(client, it->parser.errorStatus());
+            return;
+        }
+
+        ++it->requests;
+        if (it->requests >= kMaxRequestsPerConnection) {
+            request.keepAlive = false;
+        }
+        handleRequest(client, request);
+        if (it->mjpeg) {
+            return;
+        }
+        if (it->streamMedia) {
+            // onBytesWritten() carries on from here; a client that stops
+            // reading is dropped by the idle timer
+            it->idleTimer->start(kIdleTimeoutMs);
+            return;
+        }
+        if (!request.keepAlive || it->closing) {
+            it->closing = true;
+            // Sends what was written first; may remove the entry through disconnected()
+            client->disconnectFromHost();
+            return;
+        }
+    }
+
+    // A half-received request gets less time than a connection between requests
+    it->idleTimer->start(it->parser.hasPartialRequest() ? kRequestTimeoutMs : kIdleTimeoutMs);
+}
+
+void OverlayServerWorker::onBytesWritten()
+{
+    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
+    auto it = clients.find(client);
+    if (it == clients.end() || !it->streamMedia) {
+        return;
+    }
+
+    it->idleTimer->start(kIdleTimeoutMs);
+    const StreamStatus status = writeMediaChunks(client, *it);
+    if (status == StreamPending) {
+        return;
+    }
+    if (status == StreamFailed || !it->streamKeepAlive) {
+        it->closing = true;
+        client->disconnectFromHost();
+        return;
+    }
+    processRequests(client);
+}
+
+void OverlayServerWorker::handleRequest(QTcpSocket *client, const HttpRequestParser::Request &request)
+{
+    if (request.method != "GET" && request.method != "HEAD") {
+        sendResponse(client, request, 405, "text/plain", "Method Not Allowed", "Allow: GET, HEAD\r\n");
+        return;
+    }
+
+    const QByteArray &path = request.path;
+    if (path == "/" || path == "/overlay") {
+        if (overlayPageVersion != state->pageVersion) {
+            overlayPage = cachedResponse("text/html; charset=utf-8", state->page, true);
+            overlayPageVersion = state->pageVersion;
+        }
+        sendCached(client, request, overlayPage);
+    } else if (path.startsWith("/media")) {
+        sendMedia(client, request);
+    } else if (path == "/program.mjpg") {
+        startMjpegStream(client, request);
+    } else if (path.startsWith("/notes")) {
+        // Serve the current notes PNG (transparent text overlay)
+        if (!state->notesVisible || state->notesImageTimestamp == 0 || notesResponse().body.isEmpty()) {
+            sendResponse(client, request, 204);
+        } else {
+            sendCached(client, request, notesImage);
+        }
+    } else if (path == "/data") {
+        // Fallback for pages whose WebSocket is down
+        if (stateResponseVersion != state->version) {
+            QJsonObject json = stateFields(OverlayState::AllFields);
+            json["version"] = static_cast<qint64>(state->version);
+            stateResponse = cachedResponse("application/json", QJsonDocument(json).toJson(QJsonDocument::Compact), false);
+            stateResponseVersion = state->version;
+        }
+        sendCached(client, request, stateResponse);
+    } else {
+        sendResponse(client, request, 404, "text/plain", "Not Found");
+    }
+}
+
+OverlayServerWorker::CachedResponse OverlayServerWorker::cachedResponse(const QByteArray &contentType, const QByteArray &body,
+                                                            bool compress)
+{
+    CachedResponse response;
+    response.contentType = contentType;
+    response.body = body;
+    response.etag = '"' + QCryptographicHash::hash(body, QCryptographicHash::Sha1).toHex().left(20) + '"';
+    if (compress) {
+        response.gzipBody = gzipCompress(body);
+        if (response.gzipBody.size() >= body.size()) {
+            response.gzipBody.clear();
+        }
+    }
+    return response;
+}
+
+const OverlayServerWorker::CachedResponse &OverlayServerWorker::notesResponse()
+{
+    if (notesImageTimestamp == state->notesImageTimestamp) {
+        return notesImage;
+    }
+    notesImageTimestamp = state->notesImageTimestamp;
+    notesImage = CachedResponse();
+    if (state->notesImage.isNull()) {
+        return notesImage;
+    }
+
+    QImage img = state->notesImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    // The notes image comes from the Projection Canvas preview. To avoid
+    // the OBS overlay making the text look larger than it appears on the
+    // canvas, never upscale it beyond the size of the media card. If the
+    // preview image is larger than the card, gently scale it down to fit;
+    // otherwise, keep it at its original size.
+    const QSize canvas = state->canvasSize;
+    if (canvas.width() > 0 && canvas.height() > 0) {
+        const int cardW = static_cast<int>(canvas.width() * 0.40);
+        const int cardH = static_cast<int>(canvas.height() * 0.40);
+        if (cardW > 0 && cardH > 0 && (img.width() > cardW || img.height() > cardH)) {
+            img = img.scaled(cardW, cardH, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+    }
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    img.save(&buffer, "PNG");
+    notesImage = cachedResponse("image/png", png, false);
+    return notesImage;
+}
+
+void OverlayServerWorker::sendCached(QTcpSocket *socket, const HttpRequestParser::Request &request,
+                               const CachedResponse &response)
+{
+    QByteArray headers = "ETag: " + response.etag + "\r\n";
+    if (!response.gzipBody.isEmpty()) {
+        headers += "Vary: Accept-Encoding\r\n";
+    }
+
+    if (request.headers.contains("if-none-match") && etagMatches(request.header("if-none-match"), response.etag)) {
+        sendResponse(socket, request, 304, QByteArray(), QByteArray(), headers);
+        return;
+    }
+
+    if (!response.gzipBody.isEmpty() && acceptsGzip(request.header("accept-encoding"))) {
+        sendResponse(socket, request, 200, response.contentType, response.gzipBody,
+                     headers + "Content-Encoding: gzip\r\n");
+    } else {
+        sendResponse(socket, request, 200, response.contentType, response.body, headers);
+    }
+}
+
+void OverlayServerWorker::sendResponse(QTcpSocket *socket, const HttpRequestParser::Request &request, int status,
+                                 const QByteArray &contentType, const QByteArray &body,
+                                 const QByteArray &extraHeaders)
+{
+    socket->write(responseHead(request, status, contentType, body.size(), extraHeaders));
+    if (request.method != "HEAD" && status != 304) {
+        socket->write(body);
+    }
+}
+
+void OverlayServerWorker::sendMedia(QTcpSocket *client, const HttpRequestParser::Request &request)
+{
+    // Serve the current media file, or its copy sized for the canvas
+    const QString mediaPath = state->mediaServePath.isEmpty() ? state->mediaPath : state->mediaServePath;
+    if (mediaPath.isEmpty()) {
+        // No media to serve - return empty response instead of 404
+        sendResponse(client, request, 204);
+        return;
+    }
+
+    std::shared_ptr<MediaFile> media = openMediaFile(mediaPath);
+    if (!media) {
+        qWarning() << "Failed to open media file:" << mediaPath;
+        sendResponse(client, request, 404, "text/plain", "Not Found");
+        return;
+    }
+
+    QByteArray contentType;
+    const QString ext = QFileInfo(mediaPath).suffix().toLower();
+    if (state->mediaIsVideo) {
+        if (ext == "mp4") contentType = "video/mp4";
+        else if (ext == "webm") contentType = "video/webm";
+        else if (ext == "avi") contentType = "video/x-msvideo";
+        else if (ext == "mov") contentType = "video/quicktime";
+        else contentType = "video/mp4";
+    } else {
+        if (ext == "jpg" || ext == "jpeg") contentType = "image/jpeg";
+        else if (ext == "png") contentType = "image/png";
+        else if (ext == "gif") contentType = "image/gif";
+        else if (ext == "bmp") contentType = "image/bmp";
+        else if (ext == "webp") contentType = "image/webp";
+        else contentType = "image/jpeg";
+    }
+
+    // Browsers fetch video in ranges to start quickly and to seek
+    qint64 start = 0;
+    qint64 length = media->size;
+    QByteArray extraHeaders = "Accept-Ranges: bytes\r\n";
+    const int status = request.headers.contains("range")
+        ? parseByteRange(request.header("range"), media->size, start, length)
+        : 200;
+    if (status == 416) {
+        sendResponse(client, request, 416, "text/plain", "Range Not Satisfiable",
+                     "Content-Range: bytes */" + QByteArray::number(media->size) + "\r\n");
+        return;
+    }
+    if (status == 206) {
+        extraHeaders += "Content-Range: bytes " + QByteArray::number(start) + '-'
+                        + QByteArray::number(start + length - 1) + '/' + QByteArray::number(media->size) + "\r\n";
+    }
+
+    client->write(responseHead(request, status, contentType, length, extraHeaders));
+    if (request.method == "HEAD" || length == 0) {
+        return;
+    }
+
+    // The body follows from the mapping as the socket drains, so neither
+    // the file size nor the number of clients decides how much is queued
+    HttpConnection &connection = clients[client];
+    connection.streamMedia = media;
+    connection.streamPos = start;
+    connection.streamEnd = start + length;
+    connection.streamKeepAlive = request.keepAlive;
+    if (writeMediaChunks(client, connection) == StreamFailed) {
+        // Part of the body may be out already; processRequests() closes
+        connection.closing = true;
+    }
+}
+
+OverlayServerWorker::StreamStatus OverlayServerWorker::writeMediaChunks(QTcpSocket *socket, HttpConnection &connection)
+{
+    MediaFile &media = *connection.streamMedia;
+    while (connection.streamPos < connection.streamEnd && socket->bytesToWrite() < kStreamBufferBytes) {
+        const qint64 size = qMin(kStreamChunkBytes, connection.streamEnd - connection.streamPos);
+        qint64 written = -1;
+        if (media.data) {
+            written = socket->write(reinterpret_cast<const char *>(media.data + connection.streamPos), size);
+        } else if (media.file.seek(connection.streamPos)) {
+            // Files that cannot be mapped are read a chunk at a time instead
+            const QByteArray chunk = media.file.read(size);
+            if (chunk.size() == size) {
+                written = socket->write(chunk);
+            }
+        }
+        if (written <= 0) {
+            qWarning() << "Failed to stream media file:" << media.path;
+            connection.streamMedia.reset();
+            return StreamFailed;
+        }
+        connection.streamPos += written;
+    }
+
+    if (connection.streamPos < connection.streamEnd) {
+        return StreamPending;
+    }
+    connection.streamMedia.reset();
+    return StreamDone;
+}
+
+std::shared_ptr<OverlayServerWorker::MediaFile> OverlayServerWorker::openMediaFile(const QString &path)
+{
+    const QFileInfo info(path);
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    std::shared_ptr<MediaFile> media = lastMediaFile.lock();
+    if (media && media->path == path && media->size == info.size() && media->modified == modified) {
+        return media;
+    }
+
+    media = std::make_shared<MediaFile>();
+    media->file.setFileName(path);
+    if (!media->file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    media->path = path;
+    media->modified = modified;
+    media->size = media->file.size();
+    if (media->size > 0) {
+        media->data = media->file.map(0, media->size);
+    }
+    lastMediaFile = media;
+    return media;
+}
+
+void OverlayServerWorker::sendError(QTcpSocket *socket, int status)
+{
+    HttpRequestParser::Request request;
+    request.keepAlive = false;
+    const QByteArray reason = reasonPhrase(status);
+    sendResponse(socket, request, status, "text/plain", reason);
+    socket->disconnectFromHost();
+}
+
+
+void OverlayServerWorker::startMjpegStream(QTcpSocket *client, const HttpRequestParser::Request &request)
+{
+    auto it = clients.find(client);
+    if (request.method == "HEAD" || it == clients.end()) {
+        sendResponse(client, request, 200, "multipart/x-mixed-replace; boundary=spframe");
+        return;
+    }
+
+    // No length: the response runs until the client closes it
+    client->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: multipart/x-mixed-replace; boundary=spframe\r\n"
+                  "Access-Control-Allow-Origin: *\r\n"
+                  "Cache-Control: no-cache, no-store\r\n"
+                  "Connection: close\r\n"
+                  "\r\n");
+    it->mjpeg = true;
+    it->idleTimer->stop();
+    mjpegClients.append(client);
+    sendProgramFrame(client);
+    updateFrameDemand();
+}
+
+void OverlayServerWorker::setProgramFrame(const QByteArray &jpeg)
+{
+    programFrame = jpeg;
+    for (QTcpSocket *client : mjpegClients) {
+        sendProgramFrame(client);
+    }
+    for (QWebSocket *wsClient : frameWsClients) {
+        sendProgramFrame(wsClient);
+    }
+}
+
+void OverlayServerWorker::sendProgramFrame(QTcpSocket *client)
+{
+    if (programFrame.isEmpty() || client->bytesToWrite() > kMaxFrameBacklogBytes) {
+        return;
+    }
+    client->write("--spframe\r\n"
+                  "Content-Type: image/jpeg\r\n"
+                  "Content-Length: " + QByteArray::number(programFrame.size()) + "\r\n"
+                  "\r\n");
+    client->write(programFrame);
+    client->write("\r\n");
+}
+
+void OverlayServerWorker::sendProgramFrame(QWebSocket *wsClient)
+{
+    qint64 &backlog = frameWsBacklog[wsClient];
+    if (programFrame.isEmpty() || backlog > kMaxFrameBacklogBytes) {
+        return;
+    }
+    backlog += wsClient->sendBinaryMessage(programFrame);
+}
+
+void OverlayServerWorker::updateFrameDemand()
+{
+    const bool demand = !mjpegClients.isEmpty() || !frameWsClients.isEmpty();
+    if (demand == frameDemand) {
+        return;
+    }
+    frameDemand = demand;
+    if (!demand) {
+        // Never show the next viewer a picture from a previous session
+        programFrame.clear();
+    }
+    emit programStreamDemandChanged(demand);
+}
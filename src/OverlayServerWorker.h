@@ -0,0 +1,151 @@
+#ifndef OVERLAYSERVERWORKER_H
+#define OVERLAYSERVERWORKER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <QList>
+#include <QHash>
+#include <QFile>
+#include <QJsonObject>
+#include <memory>
+#include "HttpRequestParser.h"
+#include "OverlayState.h"
+
+class QTimer;
+
+// The network side of OverlayServer: HTTP and WebSocket servers, request
+// parsing, cached responses and media streaming. Lives on the overlay
+// server's I/O thread and serves whatever OverlayState snapshot it was
+// last given, so client traffic never runs on the GUI thread.
+class OverlayServerWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OverlayServerWorker(QObject *parent = nullptr);
+    ~OverlayServerWorker();
+
+    bool start(quint16 port);
+    void stop();
+
+    // Takes over a new snapshot and pushes the changed fields to pages
+    void setState(const OverlayStateSnapshot &snapshot, int changed);
+    void sendToWebSockets(const QJsonObject &msg);
+
+    // Sends a program output JPEG to every stream subscriber
+    void setProgramFrame(const QByteArray &jpeg);
+
+signals:
+    void webSocketClientConnected();
+    void youTubeClientReady();
+    void programStreamDemandChanged(bool active);
+
+private slots:
+    void onNewConnection();
+    void onClientDisconnected();
+    void onReadyRead();
+    void onBytesWritten();
+
+    // WebSocket slots
+    void onWsNewConnection();
+    void onWsDisconnected();
+    void onWsTextMessage(const QString &message);
+
+private:
+    // A media file mapped into memory once and shared by every connection
+    // streaming it
+    struct MediaFile {
+        QFile file;
+        QString path;
+        qint64 modified = 0;
+        qint64 size = 0;
+        uchar *data = nullptr; // whole file, or null when it could not be mapped
+
+        ~MediaFile() { if (data) file.unmap(data); }
+    };
+
+    // Per-connection HTTP state. Connections are kept alive between
+    // requests and closed after sitting idle. While a media response is
+    // streaming, later pipelined requests wait in the socket. An MJPEG
+    // connection stays open for frames until the client goes away.
+    struct HttpConnection {
+        HttpRequestParser parser;
+        QTimer *idleTimer = nullptr;
+        int requests = 0;
+        bool closing = false;
+
+        std::shared_ptr<MediaFile> streamMedia;
+        qint64 streamPos = 0;
+        qint64 streamEnd = 0;
+        bool streamKeepAlive = false;
+
+        bool mjpeg = false;
+    };
+
+    enum StreamStatus {
+        StreamPending,
+        StreamDone,
+        StreamFailed
+    };
+
+    // A response body serialised once, with its gzip form and validator
+    struct CachedResponse {
+        QByteArray contentType;
+        QByteArray body;
+        QByteArray gzipBody; // empty when not compressed
+        QByteArray etag;
+    };
+
+    // A full snapshot of the given fields, or with delta just what this
+    // snapshot changed where the state keeps track of that
+    QJsonObject stateFields(int fields, bool delta = false) const;
+
+    static CachedResponse cachedResponse(const QByteArray &contentType, const QByteArray &body, bool compress);
+    void sendCached(QTcpSocket *socket, const HttpRequestParser::Request &request, const CachedResponse &response);
+    const CachedResponse &notesResponse();
+
+    void processRequests(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const HttpRequestParser::Request &request);
+    void sendMedia(QTcpSocket *socket, const HttpRequestParser::Request &request);
+    StreamStatus writeMediaChunks(QTcpSocket *socket, HttpConnection &connection);
+    std::shared_ptr<MediaFile> openMediaFile(const QString &path);
+    void sendResponse(QTcpSocket *socket, const HttpRequestParser::Request &request, int status,
+                      const QByteArray &contentType = QByteArray(), const QByteArray &body = QByteArray(),
+                      const QByteArray &extraHeaders = QByteArray());
+    void sendError(QTcpSocket *socket, int status);
+    bool closeIdleClient();
+
+    void startMjpegStream(QTcpSocket *socket, const HttpRequestParser::Request &request);
+    void sendProgramFrame(QTcpSocket *socket);
+    void sendProgramFrame(QWebSocket *wsClient);
+    void updateFrameDemand();
+
+    QTcpServer *server;
+    QHash<QTcpSocket*, HttpConnection> clients;
+    std::weak_ptr<MediaFile> lastMediaFile;
+
+    QWebSocketServer *wsServer;
+    QList<QWebSocket*> wsClients;
+
+    // Program output subscribers: /program.mjpg and ws://…/program
+    QByteArray programFrame;
+    QList<QTcpSocket*> mjpegClients;
+    QList<QWebSocket*> frameWsClients;
+    QHash<QWebSocket*, qint64> frameWsBacklog; // bytes sent but not yet written
+    bool frameDemand;
+
+    OverlayStateSnapshot state;
+
+    // Rebuilt only when the snapshot they come from changes
+    CachedResponse overlayPage;
+    quint64 overlayPageVersion;
+    CachedResponse stateResponse;
+    quint64 stateResponseVersion;
+    CachedResponse notesImage;
+    qint64 notesImageTimestamp;
+};
+
+#endif // OVERLAYSERVERWORKER_H
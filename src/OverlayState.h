@@ -0,0 +1,78 @@
+#ifndef OVERLAYSTATE_H
+#define OVERLAYSTATE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <QJsonObject>
+#include <chrono>
+#include <memory>
+
+// Everything the OBS overlay server hands out, as one value. The GUI
+// thread edits its own copy and publishes an immutable snapshot whenever
+// something changed; the server's I/O thread only ever reads snapshots, so
+// it never sees a half-applied update and never has to lock.
+struct OverlayState
+{
+    // Groups of fields, used to say what a new snapshot changed
+    enum Field {
+        Text = 0x1,
+        Media = 0x2,
+        YouTube = 0x4,
+        Notes = 0x8,
+        Refresh = 0x10,
+        Page = 0x20,
+        MediaClock = 0x40,
+        Style = 0x80,
+        AllFields = 0xff
+    };
+
+    // Monotonic milliseconds used for media clock anchors and answered to
+    // the pages' time sync requests; unrelated to wall-clock time
+    static double clockMs()
+    {
+        using namespace std::chrono;
+        return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    quint64 version = 1; // bumped on every change
+
+    QString reference;
+    QString text;        // without brackets
+    QString textHtml;    // brackets as italic spans
+
+    QString mediaPath;
+    QString mediaServePath; // a copy sized for the canvas, when there is one
+    bool mediaIsVideo = false;
+    qint64 mediaTimestamp = 0;
+
+    // Playback of the projected video: at clockMs() == mediaClockTime it
+    // was at mediaPositionMs, moving at mediaRate while playing. Pages
+    // extrapolate from this anchor; 0 means the projector has not
+    // reported yet.
+    bool mediaPlaying = false;
+    qint64 mediaPositionMs = 0;
+    double mediaClockTime = 0;
+    double mediaRate = 1.0;
+
+    QString youTubeUrl;
+
+    bool notesVisible = false;
+    QString notesHtml;
+    QImage notesImage;   // as rendered; scaled and encoded on the I/O thread
+    qint64 notesImageTimestamp = 0;
+
+    qint64 refreshTimestamp = 0;
+
+    QJsonObject style;        // CSS custom properties the page is styled with
+    QJsonObject styleChanges; // those that changed in this snapshot
+
+    QByteArray page;     // the overlay HTML, regenerated on style changes
+    quint64 pageVersion = 0;
+    QSize canvasSize;
+};
+
+using OverlayStateSnapshot = std::shared_ptr<const OverlayState>;
+
+#endif // OVERLAYSTATE_H
@@ -0,0 +1,321 @@
+#include "PlaylistJournal.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMap>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Edits per segment before the journal is compacted into a snapshot. Also
+// bounds how much recovery has to replay.
+static const int kEditsPerSegment = 200;
+
+// Journal files by number, oldest first
+QMap<int, QString> numberedFiles(const QDir &dir, const QString &prefix, const QString &suffix)
+{
+    QMap<int, QString> files;
+    const QStringList names = dir.entryList(QStringList() << prefix + "*" + suffix, QDir::Files);
+    for (const QString &name : names) {
+        bool ok = false;
+        const int number = name.mid(prefix.size(), name.size() - prefix.size() - suffix.size()).toInt(&ok);
+        if (ok) {
+            files.insert(number, dir.filePath(name));
+        }
+    }
+    return files;
+}
+
+bool writeSnapshot(const QString &path, const PlaylistJournal::State &state)
+{
+    QJsonObject root;
+    root["file"] = state.playlistFile;
+    root["saved"] = state.saved;
+    root["playlist"] = state.playlist;
+
+    // QSaveFile syncs before replacing, so a snapshot is whole or absent
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+bool readSnapshot(const QString &path, PlaylistJournal::State &state)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        return false;
+    }
+    const QJsonObject root = doc.object();
+    state.playlist = root.value("playlist").toObject();
+    state.playlistFile = root.value("file").toString();
+    state.saved = root.value("saved").toBool(true);
+    return true;
+}
+
+// Applies one journal line with the same index rules as PlaylistManager
+bool applyEdit(QJsonArray &items, const QJsonObject &op)
+{
+    const QString type = op.value("op").toString();
+    if (type == "add") {
+        items.append(op.value("item"));
+        return true;
+    }
+
+    const int index = op.value("index").toInt(-1);
+    if (type == "remove" && index >= 0 && index < items.size()) {
+        items.removeAt(index);
+        return true;
+    }
+    if (type == "update" && index >= 0 && index < items.size()) {
+        items.replace(index, op.value("item"));
+        return true;
+    }
+    if (type == "move") {
+        const int from = op.value("from").toInt(-1);
+        const int to = op.value("to").toInt(-1);
+        if (from >= 0 && from < items.size() && to >= 0 && to < items.size() && from != to) {
+            items.insert(to, items.takeAt(from));
+            return true;
+        }
+    }
+    return false;
+}
+
+void syncToDisk(QFile &file)
+{
+    file.flush();
+#ifdef Q_OS_WIN
+    _commit(file.handle());
+#else
+    ::fsync(file.handle());
+#endif
+}
+
+} // namespace
+
+PlaylistJournal::PlaylistJournal(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , directory(directory)
+    , segmentNumber(0)
+    , editsInSegment(0)
+{
+    connect(&compaction, &QFutureWatcher<bool>::finished, this, [this]() {
+        if (compaction.result()) {
+            removeObsoleteFiles();
+        }
+    });
+}
+
+PlaylistJournal::~PlaylistJournal()
+{
+    compaction.waitForFinished();
+}
+
+QString PlaylistJournal::defaultDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("playlist-journal");
+}
+
+QString PlaylistJournal::snapshotPath(int number) const
+{
+    return QDir(directory).filePath(QString("snapshot-%1.json").arg(number));
+}
+
+QString PlaylistJournal::segmentPath(int number) const
+{
+    return QDir(directory).filePath(QString("segment-%1.jsonl").arg(number));
+}
+
+bool PlaylistJournal::recover(State &state) const
+{
+    const QDir dir(directory);
+    const QMap<int, QString> snapshots = numberedFiles(dir, "snapshot-", ".json");
+
+    // Newest snapshot that reads back
+    int base = -1;
+    for (auto it = snapshots.constEnd(); it != snapshots.constBegin();) {
+        --it;
+        if (readSnapshot(it.value(), state)) {
+            base = it.key();
+            break;
+        }
+    }
+    if (base < 0) {
+        return false;
+    }
+
+    QJsonArray items = state.playlist.value("items").toArray();
+    const QMap<int, QString> segments = numberedFiles(dir, "segment-", ".jsonl");
+    for (auto it = segments.upperBound(base); it != segments.constEnd(); ++it) {
+        QFile file(it.value());
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine().trimmed();
+            if (line.isEmpty()) {
+                continue;
+            }
+            // A line cut short by the crash is the last one written
+            const QJsonDocument doc = QJsonDocument::fromJson(line);
+            if (!doc.isObject()) {
+                break;
+            }
+            if (applyEdit(items, doc.object())) {
+                state.saved = false;
+            }
+        }
+    }
+    state.playlist["items"] = items;
+    return true;
+}
+
+bool PlaylistJournal::reset(const State &state)
+{
+    segment.close();
+    editsInSegment = 0;
+
+    QDir dir(directory);
+    dir.mkpath(".");
+
+    // Number past anything on disk, including a snapshot still being
+    // written by a compaction
+    int number = segmentNumber;
+    const QMap<int, QString> snapshots = numberedFiles(dir, "snapshot-", ".json");
+    const QMap<int, QString> segments = numberedFiles(dir, "segment-", ".jsonl");
+    if (!snapshots.isEmpty()) {
+        number = qMax(number, snapshots.lastKey());
+    }
+    if (!segments.isEmpty()) {
+        number = qMax(number, segments.lastKey());
+    }
+    ++number;
+
+    if (!writeSnapshot(snapshotPath(number), state)) {
+        return false;
+    }
+    playlistFile = state.playlistFile;
+    if (!openSegment(number + 1)) {
+        return false;
+    }
+    removeObsoleteFiles();
+    return true;
+}
+
+bool PlaylistJournal::openSegment(int number)
+{
+    segment.close();
+    segment.setFileName(segmentPath(number));
+    segmentNumber = number;
+    editsInSegment = 0;
+    return segment.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+void PlaylistJournal::append(const QJsonObject &op)
+{
+    if (!segment.isOpen()) {
+        return;
+    }
+    QByteArray line = QJsonDocument(op).toJson(QJsonDocument::Compact);
+    line += '\n';
+    segment.write(line);
+    syncToDisk(segment);
+    ++editsInSegment;
+}
+
+void PlaylistJournal::recordAdd(const QJsonObject &item)
+{
+    QJsonObject op;
+    op["op"] = "add";
+    op["item"] = item;
+    append(op);
+}
+
+void PlaylistJournal::recordRemove(int index)
+{
+    QJsonObject op;
+    op["op"] = "remove";
+    op["index"] = index;
+    append(op);
+}
+
+void PlaylistJournal::recordMove(int fromIndex, int toIndex)
+{
+    QJsonObject op;
+    op["op"] = "move";
+    op["from"] = fromIndex;
+    op["to"] = toIndex;
+    append(op);
+}
+
+void PlaylistJournal::recordUpdate(int index, const QJsonObject &item)
+{
+    QJsonObject op;
+    op["op"] = "update";
+    op["index"] = index;
+    op["item"] = item;
+    append(op);
+}
+
+void PlaylistJournal::compactIfNeeded(const std::function<QJsonObject()> &snapshot)
+{
+    if (!segment.isOpen() || editsInSegment < kEditsPerSegment || compaction.isRunning()) {
+        return;
+    }
+
+    // Edits go to the next segment while the snapshot for this one is
+    // written; until it is, recovery still replays from the older snapshot
+    const int number = segmentNumber;
+    if (!openSegment(number + 1)) {
+        return;
+    }
+
+    const QString path = snapshotPath(number);
+    const QString file = playlistFile;
+    compaction.setFuture(QtConcurrent::run([snapshot, path, file]() {
+        State state;
+        state.playlist = snapshot();
+        state.playlistFile = file;
+        state.saved = false;
+        return writeSnapshot(path, state);
+    }));
+}
+
+void PlaylistJournal::removeObsoleteFiles()
+{
+    const QDir dir(directory);
+    const QMap<int, QString> snapshots = numberedFiles(dir, "snapshot-", ".json");
+    if (snapshots.isEmpty()) {
+        return;
+    }
+    const int newest = snapshots.lastKey();
+    for (auto it = snapshots.constBegin(); it != snapshots.constEnd() && it.key() < newest; ++it) {
+        QFile::remove(it.value());
+    }
+    const QMap<int, QString> segments = numberedFiles(dir, "segment-", ".jsonl");
+    for (auto it = segments.constBegin(); it != segments.constEnd() && it.key() <= newest; ++it) {
+        QFile::remove(it.value());
+    }
+}
+
+void PlaylistJournal::discard()
+{
+    compaction.waitForFinished();
+    segment.close();
+    QDir(directory).removeRecursively();
+}
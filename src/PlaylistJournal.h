@@ -0,0 +1,74 @@
+#ifndef PLAYLISTJOURNAL_H
+#define PLAYLISTJOURNAL_H
+
+#include <QObject>
+#include <QString>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <functional>
+
+// Crash-safe record of the playlist being edited, so a service survives a
+// crash or power loss between saves.
+//
+// The journal directory holds numbered files: snapshot-N.json is the whole
+// playlist as it stood at the end of segment-N.jsonl, and every segment
+// after the newest snapshot lists edits made since, one JSON object per
+// line, synced to disk as it is written. Recovery loads the newest snapshot
+// and replays the segments after it.
+//
+// Each edit costs one short line. Loading, saving or starting a playlist
+// writes a fresh snapshot; otherwise, once a segment holds enough edits,
+// a new one is started and the snapshot for the old one is written on a
+// worker thread. Files made obsolete by a snapshot are then removed.
+class PlaylistJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct State {
+        QJsonObject playlist;  // as stored in .spp files
+        QString playlistFile;  // the .spp it was loaded from or saved to
+        bool saved = true;     // no edits since then
+    };
+
+    explicit PlaylistJournal(const QString &directory, QObject *parent = nullptr);
+    ~PlaylistJournal();
+
+    static QString defaultDirectory();
+
+    // Replays what an earlier run left behind. False when there is none.
+    bool recover(State &state) const;
+
+    // Starts over from a known playlist. Nothing is recorded before the
+    // first reset.
+    bool reset(const State &state);
+
+    void recordAdd(const QJsonObject &item);
+    void recordRemove(int index);
+    void recordMove(int fromIndex, int toIndex);
+    void recordUpdate(int index, const QJsonObject &item);
+
+    // snapshot is called on a worker thread and must only use what it
+    // captured. Does nothing until the current segment is long enough.
+    void compactIfNeeded(const std::function<QJsonObject()> &snapshot);
+
+    // Removes the journal after a clean shutdown
+    void discard();
+
+private:
+    void append(const QJsonObject &op);
+    bool openSegment(int number);
+    QString snapshotPath(int number) const;
+    QString segmentPath(int number) const;
+    void removeObsoleteFiles();
+
+    QString directory;
+    QFile segment;
+    int segmentNumber;
+    int editsInSegment;
+    QString playlistFile;
+    QFutureWatcher<bool> compaction;
+};
+
+#endif // PLAYLISTJOURNAL_H
@@ -1,11 +1,73 @@
 #include "PlaylistManager.h"
+#include "PlaylistJournal.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonArray>
 
+namespace {
+
+QJsonObject itemToJson(const PlaylistItem &item)
+{
+    QJsonObject itemObj;
+    
+    if (item.type == PlaylistItemType::BibleVerse) {
+        itemObj["type"] = "bible";
+    } else if (item.type == PlaylistItemType::Song) {
+        itemObj["type"] = "song";
+    } else if (item.type == PlaylistItemType::Media) {
+        itemObj["type"] = "media";
+    } else if (item.type == PlaylistItemType::YouTube) {
+        itemObj["type"] = "youtube";
+    }
+    
+    itemObj["title"] = item.title;
+    itemObj["reference"] = item.reference;
+    itemObj["data"] = item.data;
+    return itemObj;
+}
+
+bool itemFromJson(const QJsonObject &itemObj, PlaylistItem &item)
+{
+    QString typeStr = itemObj["type"].toString();
+    if (typeStr == "bible") {
+        item.type = PlaylistItemType::BibleVerse;
+    } else if (typeStr == "song") {
+        item.type = PlaylistItemType::Song;
+    } else if (typeStr == "media") {
+        item.type = PlaylistItemType::Media;
+    } else if (typeStr == "youtube") {
+        item.type = PlaylistItemType::YouTube;
+    } else {
+        return false;
+    }
+    
+    item.title = itemObj["title"].toString();
+    item.reference = itemObj["reference"].toString();
+    item.data = itemObj["data"].toObject();
+    return true;
+}
+
+QJsonObject playlistToJson(const QVector<PlaylistItem> &items)
+{
+    QJsonObject root;
+    root["version"] = "1.0";
+    
+    QJsonArray itemsArray;
+    for (const PlaylistItem &item : items) {
+        itemsArray.append(itemToJson(item));
+    }
+    
+    root["items"] = itemsArray;
+    return root;
+}
+
+} // namespace
+
 PlaylistManager::PlaylistManager(QObject *parent)
     : QObject(parent)
     , unsavedChanges(false)
+    , journal(new PlaylistJournal(PlaylistJournal::defaultDirectory(), this))
 {
 }
 
@@ -17,6 +79,9 @@ void PlaylistManager::clear()
 {
     items.clear();
     unsavedChanges = true;
+    // A new playlist belongs to no file yet
+    resetJournal(QString());
+    emit playlistReset();
     emit playlistChanged();
 }
 
@@ -24,6 +89,8 @@ void PlaylistManager::addItem(const PlaylistItem &item)
 {
     items.append(item);
     unsavedChanges = true;
+    journal->recordAdd(itemToJson(item));
+    compactJournal();
     emit itemAdded(items.size() - 1);
     emit playlistChanged();
 }
@@ -33,6 +100,8 @@ void PlaylistManager::removeItem(int index)
     if (index >= 0 && index < items.size()) {
         items.remove(index);
         unsavedChanges = true;
+        journal->recordRemove(index);
+        compactJournal();
         emit itemRemoved(index);
         emit playlistChanged();
     }
@@ -49,11 +118,25 @@ void PlaylistManager::moveItem(int fromIndex, int toIndex)
         items.insert(toIndex, item);
         
         unsavedChanges = true;
+        journal->recordMove(fromIndex, toIndex);
+        compactJournal();
         emit itemMoved(fromIndex, toIndex);
         emit playlistChanged();
     }
 }
 
+void PlaylistManager::updateItem(int index, const PlaylistItem &item)
+{
+    if (index >= 0 && index < items.size()) {
+        items[index] = item;
+        unsavedChanges = true;
+        journal->recordUpdate(index, itemToJson(item));
+        compactJournal();
+        emit itemUpdated(index);
+        emit playlistChanged();
+    }
+}
+
 PlaylistItem PlaylistManager::getItem(int index) const
 {
     if (index >= 0 && index < items.size()) {
@@ -77,82 +160,104 @@ bool PlaylistManager::loadPlaylist(const QString &filePath)
         return false;
     }
     
-    QJsonObject root = doc.object();
-    QJsonArray itemsArray = root["items"].toArray();
-    
-    items.clear();
-    
-    for (const QJsonValue &value : itemsArray) {
-        QJsonObject itemObj = value.toObject();
-        
-        PlaylistItem item;
-        
-        QString typeStr = itemObj["type"].toString();
-        if (typeStr == "bible") {
-            item.type = PlaylistItemType::BibleVerse;
-        } else if (typeStr == "song") {
-            item.type = PlaylistItemType::Song;
-        } else if (typeStr == "media") {
-            item.type = PlaylistItemType::Media;
-        } else if (typeStr == "youtube") {
-            item.type = PlaylistItemType::YouTube;
-        } else {
-            continue;
-        }
-        
-        item.title = itemObj["title"].toString();
-        item.reference = itemObj["reference"].toString();
-        item.data = itemObj["data"].toObject();
-        
-        items.append(item);
-    }
+    setItems(doc.object());
+    unsavedChanges = false;
+    resetJournal(filePath);
+    emit playlistReset();
+    emit playlistChanged();
     
+    return true;
+}
+
+bool PlaylistManager::loadFromJson(const QJsonObject &root)
+{
+    setItems(root);
     unsavedChanges = false;
+    resetJournal(QString());
+    emit playlistReset();
     emit playlistChanged();
     
     return true;
 }
 
-bool PlaylistManager::savePlaylist(const QString &filePath)
+void PlaylistManager::setItems(const QJsonObject &root)
 {
-    QJsonObject root;
-    root["version"] = "1.0";
+    QJsonArray itemsArray = root["items"].toArray();
     
-    QJsonArray itemsArray;
+    items.clear();
     
-    for (const PlaylistItem &item : items) {
-        QJsonObject itemObj;
-        
-        if (item.type == PlaylistItemType::BibleVerse) {
-            itemObj["type"] = "bible";
-        } else if (item.type == PlaylistItemType::Song) {
-            itemObj["type"] = "song";
-        } else if (item.type == PlaylistItemType::Media) {
-            itemObj["type"] = "media";
-        } else if (item.type == PlaylistItemType::YouTube) {
-            itemObj["type"] = "youtube";
+    for (const QJsonValue &value : itemsArray) {
+        PlaylistItem item;
+        if (itemFromJson(value.toObject(), item)) {
+            items.append(item);
         }
-        
-        itemObj["title"] = item.title;
-        itemObj["reference"] = item.reference;
-        itemObj["data"] = item.data;
-        
-        itemsArray.append(itemObj);
     }
+}
+
+bool PlaylistManager::savePlaylist(const QString &filePath)
+{
+    QJsonDocument doc(toJson());
     
-    root["items"] = itemsArray;
-    
-    QJsonDocument doc(root);
-    
-    QFile file(filePath);
+    // Written aside and renamed over, so a crash never leaves half a file
+    QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly)) {
         return false;
     }
     
     file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    if (!file.commit()) {
+        return false;
+    }
     
     unsavedChanges = false;
+    resetJournal(filePath);
     
     return true;
 }
+
+QJsonObject PlaylistManager::toJson() const
+{
+    return playlistToJson(items);
+}
+
+bool PlaylistManager::recoverFromJournal(QString *playlistFile)
+{
+    PlaylistJournal::State state;
+    const bool recovered = journal->recover(state) &&
+        (!state.playlist["items"].toArray().isEmpty() || !state.playlistFile.isEmpty());
+    
+    if (recovered) {
+        setItems(state.playlist);
+        unsavedChanges = !state.saved;
+        if (playlistFile) {
+            *playlistFile = state.playlistFile;
+        }
+        emit playlistReset();
+        emit playlistChanged();
+    }
+    
+    resetJournal(recovered ? state.playlistFile : QString());
+    return recovered;
+}
+
+void PlaylistManager::discardJournal()
+{
+    journal->discard();
+}
+
+void PlaylistManager::resetJournal(const QString &playlistFile)
+{
+    PlaylistJournal::State state;
+    state.playlist = toJson();
+    state.playlistFile = playlistFile;
+    state.saved = !unsavedChanges;
+    journal->reset(state);
+}
+
+void PlaylistManager::compactJournal()
+{
+    // Copying the vector only shares it; the worker serialises it
+    journal->compactIfNeeded([snapshot = items]() {
+        return playlistToJson(snapshot);
+    });
+}
@@ -6,6 +6,8 @@
 #include <QVector>
 #include <QJsonObject>
 
+class PlaylistJournal;
+
 enum class PlaylistItemType {
     BibleVerse,
     Song,
@@ -37,6 +39,7 @@ public:
     void addItem(const PlaylistItem &item);
     void removeItem(int index);
     void moveItem(int fromIndex, int toIndex);
+    void updateItem(int index, const PlaylistItem &item);
     PlaylistItem getItem(int index) const;
     int itemCount() const { return items.size(); }
     
@@ -44,6 +47,15 @@ public:
     bool loadPlaylist(const QString &filePath);
     bool savePlaylist(const QString &filePath);
     
+    // The playlist as stored in .spp files
+    QJsonObject toJson() const;
+    bool loadFromJson(const QJsonObject &root);
+    
+    // Crash recovery: restores the playlist an earlier run was editing and
+    // starts journaling. playlistFile receives the .spp it belongs to.
+    bool recoverFromJournal(QString *playlistFile = nullptr);
+    void discardJournal();
+    
     // State
     bool hasUnsavedChanges() const { return unsavedChanges; }
     void markSaved() { unsavedChanges = false; }
@@ -53,13 +65,21 @@ public:
 
 signals:
     void playlistChanged();
+    // Every item was replaced: cleared, loaded or recovered
+    void playlistReset();
     void itemAdded(int index);
     void itemRemoved(int index);
     void itemMoved(int fromIndex, int toIndex);
+    void itemUpdated(int index);
 
 private:
+    void setItems(const QJsonObject &root);
+    void resetJournal(const QString &playlistFile);
+    void compactJournal();
+
     QVector<PlaylistItem> items;
     bool unsavedChanges;
+    PlaylistJournal *journal;
 };
 
 #endif // PLAYLISTMANAGER_H
@@ -0,0 +1,210 @@
+#include "PlaylistModel.h"
+#include <QApplication>
+#include <QMimeData>
+#include <QStyle>
+
+namespace {
+
+static const char *kRowMimeType = "application/x-simplepresenter-playlist-row";
+
+} // namespace
+
+PlaylistModel::PlaylistModel(PlaylistManager *manager, QObject *parent)
+    : QAbstractListModel(parent)
+    , manager(manager)
+{
+    QStyle *style = QApplication::style();
+    iconByKind.insert("bible", style->standardIcon(QStyle::SP_FileDialogContentsView));
+    iconByKind.insert("song", style->standardIcon(QStyle::SP_MediaPlay));
+    iconByKind.insert("video", style->standardIcon(QStyle::SP_FileDialogDetailedView));
+    iconByKind.insert("image", style->standardIcon(QStyle::SP_FileIcon));
+    iconByKind.insert("youtube", QIcon(":/icons/youtube_logo.png"));
+
+    connect(manager, &PlaylistManager::itemAdded, this, &PlaylistModel::onItemAdded);
+    connect(manager, &PlaylistManager::itemRemoved, this, &PlaylistModel::onItemRemoved);
+    connect(manager, &PlaylistManager::itemMoved, this, &PlaylistModel::onItemMoved);
+    connect(manager, &PlaylistManager::itemUpdated, this, &PlaylistModel::onItemUpdated);
+    connect(manager, &PlaylistManager::playlistReset, this, &PlaylistModel::onPlaylistReset);
+    onPlaylistReset();
+}
+
+QString PlaylistModel::kindOf(const PlaylistItem &item)
+{
+    switch (item.type) {
+    case PlaylistItemType::BibleVerse:
+        return QStringLiteral("bible");
+    case PlaylistItemType::Song:
+        return QStringLiteral("song");
+    case PlaylistItemType::Media:
+        return item.data.value("isVideo").toBool() ? QStringLiteral("video") : QStringLiteral("image");
+    case PlaylistItemType::YouTube:
+        return QStringLiteral("youtube");
+    }
+    return QString();
+}
+
+PlaylistModel::Row PlaylistModel::makeRow(const PlaylistItem &item) const
+{
+    Row row;
+    row.kind = kindOf(item);
+    if (item.type == PlaylistItemType::BibleVerse) {
+        row.text = QString("📖 %1").arg(item.displayText());
+    } else if (item.type == PlaylistItemType::Song) {
+        row.text = QString("🎵 %1").arg(item.displayText());
+    } else if (item.type == PlaylistItemType::Media) {
+        row.text = QString("🖼️ %1").arg(item.displayText());
+    } else if (item.type == PlaylistItemType::YouTube) {
+        row.text = QString("▶️ %1").arg(item.displayText());
+    } else {
+        row.text = item.displayText();
+    }
+    return row;
+}
+
+int PlaylistModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant PlaylistModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+
+    const Row &row = rows[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+        return row.text;
+    case Qt::DecorationRole:
+        return iconByKind.value(row.kind);
+    case Qt::BackgroundRole:
+        return row.background.isValid() ? QVariant(row.background) : QVariant();
+    case KindRole:
+        return row.kind;
+    default:
+        return QVariant();
+    }
+}
+
+bool PlaylistModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (role != Qt::BackgroundRole || !index.isValid() || index.row() >= rows.size()) {
+        return false;
+    }
+    rows[index.row()].background = value.value<QColor>();
+    emit dataChanged(index, index, {Qt::BackgroundRole});
+    return true;
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        // Dropping between rows
+        return Qt::ItemIsDropEnabled;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled;
+}
+
+Qt::DropActions PlaylistModel::supportedDropActions() const
+{
+    return Qt::MoveAction;
+}
+
+QStringList PlaylistModel::mimeTypes() const
+{
+    return QStringList() << QString::fromLatin1(kRowMimeType);
+}
+
+QMimeData *PlaylistModel::mimeData(const QModelIndexList &indexes) const
+{
+    if (indexes.isEmpty()) {
+        return nullptr;
+    }
+    QMimeData *mime = new QMimeData;
+    mime->setData(QString::fromLatin1(kRowMimeType), QByteArray::number(indexes.first().row()));
+    return mime;
+}
+
+bool PlaylistModel::dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column,
+                                 const QModelIndex &parent)
+{
+    Q_UNUSED(column);
+    if (action != Qt::MoveAction || !data || !data->hasFormat(QString::fromLatin1(kRowMimeType))) {
+        return false;
+    }
+
+    bool ok = false;
+    const int from = data->data(QString::fromLatin1(kRowMimeType)).toInt(&ok);
+    if (!ok || from < 0 || from >= rows.size()) {
+        return false;
+    }
+
+    // row is the row to insert before; -1 means onto parent, or the end
+    int to = row;
+    if (to < 0) {
+        to = parent.isValid() ? parent.row() : rows.size();
+    }
+    if (to > from) {
+        --to;
+    }
+    to = qBound(0, to, rows.size() - 1);
+    manager->moveItem(from, to);
+
+    // The move is done through the manager; returning false keeps the view
+    // from also removing the dragged row
+    return false;
+}
+
+void PlaylistModel::onItemAdded(int index)
+{
+    beginInsertRows(QModelIndex(), index, index);
+    rows.insert(index, makeRow(manager->getItem(index)));
+    endInsertRows();
+}
+
+void PlaylistModel::onItemRemoved(int index)
+{
+    if (index < 0 || index >= rows.size()) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), index, index);
+    rows.remove(index);
+    endRemoveRows();
+}
+
+void PlaylistModel::onItemMoved(int fromIndex, int toIndex)
+{
+    // Qt counts the destination before the move, so moving down lands
+    // before toIndex + 1
+    const int destination = toIndex > fromIndex ? toIndex + 1 : toIndex;
+    if (!beginMoveRows(QModelIndex(), fromIndex, fromIndex, QModelIndex(), destination)) {
+        return;
+    }
+    rows.move(fromIndex, toIndex);
+    endMoveRows();
+}
+
+void PlaylistModel::onItemUpdated(int index)
+{
+    if (index < 0 || index >= rows.size()) {
+        return;
+    }
+    const QColor background = rows[index].background;
+    rows[index] = makeRow(manager->getItem(index));
+    rows[index].background = background;
+    const QModelIndex changed = this->index(index);
+    emit dataChanged(changed, changed);
+}
+
+void PlaylistModel::onPlaylistReset()
+{
+    beginResetModel();
+    const QVector<PlaylistItem> &items = manager->getItems();
+    rows.clear();
+    rows.reserve(items.size());
+    for (const PlaylistItem &item : items) {
+        rows.append(makeRow(item));
+    }
+    endResetModel();
+}
@@ -0,0 +1,61 @@
+#ifndef PLAYLISTMODEL_H
+#define PLAYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QColor>
+#include <QHash>
+#include <QIcon>
+#include <QVector>
+#include "PlaylistManager.h"
+
+// List model over a PlaylistManager. It follows the manager edit by edit,
+// so adding, removing or moving an item touches one row instead of
+// rebuilding the list. Row text and kind are worked out once per item.
+//
+// KindRole ("bible", "song", "video", "image", "youtube") is what the
+// playlist filter matches on. Rows can be dragged to reorder the playlist.
+class PlaylistModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        KindRole = Qt::UserRole + 1
+    };
+
+    explicit PlaylistModel(PlaylistManager *manager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    // Only Qt::BackgroundRole, used to flash a row
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    Qt::DropActions supportedDropActions() const override;
+    QStringList mimeTypes() const override;
+    QMimeData *mimeData(const QModelIndexList &indexes) const override;
+    bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column,
+                      const QModelIndex &parent) override;
+
+    static QString kindOf(const PlaylistItem &item);
+
+private:
+    struct Row {
+        QString text;
+        QString kind;
+        QColor background;
+    };
+
+    Row makeRow(const PlaylistItem &item) const;
+    void onItemAdded(int index);
+    void onItemRemoved(int index);
+    void onItemMoved(int fromIndex, int toIndex);
+    void onItemUpdated(int index);
+    void onPlaylistReset();
+
+    PlaylistManager *manager;
+    QVector<Row> rows;
+    QHash<QString, QIcon> iconByKind;
+};
+
+#endif // PLAYLISTMODEL_H
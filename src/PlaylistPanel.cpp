@@ -1,18 +1,38 @@
 #include "PlaylistPanel.h"
+#include "PlaylistModel.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QInputDialog>
 #include <QMessageBox>
-#include <QStyle>
 #include <QTimer>
+#include <QJsonArray>
+
+namespace {
+
+// Filter combo entries, matched against PlaylistModel::KindRole
+static const char *const kFilterPatterns[] = {
+    "",                  // All
+    "^bible$",           // Bible
+    "^song$",            // Songs
+    "^(video|image)$",   // Media
+    "^video$",           // Videos
+    "^image$",           // Photos
+    "^youtube$"          // YouTube
+};
+
+} // namespace
 
 PlaylistPanel::PlaylistPanel(QWidget *parent)
     : QWidget(parent)
     , playlistManager(new PlaylistManager(this))
+    , playlistModel(new PlaylistModel(playlistManager, this))
+    , filterModel(new QSortFilterProxyModel(this))
     , filterCombo(nullptr)
-    , currentFilter(FilterMode::All)
 {
+    filterModel->setSourceModel(playlistModel);
+    filterModel->setFilterRole(PlaylistModel::KindRole);
+
     setupUI();
     
     connect(playlistManager, &PlaylistManager::playlistChanged,
@@ -50,7 +70,9 @@ void PlaylistPanel::setupUI()
     mainLayout->addLayout(filterLayout);
     
     // Playlist list
-    playlistList = new QListWidget();
+    playlistList = new QListView();
+    playlistList->setModel(filterModel);
+    playlistList->setUniformItemSizes(true);
     playlistList->setDragDropMode(QAbstractItemView::InternalMove);  // Allow rearranging within playlist
     playlistList->setAcceptDrops(true);
     playlistList->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -72,14 +94,10 @@ void PlaylistPanel::setupUI()
     mainLayout->addLayout(controlLayout);
     
     // Connect signals
-    connect(playlistList, &QListWidget::itemDoubleClicked,
+    connect(playlistList, &QListView::doubleClicked,
             this, &PlaylistPanel::onItemDoubleClicked);
-    connect(playlistList, &QListWidget::itemSelectionChanged, [this]() {
-        bool hasSelection = playlistList->currentRow() >= 0;
-        removeButton->setEnabled(hasSelection);
-        moveUpButton->setEnabled(hasSelection && playlistList->currentRow() > 0);
-        moveDownButton->setEnabled(hasSelection && playlistList->currentRow() < playlistList->count() - 1);
-    });
+    connect(playlistList->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &PlaylistPanel::updateButtons);
     
     connect(removeButton, &QPushButton::clicked,
             this, &PlaylistPanel::onRemoveClicked);
@@ -91,17 +109,10 @@ void PlaylistPanel::setupUI()
     if (filterCombo) {
         connect(filterCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
                 this, [this](int index) {
-                    switch (index) {
-                    case 0: currentFilter = FilterMode::All; break;
-                    case 1: currentFilter = FilterMode::Bible; break;
-                    case 2: currentFilter = FilterMode::Songs; break;
-                    case 3: currentFilter = FilterMode::MediaAll; break;
-                    case 4: currentFilter = FilterMode::MediaVideos; break;
-                    case 5: currentFilter = FilterMode::MediaImages; break;
-                    case 6: currentFilter = FilterMode::YouTube; break;
-                    default: currentFilter = FilterMode::All; break;
-                    }
-                    refreshList();
+                    const int count = int(sizeof(kFilterPatterns) / sizeof(kFilterPatterns[0]));
+                    const char *pattern = index >= 0 && index < count ? kFilterPatterns[index] : "";
+                    filterModel->setFilterRegularExpression(QString::fromLatin1(pattern));
+                    updateButtons();
                 });
     }
 }
@@ -109,16 +120,11 @@ void PlaylistPanel::setupUI()
 void PlaylistPanel::clear()
 {
     playlistManager->clear();
-    refreshList();
 }
 
 bool PlaylistPanel::loadPlaylist(const QString &filePath)
 {
-    if (playlistManager->loadPlaylist(filePath)) {
-        refreshList();
-        return true;
-    }
-    return false;
+    return playlistManager->loadPlaylist(filePath);
 }
 
 bool PlaylistPanel::savePlaylist(const QString &filePath)
@@ -126,25 +132,50 @@ bool PlaylistPanel::savePlaylist(const QString &filePath)
     return playlistManager->savePlaylist(filePath);
 }
 
+QJsonObject PlaylistPanel::playlistData() const
+{
+    return playlistManager->toJson();
+}
+
+bool PlaylistPanel::loadPlaylistData(const QJsonObject &root)
+{
+    return playlistManager->loadFromJson(root);
+}
+
 bool PlaylistPanel::hasUnsavedChanges() const
 {
     return playlistManager->hasUnsavedChanges();
 }
 
-void PlaylistPanel::onItemDoubleClicked(QListWidgetItem *item)
+bool PlaylistPanel::recoverPlaylist(QString *playlistFile)
 {
-    if (!item) return;
+    return playlistManager->recoverFromJournal(playlistFile);
+}
+
+void PlaylistPanel::discardJournal()
+{
+    playlistManager->discardJournal();
+}
+
+void PlaylistPanel::onItemDoubleClicked(const QModelIndex &proxyIndex)
+{
+    if (!proxyIndex.isValid()) return;
     
-    int index = playlistList->row(item);
+    // Rows of a filtered list are not playlist indexes
+    int index = filterModel->mapToSource(proxyIndex).row();
     emit itemActivated(index);
     
     // Emit specific signals based on item type
     PlaylistItem playlistItem = playlistManager->getItem(index);
     
     if (playlistItem.type == PlaylistItemType::BibleVerse) {
-        emit bibleVerseActivated(playlistItem.reference);
+        // Items from a service bundle carry the text they were prepared with
+        const QJsonArray verses = playlistItem.data.value("verses").toArray();
+        const QString bundledText = verses.isEmpty() ? QString() : verses.first().toObject().value("text").toString();
+        emit bibleVerseActivated(playlistItem.reference, bundledText);
     } else if (playlistItem.type == PlaylistItemType::Song) {
-        emit songActivated(playlistItem.title);
+        emit songActivated(playlistItem.title, playlistItem.data.value("songId").toInt(),
+                           playlistItem.data.value("song").toObject());
     } else if (playlistItem.type == PlaylistItemType::Media) {
         const QString path = playlistItem.data.value("path").toString(playlistItem.reference);
         bool isVideo = playlistItem.data.value("isVideo").toBool();
@@ -173,7 +204,7 @@ void PlaylistPanel::addBibleVerse(const QString &reference)
     playlistManager->addItem(item);
 }
 
-void PlaylistPanel::addSong(const QString &songTitle, const QString &sectionText)
+void PlaylistPanel::addSong(const QString &songTitle, const QString &sectionText, int songId)
 {
     const QString sectionKey = sectionText.isEmpty() ? songTitle : sectionText;
     const QVector<PlaylistItem> &items = playlistManager->getItems();
@@ -191,6 +222,9 @@ void PlaylistPanel::addSong(const QString &songTitle, const QString &sectionText
     item.type = PlaylistItemType::Song;
     item.title = songTitle;
     item.reference = sectionKey;
+    if (songId > 0) {
+        item.data["songId"] = songId;
+    }
     playlistManager->addItem(item);
 }
 
@@ -242,65 +276,74 @@ void PlaylistPanel::addYouTube(const QString &url, const QString &title)
 
 void PlaylistPanel::onRemoveClicked()
 {
-    int currentRow = playlistList->currentRow();
-    if (currentRow >= 0) {
-        playlistManager->removeItem(currentRow);
+    int index = currentItemIndex();
+    if (index >= 0) {
+        playlistManager->removeItem(index);
     }
 }
 
 void PlaylistPanel::onMoveUpClicked()
 {
-    int currentRow = playlistList->currentRow();
+    // Swap with the row shown above, which under a filter need not be the
+    // playlist item just before
+    int currentRow = playlistList->currentIndex().row();
     if (currentRow > 0) {
-        playlistManager->moveItem(currentRow, currentRow - 1);
-        playlistList->setCurrentRow(currentRow - 1);
+        int from = currentItemIndex();
+        int to = filterModel->mapToSource(filterModel->index(currentRow - 1, 0)).row();
+        playlistManager->moveItem(from, to);
+        playlistList->setCurrentIndex(filterModel->mapFromSource(playlistModel->index(to)));
     }
 }
 
 void PlaylistPanel::onMoveDownClicked()
 {
-    int currentRow = playlistList->currentRow();
-    if (currentRow >= 0 && currentRow < playlistList->count() - 1) {
-        playlistManager->moveItem(currentRow, currentRow + 1);
-        playlistList->setCurrentRow(currentRow + 1);
+    int currentRow = playlistList->currentIndex().row();
+    if (currentRow >= 0 && currentRow < filterModel->rowCount() - 1) {
+        int from = currentItemIndex();
+        int to = filterModel->mapToSource(filterModel->index(currentRow + 1, 0)).row();
+        playlistManager->moveItem(from, to);
+        playlistList->setCurrentIndex(filterModel->mapFromSource(playlistModel->index(to)));
     }
 }
 
 void PlaylistPanel::onPlaylistChanged()
 {
-    refreshList();
+    // The model follows the manager itself; only the buttons depend on
+    // where the selection ended up
+    updateButtons();
+}
+
+void PlaylistPanel::updateButtons()
+{
+    int currentRow = playlistList->currentIndex().row();
+    bool hasSelection = currentRow >= 0;
+    removeButton->setEnabled(hasSelection);
+    moveUpButton->setEnabled(hasSelection && currentRow > 0);
+    moveDownButton->setEnabled(hasSelection && currentRow < filterModel->rowCount() - 1);
+}
+
+int PlaylistPanel::currentItemIndex() const
+{
+    const QModelIndex current = playlistList->currentIndex();
+    return current.isValid() ? filterModel->mapToSource(current).row() : -1;
 }
 
 int PlaylistPanel::rowForItemIndex(int itemIndex) const
 {
-    if (!playlistManager) {
+    if (itemIndex < 0 || itemIndex >= playlistModel->rowCount()) {
         return -1;
     }
-    const QVector<PlaylistItem> &items = playlistManager->getItems();
-    if (itemIndex < 0 || itemIndex >= items.size()) {
-        return -1;
-    }
-
-    int row = -1;
-    for (int i = 0; i < items.size(); ++i) {
-        if (!matchesFilter(items[i])) {
-            continue;
-        }
-        ++row;
-        if (i == itemIndex) {
-            return row;
-        }
-    }
-    return -1;
+    return filterModel->mapFromSource(playlistModel->index(itemIndex)).row();
 }
 
-void PlaylistPanel::flashRow(int row)
+void PlaylistPanel::flashItem(int itemIndex)
 {
-    if (!playlistList || row < 0 || row >= playlistList->count()) {
+    if (itemIndex < 0 || itemIndex >= playlistModel->rowCount()) {
         return;
     }
 
-    const QColor baseColor = playlistList->palette().color(QPalette::Base);
+    // Follows the item if the playlist changes while it flashes
+    const QPersistentModelIndex item(playlistModel->index(itemIndex));
     // Use a strong bright orange highlight so it is very visible.
     const QColor highlightColor = QColor(255, 165, 0);
 
@@ -310,27 +353,19 @@ void PlaylistPanel::flashRow(int row)
 
     for (int i = 0; i < flashCount * 2; ++i) {
         QTimer::singleShot(i * intervalMs, this,
-                           [this, row, baseColor, highlightColor, i]() {
-            if (!playlistList || row < 0 || row >= playlistList->count()) {
-                return;
-            }
-            QListWidgetItem *item = playlistList->item(row);
-            if (!item) {
+                           [this, item, highlightColor, i]() {
+            if (!item.isValid()) {
                 return;
             }
             const bool on = (i % 2 == 0);
-            item->setBackground(on ? highlightColor : baseColor);
+            playlistModel->setData(item, on ? highlightColor : QColor(), Qt::BackgroundRole);
         });
     }
 
     QTimer::singleShot(flashCount * 2 * intervalMs + 10, this,
-                       [this, row, baseColor]() {
-        if (!playlistList || row < 0 || row >= playlistList->count()) {
-            return;
-        }
-        QListWidgetItem *item = playlistList->item(row);
-        if (item) {
-            item->setBackground(baseColor);
+                       [this, item]() {
+        if (item.isValid()) {
+            playlistModel->setData(item, QColor(), Qt::BackgroundRole);
         }
     });
 }
@@ -372,68 +407,6 @@ void PlaylistPanel::highlightExistingItem(int itemIndex)
     if (row < 0) {
         return;
     }
-    if (playlistList) {
-        if (QListWidgetItem *item = playlistList->item(row)) {
-            playlistList->scrollToItem(item, QAbstractItemView::PositionAtCenter);
-        }
-    }
-    flashRow(row);
-}
-
-bool PlaylistPanel::matchesFilter(const PlaylistItem &item) const
-{
-    switch (currentFilter) {
-    case FilterMode::All:
-        return true;
-    case FilterMode::Bible:
-        return item.type == PlaylistItemType::BibleVerse;
-    case FilterMode::Songs:
-        return item.type == PlaylistItemType::Song;
-    case FilterMode::MediaAll:
-        return item.type == PlaylistItemType::Media;
-    case FilterMode::MediaVideos:
-        return item.type == PlaylistItemType::Media && item.data.value("isVideo").toBool();
-    case FilterMode::MediaImages:
-        return item.type == PlaylistItemType::Media && !item.data.value("isVideo").toBool();
-    case FilterMode::YouTube:
-        return item.type == PlaylistItemType::YouTube;
-    }
-    return true;
-}
-
-void PlaylistPanel::refreshList()
-{
-    playlistList->clear();
-    
-    const QVector<PlaylistItem> &items = playlistManager->getItems();
-    QStyle *style = this->style();
-    for (const PlaylistItem &item : items) {
-        if (!matchesFilter(item)) {
-            continue;
-        }
-        QString displayText;
-        QIcon icon;
-        
-        if (item.type == PlaylistItemType::BibleVerse) {
-            displayText = QString("📖 %1").arg(item.displayText());
-            icon = style->standardIcon(QStyle::SP_FileDialogContentsView);
-        } else if (item.type == PlaylistItemType::Song) {
-            displayText = QString("🎵 %1").arg(item.displayText());
-            icon = style->standardIcon(QStyle::SP_MediaPlay);
-        } else if (item.type == PlaylistItemType::Media) {
-            bool isVideo = item.data.value("isVideo").toBool();
-            displayText = QString("🖼️ %1").arg(item.displayText());
-            icon = isVideo ? style->standardIcon(QStyle::SP_FileDialogDetailedView)
-                           : style->standardIcon(QStyle::SP_FileIcon);
-        } else if (item.type == PlaylistItemType::YouTube) {
-            displayText = QString("▶️ %1").arg(item.displayText());
-            icon = QIcon(":/icons/youtube_logo.png");
-        } else {
-            displayText = item.displayText();
-            icon = style->standardIcon(QStyle::SP_FileIcon);
-        }
-        
-        QListWidgetItem *listItem = new QListWidgetItem(icon, displayText);
-        playlistList->addItem(listItem);
-    }
+    playlistList->scrollTo(filterModel->index(row, 0), QAbstractItemView::PositionAtCenter);
+    flashItem(itemIndex);
 }
@@ -2,11 +2,14 @@
 #define PLAYLISTPANEL_H
 
 #include <QWidget>
-#include <QListWidget>
+#include <QListView>
 #include <QPushButton>
 #include <QComboBox>
+#include <QSortFilterProxyModel>
 #include "PlaylistManager.h"
 
+class PlaylistModel;
+
 class PlaylistPanel : public QWidget
 {
     Q_OBJECT
@@ -19,54 +22,53 @@ public:
     void clear();
     bool loadPlaylist(const QString &filePath);
     bool savePlaylist(const QString &filePath);
+    QJsonObject playlistData() const;
+    bool loadPlaylistData(const QJsonObject &root);
     bool hasUnsavedChanges() const;
+    bool recoverPlaylist(QString *playlistFile);
+    void discardJournal();
     
     // Add items to playlist
     void addBibleVerse(const QString &reference);
-    void addSong(const QString &songTitle, const QString &sectionText = QString());
+    void addSong(const QString &songTitle, const QString &sectionText = QString(), int songId = 0);
     void addMedia(const QString &displayName, const QString &path, bool isVideo);
     void addYouTube(const QString &url, const QString &title = QString());
 
 signals:
     void itemActivated(int index);
-    void bibleVerseActivated(const QString &reference);
-    void songActivated(const QString &songTitle);
+    // bundledText: the verse text resolved when the service was bundled,
+    // empty for ordinary playlists
+    void bibleVerseActivated(const QString &reference, const QString &bundledText);
+    // bundledSong: the whole song as bundled, empty for ordinary playlists
+    void songActivated(const QString &songTitle, int songId, const QJsonObject &bundledSong);
     void mediaActivated(const QString &path, bool isVideo);
     void youtubeActivated(const QString &url);
 
 private slots:
-    void onItemDoubleClicked(QListWidgetItem *item);
+    void onItemDoubleClicked(const QModelIndex &index);
     void onRemoveClicked();
     void onMoveUpClicked();
     void onMoveDownClicked();
     void onPlaylistChanged();
 
 private:
-    enum class FilterMode {
-        All,
-        Bible,
-        Songs,
-        MediaAll,
-        MediaVideos,
-        MediaImages,
-        YouTube
-    };
-
     void setupUI();
-    void refreshList();
-    bool matchesFilter(const PlaylistItem &item) const;
+    void updateButtons();
+    // Playlist index of the selected row, or -1
+    int currentItemIndex() const;
     int rowForItemIndex(int itemIndex) const;
-    void flashRow(int row);
+    void flashItem(int itemIndex);
     void highlightExistingItem(int itemIndex);
     
     PlaylistManager *playlistManager;
+    PlaylistModel *playlistModel;
+    QSortFilterProxyModel *filterModel;
     
-    QListWidget *playlistList;
+    QListView *playlistList;
     QPushButton *removeButton;
     QPushButton *moveUpButton;
     QPushButton *moveDownButton;
     QComboBox *filterCombo;
-    FilterMode currentFilter;
 };
 
 #endif // PLAYLISTPANEL_H
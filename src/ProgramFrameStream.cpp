@@ -0,0 +1,124 @@
+#include "ProgramFrameStream.h"
+#include "CanvasWidget.h"
+#include "OverlayServer.h"
+#include <QTimer>
+#include <QImage>
+#include <QBuffer>
+#include <QSettings>
+#include <QHash>
+#include <QtConcurrent>
+
+namespace {
+
+// The canvas is checked at least this often even if it never repainted,
+// e.g. while the main window is minimised
+constexpr qint64 kRecheckIntervalMs = 1000;
+
+} // namespace
+
+ProgramFrameStream::ProgramFrameStream(CanvasWidget *canvas, OverlayServer *server, QObject *parent)
+    : QObject(parent)
+    , canvas(canvas)
+    , server(server)
+    , timer(new QTimer(this))
+    , frameSize(1280, 720)
+    , maxFps(15)
+    , quality(80)
+    , lastSerial(0)
+    , lastHash(0)
+{
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &ProgramFrameStream::captureFrame);
+    connect(server, &OverlayServer::programStreamDemandChanged, this, &ProgramFrameStream::setActive);
+
+    connect(&encoder, &QFutureWatcher<Encoded>::finished, this, [this]() {
+        const Encoded encoded = encoder.result();
+        lastHash = encoded.hash;
+        if (!encoded.jpeg.isEmpty()) {
+            this->server->publishProgramFrame(encoded.jpeg);
+        }
+    });
+
+    loadSettings();
+}
+
+ProgramFrameStream::~ProgramFrameStream()
+{
+    encoder.waitForFinished();
+}
+
+void ProgramFrameStream::loadSettings()
+{
+    QSettings settings("SimplePresenter", "SimplePresenter");
+    settings.beginGroup("OBSOverlay");
+    frameSize = QSize(settings.value("programStreamWidth", 1280).toInt(),
+                      settings.value("programStreamHeight", 720).toInt());
+    if (frameSize.isEmpty()) {
+        frameSize = QSize(1280, 720);
+    }
+    maxFps = qBound(1, settings.value("programStreamFps", 15).toInt(), 60);
+    quality = qBound(10, settings.value("programStreamQuality", 80).toInt(), 100);
+    settings.endGroup();
+
+    timer->setInterval(1000 / maxFps);
+    // A new size or quality must reach clients even if the picture is still
+    lastHash = 0;
+}
+
+void ProgramFrameStream::setActive(bool active)
+{
+    if (active) {
+        lastSerial = 0;
+        lastHash = 0;
+        timer->start();
+        captureFrame();
+    } else {
+        timer->stop();
+    }
+}
+
+void ProgramFrameStream::captureFrame()
+{
+    // Still busy with the previous frame: drop this tick rather than queue
+    if (!canvas || encoder.isRunning()) {
+        return;
+    }
+
+    const quint64 serial = canvas->frameSerial();
+    if (serial == lastSerial && sinceLastFrame.isValid() && sinceLastFrame.elapsed() < kRecheckIntervalMs) {
+        return;
+    }
+    lastSerial = serial;
+    sinceLastFrame.start();
+
+    // Rendering has to happen here; scaling, comparing and encoding do not
+    const QImage frame = canvas->getFrame();
+    const QSize size = frameSize;
+    const int jpegQuality = quality;
+    const size_t previousHash = lastHash;
+    encoder.setFuture(QtConcurrent::run([frame, size, jpegQuality, previousHash]() {
+        return encodeFrame(frame, size, jpegQuality, previousHash);
+    }));
+}
+
+ProgramFrameStream::Encoded ProgramFrameStream::encodeFrame(const QImage &frame, const QSize &size, int quality,
+                                                            size_t previousHash)
+{
+    Encoded encoded;
+    QImage scaled = frame.size() == size
+        ? frame
+        : frame.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    scaled = scaled.convertToFormat(QImage::Format_RGB32);
+
+    encoded.hash = qHashBits(scaled.constBits(), static_cast<size_t>(scaled.sizeInBytes()));
+    if (encoded.hash == previousHash) {
+        return encoded;
+    }
+
+    // Qt's JPEG plugin is built on libjpeg-turbo, whose colour conversion
+    // and DCT are SIMD-accelerated
+    QBuffer buffer(&encoded.jpeg);
+    buffer.open(QIODevice::WriteOnly);
+    scaled.save(&buffer, "JPG", quality);
+    return encoded;
+}
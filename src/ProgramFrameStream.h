@@ -0,0 +1,59 @@
+#ifndef PROGRAMFRAMESTREAM_H
+#define PROGRAMFRAMESTREAM_H
+
+#include <QObject>
+#include <QSize>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
+class CanvasWidget;
+class OverlayServer;
+class QTimer;
+
+// Feeds the composited program output of a canvas to OverlayServer as
+// JPEG frames for /program.mjpg and the ws://…:8081/program socket, so
+// capture clients get exactly what the projector shows.
+//
+// Only runs while someone is watching. Frames are grabbed at most at the
+// configured rate and only when the canvas repainted (or once a second
+// in case it could not), then scaled, compared with the last frame and
+// JPEG-encoded on a worker thread; unchanged frames are dropped. Every
+// client shares the one encode.
+class ProgramFrameStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    ProgramFrameStream(CanvasWidget *canvas, OverlayServer *server, QObject *parent = nullptr);
+    ~ProgramFrameStream();
+
+    void loadSettings();
+
+private slots:
+    void setActive(bool active);
+    void captureFrame();
+
+private:
+    struct Encoded {
+        QByteArray jpeg; // empty when the frame had not changed
+        size_t hash = 0;
+    };
+
+    static Encoded encodeFrame(const QImage &frame, const QSize &size, int quality, size_t previousHash);
+
+    CanvasWidget *canvas;
+    OverlayServer *server;
+    QTimer *timer;
+
+    QSize frameSize;
+    int maxFps;
+    int quality;
+
+    quint64 lastSerial;
+    QElapsedTimer sinceLastFrame;
+    size_t lastHash;
+    QFutureWatcher<Encoded> encoder;
+};
+
+#endif // PROGRAMFRAMESTREAM_H
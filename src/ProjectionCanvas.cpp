@@ -9,6 +9,7 @@
 #include <QWebEngineSettings>
 #include <QWebEnginePage>
 #include <QRegularExpression>
+#include "YouTubeBridge.h"
 #include <QVariant>
 #endif
 #include <QUrl>
@@ -25,6 +26,7 @@ ProjectionCanvas::ProjectionCanvas(QWidget *parent)
     , nextImageFade(false)
 #ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
     , youtubePlayer(nullptr)
+    , youtubeBridge(new YouTubeBridge(this))
 #endif
 {
     loadSettings(false);
@@ -109,6 +111,7 @@ void ProjectionCanvas::showBibleVerse(const QString &reference, const QString &t
     if (youtubePlayer) {
         youtubePlayer->hide();
         youtubePlayer->stop();
+        youtubeBridge->reset();
         youtubePlayer->setHtml(QStringLiteral("<html><body style=\"margin:0;background:black;\"></body></html>"),
                                QUrl(QStringLiteral("http://localhost/")));
     }
@@ -126,6 +129,7 @@ void ProjectionCanvas::showLyrics(const QString &songTitle, const QString &lyric
     if (youtubePlayer) {
         youtubePlayer->hide();
         youtubePlayer->stop();
+        youtubeBridge->reset();
         youtubePlayer->setHtml(QStringLiteral("<html><body style=\"margin:0;background:black;\"></body></html>"),
                                QUrl(QStringLiteral("http://localhost/")));
     }
@@ -290,6 +294,7 @@ void ProjectionCanvas::showMedia(const QString &path, bool isVideo)
     if (youtubePlayer) {
         youtubePlayer->hide();
         youtubePlayer->stop();
+        youtubeBridge->reset();
         youtubePlayer->setHtml(QStringLiteral("<html><body style=\"margin:0;background:black;\"></body></html>"),
                                QUrl(QStringLiteral("http://localhost/")));
     }
@@ -327,6 +332,7 @@ void ProjectionCanvas::applyStoredBackground()
     if (youtubePlayer) {
         youtubePlayer->hide();
         youtubePlayer->stop();
+        youtubeBridge->reset();
         youtubePlayer->setHtml(QStringLiteral("<html><body style=\"margin:0;background:black;\"></body></html>"),
                                QUrl(QStringLiteral("http://localhost/")));
     }
@@ -757,6 +763,8 @@ void ProjectionCanvas::showYouTubeVideo(const QString &url)
     youtubePlayer->setStyleSheet("background: black;");
     youtubePlayer->setAttribute(Qt::WA_TransparentForMouseEvents, true);
     youtubePlayer->setFocusPolicy(Qt::NoFocus);
+    youtubeBridge->reset();
+    youtubeBridge->attach(youtubePlayer->page());
 
     storeCurrentBackground();
     mediaOverrideActive = true;
@@ -784,9 +792,28 @@ void ProjectionCanvas::showYouTubeVideo(const QString &url)
             "frameborder=\"0\" allow=\"accelerometer; autoplay; clipboard-write; encrypted-media; gyroscope; picture-in-picture; web-share\" allowfullscreen></iframe>"
             "<script>"
             "var spPlayer=null;"
+            "var spBridge=null;"
+            "var spTimeTimer=null;"
+            // Report state changes, and the position while playing, to YouTubeBridge
+            "function spReport(){"
+            "  try {"
+            "    if(!spBridge||!spPlayer||typeof spPlayer.getPlayerState!=='function') return;"
+            "    var s=spPlayer.getPlayerState();"
+            "    spBridge.playerStateChanged(s,spPlayer.getCurrentTime()||0,spPlayer.getDuration()||0);"
+            "    if(spTimeTimer){ clearInterval(spTimeTimer); spTimeTimer=null; }"
+            "    if(s===1){"
+            "      spTimeTimer=setInterval(function(){"
+            "        try { spBridge.timeUpdated(spPlayer.getCurrentTime()||0,spPlayer.getDuration()||0); } catch(e) {}"
+            "      },250);"
+            "    }"
+            "  } catch(e) { console.error('spReport failed',e); }"
+            "}"
+            "if(window.qt&&qt.webChannelTransport&&typeof QWebChannel!=='undefined'){"
+            "  new QWebChannel(qt.webChannelTransport,function(c){ spBridge=c.objects.spBridge; spReport(); });"
+            "}"
             "function onYouTubeIframeAPIReady(){"
             "  try {"
-            "    spPlayer=new YT.Player('player');"
+            "    spPlayer=new YT.Player('player',{events:{'onReady':spReport,'onStateChange':spReport}});"
             "  } catch(e) { console.error('YouTube API init failed',e); }"
             "}"
             "function spSeekToRatio(r){"
@@ -812,16 +839,6 @@ void ProjectionCanvas::showYouTubeVideo(const QString &url)
             "    spPlayer.setVolume(level);"
             "  } catch(e) { console.error('spSetVolume failed',e); }"
             "}"
-            "function spGetPositionRatio(){"
-            "  try {"
-            "    if(!spPlayer||typeof spPlayer.getDuration!=='function'||typeof spPlayer.getCurrentTime!=='function') return -1;"
-            "    var d=spPlayer.getDuration();"
-            "    if(!d||d<=0) return -1;"
-            "    var t=spPlayer.getCurrentTime();"
-            "    if(t<0) t=0;"
-            "    return t/d;"
-            "  } catch(e) { console.error('spGetPositionRatio failed',e); return -1; }"
-            "}"
             "</script>"
             "</body></html>"
         ).arg(videoId).arg(startSeconds);
@@ -866,39 +883,6 @@ void ProjectionCanvas::seekYouTubeByRatio(double ratio)
     }
 }
 
-void ProjectionCanvas::queryYouTubePositionRatio(const std::function<void(double)> &callback)
-{
-    if (!youtubePlayer || !callback) {
-        return;
-    }
-
-    if (QWebEnginePage *page = youtubePlayer->page()) {
-        const QString js = QStringLiteral(
-            "(function(){"
-            "  try {"
-            "    if (typeof spGetPositionRatio !== 'function') return -1;"
-            "    return spGetPositionRatio();"
-            "  } catch (e) { console.error('queryYouTubePositionRatio failed', e); return -1; }"
-            "})();"
-        );
-
-        page->runJavaScript(js, [callback](const QVariant &result) {
-            bool ok = false;
-            double ratio = result.toDouble(&ok);
-            if (!ok || ratio < 0.0) {
-                callback(-1.0);
-                return;
-            }
-            if (ratio < 0.0) {
-                ratio = 0.0;
-            } else if (ratio > 1.0) {
-                ratio = 1.0;
-            }
-            callback(ratio);
-        });
-    }
-}
-
 void ProjectionCanvas::setYouTubeMuted(bool muted)
 {
     if (!youtubePlayer) {
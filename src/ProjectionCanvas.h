@@ -10,11 +10,11 @@
 #include <QTimer>
 #include <QMovie>
 #include <QGraphicsOpacityEffect>
-#include <functional>
 
 class QSettings;
 #ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
 class QWebEngineView;
+class YouTubeBridge;
 #endif
 
 class ProjectionCanvas : public CanvasWidget
@@ -36,7 +36,8 @@ public:
     void playPauseYouTube(bool play);
     void setYouTubeVolume(double volume01);
     void setYouTubeMuted(bool muted);
-    void queryYouTubePositionRatio(const std::function<void(double)> &callback);
+    // Position and play state events from the YouTube player
+    YouTubeBridge *youTubeBridge() const { return youtubeBridge; }
 #endif
     void setNextImageFade(bool enabled);
 
@@ -119,6 +120,7 @@ private:
     bool nextImageFade;
 #ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
     QWebEngineView *youtubePlayer;
+    YouTubeBridge *youtubeBridge;
 #endif
 };
 
@@ -0,0 +1,285 @@
+#include "ScriptureReference.h"
+#include "BookNameTrie.h"
+
+namespace {
+
+struct OrdinalWord {
+    const char *word;
+    int value;
+};
+
+// Longer roman numerals first so "iii" is not taken as "i"
+static const OrdinalWord kOrdinalWords[] = {
+    { "first", 1 }, { "second", 2 }, { "third", 3 },
+    { "1st", 1 }, { "2nd", 2 }, { "3rd", 3 },
+    { "iii", 3 }, { "ii", 2 }, { "i", 1 }
+};
+
+// Book numbers and chapter/verse numbers never get near this; it only keeps
+// a pasted run of digits from overflowing.
+static const int kMaxNumber = 9999;
+
+bool isRangeDash(QChar ch)
+{
+    return ch == QLatin1Char('-') || ch == QChar(0x2013) || ch == QChar(0x2014);
+}
+
+bool isChapterVerseSeparator(QChar ch)
+{
+    return ch == QLatin1Char(':') || ch == QLatin1Char('.');
+}
+
+int skipSpaces(QStringView text, int pos)
+{
+    while (pos < text.size() && text[pos].isSpace()) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Reads ASCII digits at pos. Returns the position after them, which equals
+// pos when there is no number there.
+int readNumber(QStringView text, int pos, int *value)
+{
+    int number = 0;
+    while (pos < text.size() && text[pos] >= QLatin1Char('0') && text[pos] <= QLatin1Char('9')) {
+        if (number <= kMaxNumber) {
+            number = number * 10 + (text[pos].unicode() - '0');
+        }
+        ++pos;
+    }
+    *value = number;
+    return pos;
+}
+
+// Matches "1st ", "Second ", "II " and so on. Returns the position after the
+// ordinal and its trailing whitespace, or -1.
+int matchOrdinal(QStringView text, int pos, int *value)
+{
+    for (const OrdinalWord &ordinal : kOrdinalWords) {
+        const QLatin1String word(ordinal.word);
+        const int end = pos + word.size();
+        if (end < text.size() && text[end].isSpace() &&
+            text.sliced(pos, word.size()).compare(word, Qt::CaseInsensitive) == 0) {
+            *value = ordinal.value;
+            return skipSpaces(text, end);
+        }
+    }
+    return -1;
+}
+
+bool appendSpan(ScriptureReference &result, const ScriptureSpan &span)
+{
+    if (span.endChapter < span.startChapter ||
+        (span.endChapter == span.startChapter && span.endVerse > 0 && span.endVerse < span.startVerse)) {
+        return false;
+    }
+    if (result.spanCount == 0) {
+        result.bookId = span.bookId;
+    }
+    if (result.spanCount < ScriptureReference::MaxSpans) {
+        result.spans[result.spanCount++] = span;
+    } else {
+        result.truncated = true;
+    }
+    return true;
+}
+
+bool finish(ScriptureReference &result, ScriptureReference::Status status)
+{
+    result.status = status;
+    return status == ScriptureReference::Complete || status == ScriptureReference::Incomplete;
+}
+
+} // namespace
+
+ScriptureReferenceParser::ScriptureReferenceParser(const BookNameTrie *bookNames)
+    : trie(bookNames)
+{
+}
+
+int ScriptureReferenceParser::matchBook(QStringView text, int pos, int *bookId) const
+{
+    if (!trie) {
+        return -1;
+    }
+
+    int ordinal = 0;
+    const int afterOrdinal = matchOrdinal(text, pos, &ordinal);
+    if (afterOrdinal > 0) {
+        const int end = matchBookFrom(text, afterOrdinal, ordinal, bookId);
+        if (end > 0) {
+            return end;
+        }
+    }
+    return matchBookFrom(text, pos, 0, bookId);
+}
+
+// Walks the trie as far as the text allows and keeps the longest prefix that
+// names a book and ends on a word boundary, so "Song of Solomon 2" is not cut
+// short at "Song" and "John 3" stops before the chapter.
+int ScriptureReferenceParser::matchBookFrom(QStringView text, int pos, int ordinal, int *bookId) const
+{
+    BookNameTrie::Cursor cursor = trie->cursor();
+    if (ordinal > 0) {
+        cursor.step(QLatin1Char(char('0' + ordinal)));
+        cursor.step(QLatin1Char(' '));
+    }
+
+    int bestEnd = -1;
+    for (int i = pos; i < text.size(); ++i) {
+        const QChar ch = text[i];
+        if (!cursor.step(ch)) {
+            break;
+        }
+        if (ch.isSpace()) {
+            continue;
+        }
+        if (i + 1 < text.size() && text[i + 1].isLetter()) {
+            continue;
+        }
+        int id = cursor.bookId();
+        if (id <= 0) {
+            id = cursor.uniqueBookId();
+        }
+        if (id > 0) {
+            bestEnd = i + 1;
+            *bookId = id;
+        }
+    }
+    return bestEnd;
+}
+
+bool ScriptureReferenceParser::parse(QStringView text, ScriptureReference &result) const
+{
+    result.status = ScriptureReference::Empty;
+    result.bookId = 0;
+    result.spanCount = 0;
+    result.truncated = false;
+
+    const int length = text.size();
+    int pos = skipSpaces(text, 0);
+    if (pos >= length) {
+        return false;
+    }
+
+    int bookId = 0;
+    int chapter = 0;
+    bool verseContext = false; // after "C:V", a bare number is another verse
+    bool bookAllowed = true;   // at the start and after ';'
+
+    while (pos < length) {
+        if (bookAllowed || text[pos].isLetter()) {
+            int matchedId = 0;
+            const int end = matchBook(text, pos, &matchedId);
+            if (end > 0) {
+                bookId = matchedId;
+                chapter = 0;
+                verseContext = false;
+                pos = skipSpaces(text, end);
+                if (result.spanCount == 0) {
+                    result.bookId = bookId;
+                }
+                if (pos >= length) {
+                    return finish(result, result.spanCount > 0 ? ScriptureReference::Incomplete
+                                                               : ScriptureReference::BookOnly);
+                }
+            } else if (bookId == 0 || text[pos].isLetter()) {
+                return finish(result, ScriptureReference::Invalid);
+            }
+        }
+        bookAllowed = false;
+
+        int first = 0;
+        int next = readNumber(text, pos, &first);
+        if (next == pos || first == 0) {
+            return finish(result, ScriptureReference::Invalid);
+        }
+        pos = next;
+
+        ScriptureSpan span;
+        span.bookId = bookId;
+        if (pos < length && isChapterVerseSeparator(text[pos])) {
+            chapter = first;
+            span.startChapter = span.endChapter = chapter;
+            int verse = 0;
+            next = readNumber(text, pos + 1, &verse);
+            if (next == pos + 1 || verse == 0) {
+                // "John 3:" - show the chapter while the verse is typed
+                if (pos + 1 < length || !appendSpan(result, span)) {
+                    return finish(result, ScriptureReference::Invalid);
+                }
+                return finish(result, ScriptureReference::Incomplete);
+            }
+            pos = next;
+            span.startVerse = span.endVerse = verse;
+            verseContext = true;
+        } else if (verseContext) {
+            span.startChapter = span.endChapter = chapter;
+            span.startVerse = span.endVerse = first;
+        } else {
+            chapter = first;
+            span.startChapter = span.endChapter = chapter;
+        }
+
+        pos = skipSpaces(text, pos);
+        if (pos < length && isRangeDash(text[pos])) {
+            pos = skipSpaces(text, pos + 1);
+            int end = 0;
+            next = readNumber(text, pos, &end);
+            if (next == pos || end == 0) {
+                if (pos < length || !appendSpan(result, span)) {
+                    return finish(result, ScriptureReference::Invalid);
+                }
+                return finish(result, ScriptureReference::Incomplete);
+            }
+            pos = next;
+
+            if (span.startVerse > 0 && pos < length && isChapterVerseSeparator(text[pos])) {
+                // "Gen 1:26-2:3"
+                int endVerse = 0;
+                next = readNumber(text, pos + 1, &endVerse);
+                span.endChapter = end;
+                chapter = end;
+                if (next == pos + 1 || endVerse == 0) {
+                    span.endVerse = 0;
+                    if (pos + 1 < length || !appendSpan(result, span)) {
+                        return finish(result, ScriptureReference::Invalid);
+                    }
+                    return finish(result, ScriptureReference::Incomplete);
+                }
+                span.endVerse = endVerse;
+                pos = next;
+            } else if (span.startVerse > 0) {
+                span.endVerse = end;
+            } else {
+                // "Ps 23-24"
+                span.endChapter = end;
+                chapter = end;
+            }
+            pos = skipSpaces(text, pos);
+        }
+
+        if (!appendSpan(result, span)) {
+            return finish(result, ScriptureReference::Invalid);
+        }
+        if (pos >= length) {
+            break;
+        }
+
+        if (text[pos] == QLatin1Char(',')) {
+            pos = skipSpaces(text, pos + 1);
+        } else if (text[pos] == QLatin1Char(';')) {
+            pos = skipSpaces(text, pos + 1);
+            verseContext = false;
+            bookAllowed = true;
+        } else {
+            return finish(result, ScriptureReference::Invalid);
+        }
+        if (pos >= length) {
+            return finish(result, ScriptureReference::Incomplete);
+        }
+    }
+
+    return finish(result, ScriptureReference::Complete);
+}
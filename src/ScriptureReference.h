@@ -0,0 +1,64 @@
+#ifndef SCRIPTUREREFERENCE_H
+#define SCRIPTUREREFERENCE_H
+
+#include <QStringView>
+
+class BookNameTrie;
+
+// One contiguous passage. A verse of 0 means the whole chapter boundary:
+// startVerse 0 starts at the top of startChapter, endVerse 0 runs to the
+// end of endChapter.
+struct ScriptureSpan {
+    int bookId = 0;
+    int startChapter = 0;
+    int startVerse = 0;
+    int endChapter = 0;
+    int endVerse = 0;
+
+    bool isSingleVerse() const {
+        return startChapter == endChapter && startVerse > 0 && startVerse == endVerse;
+    }
+};
+
+// Result of parsing a reference such as "John 3:16,18; 4:1-3". Spans live in
+// a fixed array so parsing never touches the heap.
+struct ScriptureReference {
+    enum Status {
+        Empty,      // nothing but whitespace
+        BookOnly,   // "John" - a book and no chapter yet
+        Incomplete, // "John 3:" or "Gen 1:26-" - the spans so far are usable
+        Complete,
+        Invalid
+    };
+
+    static constexpr int MaxSpans = 16;
+
+    Status status = Empty;
+    int bookId = 0;         // book of the first span, or the book typed so far
+    int spanCount = 0;
+    bool truncated = false; // more than MaxSpans spans were given
+    ScriptureSpan spans[MaxSpans];
+};
+
+// Hand-written parser for scripture references. Understands book names and
+// abbreviations from a BookNameTrie, ordinals ("1st John", "II Kings"),
+// whole chapters ("Ps 23", "Ps 23-24"), verse ranges crossing chapters
+// ("Gen 1:26-2:3"), verse lists after ',' and new chapters or books after
+// ';'. Cheap enough to re-run on every keystroke.
+class ScriptureReferenceParser
+{
+public:
+    explicit ScriptureReferenceParser(const BookNameTrie *bookNames);
+
+    // Returns true when at least one span was recognised (status Complete
+    // or Incomplete).
+    bool parse(QStringView text, ScriptureReference &result) const;
+
+private:
+    int matchBook(QStringView text, int pos, int *bookId) const;
+    int matchBookFrom(QStringView text, int pos, int ordinal, int *bookId) const;
+
+    const BookNameTrie *trie;
+};
+
+#endif // SCRIPTUREREFERENCE_H
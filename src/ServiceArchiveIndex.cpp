@@ -0,0 +1,516 @@
+#include "ServiceArchiveIndex.h"
+#include "BibleTranslation.h"
+#include "PlaylistManager.h"
+#include "SongSearchIndex.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// Bump when the index layout or the way services are read changes
+static const quint32 kIndexMagic = 0x53505341; // "SPSA"
+static const quint32 kIndexVersion = 1;
+
+// Chapter and verse as one number, so passages compare as ranges
+int passageStart(const ScriptureSpan &span)
+{
+    return span.startChapter * 1000 + qMax(span.startVerse, 0);
+}
+
+int passageEnd(const ScriptureSpan &span)
+{
+    return span.endChapter * 1000 + (span.endVerse > 0 ? span.endVerse : 999);
+}
+
+bool passagesOverlap(const ScriptureSpan &a, const ScriptureSpan &b)
+{
+    return a.bookId == b.bookId && passageStart(a) <= passageEnd(b) && passageStart(b) <= passageEnd(a);
+}
+
+QDate serviceDate(const QFileInfo &info)
+{
+    static const QRegularExpression datePattern("(\\d{4})-(\\d{2})-(\\d{2})");
+    const QRegularExpressionMatch match = datePattern.match(info.completeBaseName());
+    if (match.hasMatch()) {
+        const QDate date(match.captured(1).toInt(), match.captured(2).toInt(), match.captured(3).toInt());
+        if (date.isValid()) {
+            return date;
+        }
+    }
+    return info.lastModified().date();
+}
+
+bool newerFirst(const ServiceArchiveIndex::Usage &a, const ServiceArchiveIndex::Usage &b)
+{
+    if (a.date != b.date) {
+        return a.date > b.date;
+    }
+    return a.filePath < b.filePath;
+}
+
+} // namespace
+
+ServiceArchiveIndex::ServiceArchiveIndex(QObject *parent)
+    : QObject(parent)
+    , loaded(false)
+    , saveAgain(false)
+{
+    connect(&build, &QFutureWatcher<QVector<Service>>::finished, this, [this]() {
+        setServices(build.result());
+        loaded = true;
+        // Saves that raced the scan may have been read before they were written
+        const QStringList saved = savedDuringBuild;
+        savedDuringBuild.clear();
+        for (const QString &filePath : saved) {
+            updateService(filePath);
+        }
+    });
+    connect(&save, &QFutureWatcher<void>::finished, this, [this]() {
+        if (saveAgain) {
+            saveAgain = false;
+            scheduleSave();
+        }
+    });
+}
+
+ServiceArchiveIndex::~ServiceArchiveIndex()
+{
+    build.waitForFinished();
+    save.waitForFinished();
+}
+
+QString ServiceArchiveIndex::servicesDirectory()
+{
+    return QDir("data/services").absolutePath();
+}
+
+QString ServiceArchiveIndex::indexFilePath()
+{
+    const QString baseDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (baseDir.isEmpty()) {
+        return QString();
+    }
+    QDir dir(baseDir);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    return dir.filePath("service-archive.dat");
+}
+
+void ServiceArchiveIndex::refresh(const std::shared_ptr<const BibleTranslation> &translation)
+{
+    if (translation) {
+        bookNames = translation;
+    }
+    if (build.isRunning()) {
+        return;
+    }
+
+    const QString directory = servicesDirectory();
+    const QVector<Service> previous = services;
+    const bool fromDisk = !loaded;
+    const std::shared_ptr<const BibleTranslation> names = bookNames;
+    build.setFuture(QtConcurrent::run([directory, previous, fromDisk, names]() {
+        const QVector<Service> result = buildIndex(directory, fromDisk ? loadIndex() : previous, names);
+        saveIndex(result);
+        return result;
+    }));
+}
+
+QVector<ServiceArchiveIndex::Service> ServiceArchiveIndex::buildIndex(
+    const QString &directory, const QVector<Service> &previous,
+    const std::shared_ptr<const BibleTranslation> &bookNames)
+{
+    QHash<QString, const Service *> known;
+    known.reserve(previous.size());
+    for (const Service &service : previous) {
+        known.insert(service.filePath, &service);
+    }
+
+    QVector<Service> result;
+    QSet<QString> seen;
+    auto take = [&](const QFileInfo &info) {
+        const QString filePath = info.absoluteFilePath();
+        seen.insert(filePath);
+        const Service *cached = known.value(filePath);
+        if (cached && cached->size == info.size() && cached->modified == info.lastModified().toMSecsSinceEpoch()) {
+            result.append(*cached);
+            return;
+        }
+        Service service;
+        if (parseService(filePath, bookNames, service)) {
+            result.append(service);
+        }
+    };
+
+    const QFileInfoList files = QDir(directory).entryInfoList(QStringList() << "*.spp" << "*.service", QDir::Files);
+    for (const QFileInfo &info : files) {
+        take(info);
+    }
+
+    // Services saved outside the folder stay while their file does
+    for (const Service &service : previous) {
+        const QFileInfo info(service.filePath);
+        if (!seen.contains(service.filePath) && info.exists()) {
+            take(info);
+        }
+    }
+    return result;
+}
+
+bool ServiceArchiveIndex::parsePassages(const QString &text,
+                                        const std::shared_ptr<const BibleTranslation> &bookNames,
+                                        ScriptureReference &reference)
+{
+    // References are saved with the book names of the Bible in use at the time
+    const QStringView view(text);
+    if (bookNames && ScriptureReferenceParser(&bookNames->bookNameTrie()).parse(view, reference)) {
+        return true;
+    }
+    return ScriptureReferenceParser(&BibleTranslation::canonicalBookNameTrie()).parse(view, reference);
+}
+
+bool ServiceArchiveIndex::parseService(const QString &filePath,
+                                       const std::shared_ptr<const BibleTranslation> &bookNames,
+                                       Service &service)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        return false;
+    }
+
+    const QFileInfo info(filePath);
+    service.filePath = info.absoluteFilePath();
+    service.date = serviceDate(info);
+    service.size = info.size();
+    service.modified = info.lastModified().toMSecsSinceEpoch();
+    // .service files label each item with title and name the song in reference
+    const bool songInReference = info.suffix().compare("service", Qt::CaseInsensitive) == 0;
+
+    const QJsonArray items = doc.object().value("items").toArray();
+    for (const QJsonValue &value : items) {
+        const QJsonObject itemObj = value.toObject();
+        const QString typeStr = itemObj.value("type").toString();
+
+        Item item;
+        item.title = itemObj.value("title").toString();
+        if (typeStr == "bible") {
+            item.type = quint8(PlaylistItemType::BibleVerse);
+            const QString reference = itemObj.value("reference").toString();
+            ScriptureReference parsed;
+            if (parsePassages(reference, bookNames, parsed)) {
+                item.reference = normalizedReference(parsed);
+                for (int i = 0; i < parsed.spanCount; ++i) {
+                    item.passages.append(parsed.spans[i]);
+                }
+            } else {
+                item.reference = reference;
+            }
+        } else if (typeStr == "song") {
+            item.type = quint8(PlaylistItemType::Song);
+            const QString name = itemObj.value("reference").toString();
+            if (songInReference && !name.isEmpty()) {
+                item.title = name;
+            }
+        } else if (typeStr == "media") {
+            item.type = quint8(PlaylistItemType::Media);
+        } else if (typeStr == "youtube") {
+            item.type = quint8(PlaylistItemType::YouTube);
+        } else {
+            continue;
+        }
+        service.items.append(item);
+    }
+    return true;
+}
+
+QString ServiceArchiveIndex::normalizedReference(const ScriptureReference &reference)
+{
+    QStringList parts;
+    for (int i = 0; i < reference.spanCount; ++i) {
+        const ScriptureSpan &span = reference.spans[i];
+        const QString book = BibleTranslation::canonicalBookName(span.bookId);
+        if (span.startVerse <= 0 && span.endVerse <= 0) {
+            // Whole chapters
+            parts.append(span.startChapter == span.endChapter
+                             ? QString("%1 %2").arg(book).arg(span.startChapter)
+                             : QString("%1 %2-%3").arg(book).arg(span.startChapter).arg(span.endChapter));
+            continue;
+        }
+
+        const int startVerse = qMax(span.startVerse, 1);
+        QString part = QString("%1 %2:%3").arg(book).arg(span.startChapter).arg(startVerse);
+        if (span.endChapter != span.startChapter) {
+            part += span.endVerse > 0 ? QString("-%1:%2").arg(span.endChapter).arg(span.endVerse)
+                                      : QString("-%1").arg(span.endChapter);
+        } else if (span.endVerse > startVerse) {
+            part += QString("-%1").arg(span.endVerse);
+        }
+        parts.append(part);
+    }
+    return parts.join("; ");
+}
+
+QString ServiceArchiveIndex::songKey(const QString &title)
+{
+    return SongSearchIndex::tokenize(title).join(' ');
+}
+
+void ServiceArchiveIndex::setServices(const QVector<Service> &list)
+{
+    services = list;
+    std::sort(services.begin(), services.end(), [](const Service &a, const Service &b) {
+        if (a.date != b.date) {
+            return a.date > b.date;
+        }
+        return a.filePath < b.filePath;
+    });
+
+    serviceByPath.clear();
+    servicesBySong.clear();
+    servicesByBook.clear();
+    for (int i = 0; i < services.size(); ++i) {
+        const Service &service = services[i];
+        serviceByPath.insert(service.filePath, i);
+
+        // Songs appear once per section added; list each service once
+        QSet<QString> songs;
+        QSet<int> books;
+        for (const Item &item : service.items) {
+            if (item.type == quint8(PlaylistItemType::Song)) {
+                songs.insert(songKey(item.title));
+            }
+            for (const ScriptureSpan &span : item.passages) {
+                books.insert(span.bookId);
+            }
+        }
+        for (const QString &song : songs) {
+            servicesBySong[song].append(i);
+        }
+        for (int book : books) {
+            servicesByBook[book].append(i);
+        }
+    }
+    emit updated();
+}
+
+void ServiceArchiveIndex::updateService(const QString &filePath)
+{
+    if (build.isRunning()) {
+        savedDuringBuild.append(filePath);
+    }
+
+    Service service;
+    if (!parseService(filePath, bookNames, service)) {
+        return;
+    }
+
+    QVector<Service> list = services;
+    const int existing = serviceByPath.value(service.filePath, -1);
+    if (existing >= 0) {
+        list[existing] = service;
+    } else {
+        list.append(service);
+    }
+    setServices(list);
+    scheduleSave();
+}
+
+QVector<ServiceArchiveIndex::Usage> ServiceArchiveIndex::songUsage(const QString &text) const
+{
+    QVector<Usage> usages;
+    const QString needle = songKey(text);
+    if (needle.isEmpty()) {
+        return usages;
+    }
+
+    for (auto it = servicesBySong.constBegin(); it != servicesBySong.constEnd(); ++it) {
+        if (!it.key().contains(needle)) {
+            continue;
+        }
+        for (int index : it.value()) {
+            const Service &service = services[index];
+            for (const Item &item : service.items) {
+                if (item.type == quint8(PlaylistItemType::Song) && songKey(item.title) == it.key()) {
+                    usages.append(Usage{service.filePath, service.date, item.title, QString()});
+                    break;
+                }
+            }
+        }
+    }
+    std::sort(usages.begin(), usages.end(), newerFirst);
+    return usages;
+}
+
+QVector<ServiceArchiveIndex::Usage> ServiceArchiveIndex::passageUsage(const QString &reference) const
+{
+    QVector<Usage> usages;
+    ScriptureReference query;
+    if (!parsePassages(reference, bookNames, query)) {
+        return usages;
+    }
+
+    QSet<QPair<int, int>> found; // service, item
+    for (int q = 0; q < query.spanCount; ++q) {
+        const ScriptureSpan &wanted = query.spans[q];
+        const QVector<int> candidates = servicesByBook.value(wanted.bookId);
+        for (int index : candidates) {
+            const Service &service = services[index];
+            for (int i = 0; i < service.items.size(); ++i) {
+                const Item &item = service.items[i];
+                for (const ScriptureSpan &span : item.passages) {
+                    if (passagesOverlap(span, wanted) && !found.contains(qMakePair(index, i))) {
+                        found.insert(qMakePair(index, i));
+                        usages.append(Usage{service.filePath, service.date, item.title, item.reference});
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    std::sort(usages.begin(), usages.end(), newerFirst);
+    return usages;
+}
+
+QVector<ServiceArchiveIndex::SongCount> ServiceArchiveIndex::songReport(const QDate &from, const QDate &to) const
+{
+    QHash<QString, SongCount> counts;
+    for (const Service &service : services) {
+        if (service.date < from || service.date > to) {
+            continue;
+        }
+        QSet<QString> counted;
+        for (const Item &item : service.items) {
+            if (item.type != quint8(PlaylistItemType::Song)) {
+                continue;
+            }
+            const QString key = songKey(item.title);
+            if (counted.contains(key)) {
+                continue;
+            }
+            counted.insert(key);
+            SongCount &entry = counts[key];
+            if (entry.title.isEmpty()) {
+                entry.title = item.title; // newest spelling, services are newest first
+            }
+            ++entry.count;
+            if (!entry.lastUsed.isValid() || service.date > entry.lastUsed) {
+                entry.lastUsed = service.date;
+            }
+        }
+    }
+
+    QVector<SongCount> report = counts.values();
+    std::sort(report.begin(), report.end(), [](const SongCount &a, const SongCount &b) {
+        if (a.count != b.count) {
+            return a.count > b.count;
+        }
+        return a.title.compare(b.title, Qt::CaseInsensitive) < 0;
+    });
+    return report;
+}
+
+QVector<ServiceArchiveIndex::Service> ServiceArchiveIndex::loadIndex()
+{
+    QVector<Service> list;
+    const QString path = indexFilePath();
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return list;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != kIndexMagic || version != kIndexVersion) {
+        return list;
+    }
+
+    list.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Service service;
+        quint32 itemCount = 0;
+        in >> service.filePath >> service.date >> service.size >> service.modified >> itemCount;
+        for (quint32 j = 0; j < itemCount && in.status() == QDataStream::Ok; ++j) {
+            Item item;
+            quint32 passageCount = 0;
+            in >> item.type >> item.title >> item.reference >> passageCount;
+            for (quint32 k = 0; k < passageCount && in.status() == QDataStream::Ok; ++k) {
+                ScriptureSpan span;
+                qint32 bookId, startChapter, startVerse, endChapter, endVerse;
+                in >> bookId >> startChapter >> startVerse >> endChapter >> endVerse;
+                span.bookId = bookId;
+                span.startChapter = startChapter;
+                span.startVerse = startVerse;
+                span.endChapter = endChapter;
+                span.endVerse = endVerse;
+                item.passages.append(span);
+            }
+            service.items.append(item);
+        }
+        list.append(service);
+    }
+    if (in.status() != QDataStream::Ok) {
+        list.clear();
+    }
+    return list;
+}
+
+void ServiceArchiveIndex::saveIndex(const QVector<Service> &list)
+{
+    const QString path = indexFilePath();
+    if (path.isEmpty()) {
+        return;
+    }
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kIndexMagic << kIndexVersion << quint32(list.size());
+    for (const Service &service : list) {
+        out << service.filePath << service.date << service.size << service.modified
+            << quint32(service.items.size());
+        for (const Item &item : service.items) {
+            out << item.type << item.title << item.reference << quint32(item.passages.size());
+            for (const ScriptureSpan &span : item.passages) {
+                out << qint32(span.bookId) << qint32(span.startChapter) << qint32(span.startVerse)
+                    << qint32(span.endChapter) << qint32(span.endVerse);
+            }
+        }
+    }
+    file.commit();
+}
+
+void ServiceArchiveIndex::scheduleSave()
+{
+    if (save.isRunning()) {
+        saveAgain = true;
+        return;
+    }
+    const QVector<Service> list = services;
+    save.setFuture(QtConcurrent::run([list]() {
+        saveIndex(list);
+    }));
+}
@@ -0,0 +1,117 @@
+#ifndef SERVICEARCHIVEINDEX_H
+#define SERVICEARCHIVEINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QDate>
+#include <QFutureWatcher>
+#include <memory>
+#include "ScriptureReference.h"
+
+class BibleTranslation;
+
+// Index over every saved service (.spp or .service) in the services folder, so "when
+// did we last sing this?", "which Sundays used Romans 8?" and song usage
+// reports for CCLI licensing never open the files themselves.
+//
+// Each service is reduced to its date and items: song titles, and Bible
+// references parsed into passages by canonical book ID. The index is kept
+// in the app data directory keyed by file size and modification time;
+// refresh() re-reads only services that changed, on a worker thread, and
+// updateService() takes in a service as soon as it is saved.
+//
+// A service's date comes from a yyyy-MM-dd in its file name, falling back
+// to the day the file was last written.
+class ServiceArchiveIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Item {
+        quint8 type = 0;      // PlaylistItemType
+        QString title;        // song title or item title
+        QString reference;    // normalised Bible reference, or as written if it did not parse
+        QVector<ScriptureSpan> passages;
+    };
+
+    struct Service {
+        QString filePath;
+        QDate date;
+        qint64 size = 0;
+        qint64 modified = 0;
+        QVector<Item> items;
+    };
+
+    // One use of a song or passage, newest first in query results
+    struct Usage {
+        QString filePath;
+        QDate date;
+        QString title;
+        QString reference;
+    };
+
+    struct SongCount {
+        QString title;
+        int count = 0;
+        QDate lastUsed;
+    };
+
+    explicit ServiceArchiveIndex(QObject *parent = nullptr);
+    ~ServiceArchiveIndex();
+
+    static QString servicesDirectory();
+
+    // Rescans the services folder in the background. bookNames, when set,
+    // also parses references written with that translation's book names.
+    void refresh(const std::shared_ptr<const BibleTranslation> &bookNames = nullptr);
+    bool isRefreshing() const { return build.isRunning(); }
+
+    // Re-reads one service after it was saved, wherever it lives
+    void updateService(const QString &filePath);
+
+    int serviceCount() const { return services.size(); }
+
+    // Songs whose title contains text (words compared case-insensitively)
+    QVector<Usage> songUsage(const QString &text) const;
+    // Services with a passage overlapping reference ("Romans 8", "Ps 23:1-4")
+    QVector<Usage> passageUsage(const QString &reference) const;
+    // Every song used between from and to, most used first
+    QVector<SongCount> songReport(const QDate &from, const QDate &to) const;
+
+    static QString normalizedReference(const ScriptureReference &reference);
+
+signals:
+    void updated();
+
+private:
+    static QVector<Service> buildIndex(const QString &directory, const QVector<Service> &previous,
+                                       const std::shared_ptr<const BibleTranslation> &bookNames);
+    static bool parseService(const QString &filePath, const std::shared_ptr<const BibleTranslation> &bookNames,
+                             Service &service);
+    static bool parsePassages(const QString &text, const std::shared_ptr<const BibleTranslation> &bookNames,
+                              ScriptureReference &reference);
+    static QString songKey(const QString &title);
+    static QString indexFilePath();
+    static QVector<Service> loadIndex();
+    static void saveIndex(const QVector<Service> &services);
+
+    void setServices(const QVector<Service> &list);
+    void scheduleSave();
+
+    QVector<Service> services;               // newest first
+    QHash<QString, int> serviceByPath;
+    QHash<QString, QVector<int>> servicesBySong; // song key -> services
+    QHash<int, QVector<int>> servicesByBook;     // book ID -> services
+    std::shared_ptr<const BibleTranslation> bookNames;
+    bool loaded;
+
+    QFutureWatcher<QVector<Service>> build;
+    QStringList savedDuringBuild;
+    QFutureWatcher<void> save;
+    bool saveAgain;
+};
+
+#endif // SERVICEARCHIVEINDEX_H
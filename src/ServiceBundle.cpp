@@ -0,0 +1,278 @@
+#include "ServiceBundle.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cctype>
+
+namespace {
+
+static const quint32 kBundleMagic = 0x53505342; // "SPSB"
+static const quint32 kBundleVersion = 1;
+static const qint64 kCopyChunkSize = 1 << 20;
+
+struct MediaFile {
+    QByteArray hash;
+    QString path;
+    QString suffix;
+    qint64 size = 0;
+};
+
+QByteArray hashFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+    return hash.result().toHex();
+}
+
+bool copyBytes(QIODevice &from, QIODevice &to, qint64 size, QCryptographicHash *hash = nullptr)
+{
+    QByteArray buffer;
+    while (size > 0) {
+        buffer = from.read(qMin(size, kCopyChunkSize));
+        if (buffer.isEmpty() || to.write(buffer) != buffer.size()) {
+            return false;
+        }
+        if (hash) {
+            hash->addData(buffer);
+        }
+        size -= buffer.size();
+    }
+    return true;
+}
+
+// Bundles come from other machines; their names must not be able to
+// reach outside the media directory
+bool isValidMediaEntry(const QByteArray &hash, const QString &suffix)
+{
+    if (hash.size() != 40 || suffix.size() > 10) {
+        return false;
+    }
+    for (char c : hash) {
+        if (!isxdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+    }
+    for (QChar c : suffix) {
+        if (c.unicode() > 0x7f || !c.isLetterOrNumber()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ServiceBundle::isBundle(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    in >> magic;
+    return magic == kBundleMagic;
+}
+
+QString ServiceBundle::mediaCacheDirectory()
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    dir.mkpath("bundle-media");
+    return dir.filePath("bundle-media");
+}
+
+bool ServiceBundle::write(const QString &bundlePath, QJsonObject service, QString *errorString)
+{
+    // The same file used by several items is stored once
+    QVector<MediaFile> media;
+    QHash<QString, int> mediaByPath;
+
+    QJsonArray items = service.value("items").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        QJsonObject item = items[i].toObject();
+        if (item.value("type").toString() != "media") {
+            continue;
+        }
+        QJsonObject data = item.value("data").toObject();
+        const QString path = data.value("path").toString(item.value("reference").toString());
+
+        auto known = mediaByPath.constFind(path);
+        if (known == mediaByPath.constEnd()) {
+            const QFileInfo info(path);
+            MediaFile file;
+            file.hash = hashFile(path);
+            if (file.hash.isEmpty()) {
+                if (errorString) {
+                    *errorString = QString("Cannot read media file: %1").arg(path);
+                }
+                return false;
+            }
+            file.path = path;
+            file.suffix = info.suffix();
+            file.size = info.size();
+            known = mediaByPath.insert(path, media.size());
+            media.append(file);
+        }
+
+        data["mediaHash"] = QString::fromLatin1(media[known.value()].hash);
+        item["data"] = data;
+        items[i] = item;
+    }
+    service["items"] = items;
+
+    QSaveFile file(bundlePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = QString("Cannot write %1").arg(bundlePath);
+        }
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kBundleMagic << kBundleVersion
+        << qCompress(QJsonDocument(service).toJson(QJsonDocument::Compact))
+        << quint32(media.size());
+
+    for (const MediaFile &entry : media) {
+        QFile source(entry.path);
+        if (!source.open(QIODevice::ReadOnly)) {
+            if (errorString) {
+                *errorString = QString("Cannot read media file: %1").arg(entry.path);
+            }
+            return false;
+        }
+        out << entry.hash << entry.suffix << entry.size;
+        if (!copyBytes(source, file, entry.size)) {
+            if (errorString) {
+                *errorString = QString("Failed to copy %1 into the bundle").arg(entry.path);
+            }
+            return false;
+        }
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        if (errorString) {
+            *errorString = QString("Cannot write %1").arg(bundlePath);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ServiceBundle::read(const QString &bundlePath, const QString &mediaDirectory, QJsonObject &service,
+                         QString *errorString)
+{
+    QFile file(bundlePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = QString("Cannot open %1").arg(bundlePath);
+        }
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray manifest;
+    quint32 mediaCount = 0;
+    in >> magic >> version;
+    if (magic != kBundleMagic || version != kBundleVersion) {
+        if (errorString) {
+            *errorString = QString("%1 is not a service bundle this version can read").arg(bundlePath);
+        }
+        return false;
+    }
+    in >> manifest >> mediaCount;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(qUncompress(manifest));
+    if (in.status() != QDataStream::Ok || !doc.isObject()) {
+        if (errorString) {
+            *errorString = QString("The service bundle %1 is damaged").arg(bundlePath);
+        }
+        return false;
+    }
+    service = doc.object();
+
+    // Unpack media, skipping files already unpacked by an earlier open
+    QDir dir(mediaDirectory);
+    dir.mkpath(".");
+    QHash<QString, QString> pathByHash;
+    for (quint32 i = 0; i < mediaCount; ++i) {
+        QByteArray hash;
+        QString suffix;
+        qint64 size = 0;
+        in >> hash >> suffix >> size;
+        if (in.status() != QDataStream::Ok || size < 0 || size > file.size() - file.pos()
+            || !isValidMediaEntry(hash, suffix)) {
+            if (errorString) {
+                *errorString = QString("The service bundle %1 is damaged").arg(bundlePath);
+            }
+            return false;
+        }
+
+        const QString fileName = suffix.isEmpty() ? QString::fromLatin1(hash)
+                                                  : QString("%1.%2").arg(QString::fromLatin1(hash), suffix);
+        const QString target = dir.filePath(fileName);
+        pathByHash.insert(QString::fromLatin1(hash), target);
+
+        // Media are named by their hash, so a copy that still hashes the
+        // same is the same file
+        const QByteArray expected = hash.toLower();
+        if (QFileInfo(target).size() == size && hashFile(target) == expected) {
+            file.seek(file.pos() + size);
+            continue;
+        }
+        QSaveFile out(target);
+        QCryptographicHash unpackedHash(QCryptographicHash::Sha1);
+        if (!out.open(QIODevice::WriteOnly) || !copyBytes(file, out, size, &unpackedHash)) {
+            if (errorString) {
+                *errorString = QString("Cannot unpack %1").arg(target);
+            }
+            return false;
+        }
+        if (unpackedHash.result().toHex() != expected) {
+            out.cancelWriting();
+            if (errorString) {
+                *errorString = QString("The service bundle %1 is damaged").arg(bundlePath);
+            }
+            return false;
+        }
+        if (!out.commit()) {
+            if (errorString) {
+                *errorString = QString("Cannot unpack %1").arg(target);
+            }
+            return false;
+        }
+    }
+
+    QJsonArray items = service.value("items").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        QJsonObject item = items[i].toObject();
+        QJsonObject data = item.value("data").toObject();
+        const QString unpacked = pathByHash.value(data.value("mediaHash").toString());
+        if (unpacked.isEmpty()) {
+            continue;
+        }
+        data["path"] = unpacked;
+        item["data"] = data;
+        item["reference"] = unpacked;
+        items[i] = item;
+    }
+    service["items"] = items;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef SERVICEBUNDLE_H
+#define SERVICEBUNDLE_H
+
+#include <QString>
+#include <QJsonObject>
+
+// Self-contained service (.spbundle): the playlist with every item already
+// resolved plus the media files it plays, so a service prepared on one
+// machine opens the same on another with different Bibles, songs or
+// folders.
+//
+//   "SPSB" | quint32 format version | manifest | quint32 media count | media
+//
+// The manifest is the playlist JSON as saved in .spp files (notes
+// included), zlib-compressed. Bible items carry their verse text under
+// "verses", song items the whole song under "song", and media items the
+// SHA-1 of their file under "mediaHash". Each media entry is that hash,
+// the file suffix, a qint64 size and the raw bytes: stored as-is since
+// video and images are already compressed, and copied in chunks so large
+// files never sit in memory.
+class ServiceBundle
+{
+public:
+    static QString fileSuffix() { return QStringLiteral("spbundle"); }
+    static bool isBundle(const QString &filePath);
+
+    // Where media unpacked from bundles are kept. Files are named by hash,
+    // so opening the same bundle again reuses them.
+    static QString mediaCacheDirectory();
+
+    // Hashes the file of every media item (data "path"), records the hash
+    // in the item and writes manifest and files to bundlePath. Blocking;
+    // run it off the GUI thread when the service has video.
+    static bool write(const QString &bundlePath, QJsonObject service, QString *errorString = nullptr);
+
+    // Reads the manifest into service and unpacks the media into
+    // mediaDirectory, pointing each media item at its unpacked copy.
+    static bool read(const QString &bundlePath, const QString &mediaDirectory, QJsonObject &service,
+                     QString *errorString = nullptr);
+};
+
+#endif // SERVICEBUNDLE_H
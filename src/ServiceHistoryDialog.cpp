@@ -0,0 +1,190 @@
+#include "ServiceHistoryDialog.h"
+#include "ServiceArchiveIndex.h"
+#include "SongManager.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTabWidget>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QSaveFile>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+QString csvField(const QString &text)
+{
+    QString field = text;
+    field.replace('"', "\"\"");
+    return QString("\"%1\"").arg(field);
+}
+
+} // namespace
+
+ServiceHistoryDialog::ServiceHistoryDialog(ServiceArchiveIndex *archive, SongManager *songs, QWidget *parent)
+    : QDialog(parent)
+    , archive(archive)
+    , songs(songs)
+{
+    setWindowTitle("Service History");
+    setupUI();
+    resize(720, 520);
+
+    // Results follow the index while it is still being built or updated
+    connect(archive, &ServiceArchiveIndex::updated, this, [this]() {
+        updateSearch();
+        updateReport();
+        updateStatus();
+    });
+    updateReport();
+    updateStatus();
+}
+
+void ServiceHistoryDialog::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    QTabWidget *tabs = new QTabWidget();
+
+    // Find tab: songs by title, passages by reference
+    QWidget *searchTab = new QWidget();
+    QVBoxLayout *searchLayout = new QVBoxLayout(searchTab);
+    searchEdit = new QLineEdit();
+    searchEdit->setPlaceholderText("Song title or Bible reference, e.g. Amazing Grace or Romans 8");
+    searchEdit->setClearButtonEnabled(true);
+    searchLayout->addWidget(searchEdit);
+    searchResults = new QTreeWidget();
+    searchResults->setHeaderLabels(QStringList() << "Date" << "Service" << "Item");
+    searchResults->setRootIsDecorated(false);
+    searchResults->setUniformRowHeights(true);
+    searchResults->header()->setSectionResizeMode(2, QHeaderView::Stretch);
+    searchLayout->addWidget(searchResults);
+    tabs->addTab(searchTab, "Find");
+
+    // Song usage tab
+    QWidget *reportTab = new QWidget();
+    QVBoxLayout *reportLayout = new QVBoxLayout(reportTab);
+    QHBoxLayout *rangeLayout = new QHBoxLayout();
+    fromEdit = new QDateEdit(QDate::currentDate().addMonths(-6));
+    fromEdit->setCalendarPopup(true);
+    toEdit = new QDateEdit(QDate::currentDate());
+    toEdit->setCalendarPopup(true);
+    rangeLayout->addWidget(new QLabel("From:"));
+    rangeLayout->addWidget(fromEdit);
+    rangeLayout->addWidget(new QLabel("To:"));
+    rangeLayout->addWidget(toEdit);
+    rangeLayout->addStretch();
+    exportButton = new QPushButton("Export CSV...");
+    rangeLayout->addWidget(exportButton);
+    reportLayout->addLayout(rangeLayout);
+    reportResults = new QTreeWidget();
+    reportResults->setHeaderLabels(QStringList() << "Song" << "CCLI" << "Times Used" << "Last Used");
+    reportResults->setRootIsDecorated(false);
+    reportResults->setUniformRowHeights(true);
+    reportResults->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    reportLayout->addWidget(reportResults);
+    tabs->addTab(reportTab, "Song Usage");
+
+    mainLayout->addWidget(tabs);
+
+    QHBoxLayout *bottomLayout = new QHBoxLayout();
+    statusLabel = new QLabel();
+    bottomLayout->addWidget(statusLabel, 1);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    bottomLayout->addWidget(buttons);
+    mainLayout->addLayout(bottomLayout);
+
+    connect(searchEdit, &QLineEdit::textChanged, this, &ServiceHistoryDialog::updateSearch);
+    connect(fromEdit, &QDateEdit::dateChanged, this, &ServiceHistoryDialog::updateReport);
+    connect(toEdit, &QDateEdit::dateChanged, this, &ServiceHistoryDialog::updateReport);
+    connect(exportButton, &QPushButton::clicked, this, &ServiceHistoryDialog::exportReport);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+void ServiceHistoryDialog::updateStatus()
+{
+    statusLabel->setText(archive->isRefreshing()
+                             ? QString("Indexing services... (%1 so far)").arg(archive->serviceCount())
+                             : QString("%1 services indexed").arg(archive->serviceCount()));
+}
+
+void ServiceHistoryDialog::updateSearch()
+{
+    searchResults->clear();
+    const QString text = searchEdit->text().trimmed();
+    if (text.isEmpty()) {
+        return;
+    }
+
+    // A reference such as "Psalm 23" can also be part of a song title;
+    // list both kinds of match together
+    QVector<ServiceArchiveIndex::Usage> usages = archive->passageUsage(text);
+    usages += archive->songUsage(text);
+    std::stable_sort(usages.begin(), usages.end(),
+                     [](const ServiceArchiveIndex::Usage &a, const ServiceArchiveIndex::Usage &b) {
+                         return a.date > b.date;
+                     });
+
+    QList<QTreeWidgetItem *> rows;
+    rows.reserve(usages.size());
+    for (const ServiceArchiveIndex::Usage &usage : usages) {
+        QTreeWidgetItem *row = new QTreeWidgetItem();
+        row->setText(0, usage.date.toString(Qt::ISODate));
+        row->setText(1, QFileInfo(usage.filePath).completeBaseName());
+        row->setToolTip(1, usage.filePath);
+        row->setText(2, usage.reference.isEmpty() ? usage.title : usage.reference);
+        rows.append(row);
+    }
+    searchResults->addTopLevelItems(rows);
+}
+
+void ServiceHistoryDialog::updateReport()
+{
+    reportResults->clear();
+    const QVector<ServiceArchiveIndex::SongCount> report = archive->songReport(fromEdit->date(), toEdit->date());
+
+    QList<QTreeWidgetItem *> rows;
+    rows.reserve(report.size());
+    for (const ServiceArchiveIndex::SongCount &entry : report) {
+        const SongHandle song = songs ? songs->songByTitle(entry.title) : SongHandle();
+        QTreeWidgetItem *row = new QTreeWidgetItem();
+        row->setText(0, entry.title);
+        row->setText(1, song ? song->ccli : QString());
+        row->setText(2, QString::number(entry.count));
+        row->setText(3, entry.lastUsed.toString(Qt::ISODate));
+        rows.append(row);
+    }
+    reportResults->addTopLevelItems(rows);
+    exportButton->setEnabled(!rows.isEmpty());
+}
+
+void ServiceHistoryDialog::exportReport()
+{
+    const QString fileName = QFileDialog::getSaveFileName(
+        this, "Export Song Usage",
+        QString("song-usage-%1-to-%2.csv").arg(fromEdit->date().toString(Qt::ISODate),
+                                               toEdit->date().toString(Qt::ISODate)),
+        "CSV Files (*.csv);;All Files (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "Error", QString("Cannot write %1").arg(fileName));
+        return;
+    }
+    QTextStream out(&file);
+    out << "Song,CCLI,Times Used,Last Used\n";
+    for (int i = 0; i < reportResults->topLevelItemCount(); ++i) {
+        const QTreeWidgetItem *row = reportResults->topLevelItem(i);
+        out << csvField(row->text(0)) << ',' << csvField(row->text(1)) << ','
+            << row->text(2) << ',' << row->text(3) << '\n';
+    }
+    out.flush();
+    if (!file.commit()) {
+        QMessageBox::warning(this, "Error", QString("Cannot write %1").arg(fileName));
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef SERVICEHISTORYDIALOG_H
+#define SERVICEHISTORYDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QTreeWidget>
+#include <QDateEdit>
+#include <QLabel>
+#include <QPushButton>
+
+class ServiceArchiveIndex;
+class SongManager;
+
+// Looks up past services through the archive index: where a song or
+// passage was used, and how often each song was used over a period for
+// CCLI reporting.
+class ServiceHistoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ServiceHistoryDialog(ServiceArchiveIndex *archive, SongManager *songs, QWidget *parent = nullptr);
+
+private slots:
+    void updateSearch();
+    void updateReport();
+    void exportReport();
+
+private:
+    void setupUI();
+    void updateStatus();
+
+    ServiceArchiveIndex *archive;
+    SongManager *songs;
+
+    QLineEdit *searchEdit;
+    QTreeWidget *searchResults;
+    QDateEdit *fromEdit;
+    QDateEdit *toEdit;
+    QTreeWidget *reportResults;
+    QPushButton *exportButton;
+    QLabel *statusLabel;
+};
+
+#endif // SERVICEHISTORYDIALOG_H
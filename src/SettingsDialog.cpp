@@ -831,8 +831,39 @@ void SettingsDialog::setupUI()
     resolutionNote->setStyleSheet("color: gray; font-style: italic;");
     obsCanvasForm->addRow("", resolutionNote);
     
+    obsTranscodeVideosCheck = new QCheckBox("Send OBS a lightweight H.264 copy of videos");
+    obsTranscodeVideosCheck->setToolTip("Videos are converted in the background with ffmpeg, which must be installed. "
+                                        "Large images are always sent scaled to the canvas resolution.");
+    obsCanvasForm->addRow("", obsTranscodeVideosCheck);
+    
     obsLayout->addWidget(obsCanvasGroup);
     
+    // Program Output Stream
+    QGroupBox *programStreamGroup = new QGroupBox("Program Output Stream");
+    QFormLayout *programStreamForm = new QFormLayout(programStreamGroup);
+    
+    programStreamResolutionCombo = new QComboBox();
+    programStreamResolutionCombo->addItem("640x360", QSize(640, 360));
+    programStreamResolutionCombo->addItem("1280x720 (HD)", QSize(1280, 720));
+    programStreamResolutionCombo->addItem("1920x1080 (Full HD)", QSize(1920, 1080));
+    programStreamResolutionCombo->setCurrentIndex(1);
+    programStreamForm->addRow("Resolution:", programStreamResolutionCombo);
+    
+    programStreamFpsSpinBox = new QSpinBox();
+    programStreamFpsSpinBox->setRange(1, 30);
+    programStreamFpsSpinBox->setValue(15);
+    programStreamFpsSpinBox->setSuffix(" fps");
+    programStreamForm->addRow("Max frame rate:", programStreamFpsSpinBox);
+    
+    QLabel *programStreamNote = new QLabel("The projection output as MJPEG at http://<this computer>:8080/program.mjpg "
+                                           "or as JPEG frames at ws://<this computer>:8081/program. "
+                                           "Frames are only encoded while a client is connected.");
+    programStreamNote->setWordWrap(true);
+    programStreamNote->setStyleSheet("color: gray; font-style: italic;");
+    programStreamForm->addRow("", programStreamNote);
+    
+    obsLayout->addWidget(programStreamGroup);
+    
     // Text Formatting Button
     QGroupBox *textFormattingGroup = new QGroupBox("Text Formatting");
     QVBoxLayout *textFormattingLayout = new QVBoxLayout(textFormattingGroup);
@@ -1287,6 +1318,11 @@ void SettingsDialog::populateDefaultBibleVersions()
     defaultBibleVersionCombo->setEnabled(defaultBibleVersionCombo->count() > 1);
 
     int index = defaultBibleVersionCombo->findData(defaultBibleTranslationPath);
+    if (index < 0 && !defaultBibleTranslationPath.isEmpty()) {
+        // A default saved as a copied-out XML now served from the bundled pack
+        index = defaultBibleVersionCombo->findText(QFileInfo(defaultBibleTranslationPath).baseName(),
+                                                   Qt::MatchFixedString);
+    }
     if (index < 0) {
         index = 0;
     }
@@ -1462,6 +1498,10 @@ void SettingsDialog::loadSettings()
     defaultBibleTranslationPath = settings.value("defaultBibleTranslationPath", defaultBibleTranslationPath).toString();
     if (defaultBibleVersionCombo) {
         int defaultIndex = defaultBibleVersionCombo->findData(defaultBibleTranslationPath);
+        if (defaultIndex < 0 && !defaultBibleTranslationPath.isEmpty()) {
+            defaultIndex = defaultBibleVersionCombo->findText(QFileInfo(defaultBibleTranslationPath).baseName(),
+                                                              Qt::MatchFixedString);
+        }
         if (defaultIndex < 0) {
             defaultIndex = 0;
         }
@@ -1592,6 +1632,18 @@ void SettingsDialog::loadSettings()
         }
     }
     
+    obsTranscodeVideosCheck->setChecked(settings.value("transcodeVideoProxies", false).toBool());
+    
+    QSize programStreamSize(settings.value("programStreamWidth", 1280).toInt(),
+                            settings.value("programStreamHeight", 720).toInt());
+    for (int i = 0; i < programStreamResolutionCombo->count(); ++i) {
+        if (programStreamResolutionCombo->itemData(i).toSize() == programStreamSize) {
+            programStreamResolutionCombo->setCurrentIndex(i);
+            break;
+        }
+    }
+    programStreamFpsSpinBox->setValue(settings.value("programStreamFps", 15).toInt());
+    
     QString obsTextFontFamily = settings.value("textFont", "Arial").toString();
     int obsTextPointSize = settings.value("textFontSize", 42).toInt();
     bool obsTextBold = settings.value("textBold", true).toBool();
@@ -1794,6 +1846,12 @@ void SettingsDialog::saveSettings()
     QSize resolution = obsResolutionCombo->currentData().toSize();
     settings.setValue("canvasWidth", resolution.width());
     settings.setValue("canvasHeight", resolution.height());
+    settings.setValue("transcodeVideoProxies", obsTranscodeVideosCheck->isChecked());
+
+    QSize programStreamSize = programStreamResolutionCombo->currentData().toSize();
+    settings.setValue("programStreamWidth", programStreamSize.width());
+    settings.setValue("programStreamHeight", programStreamSize.height());
+    settings.setValue("programStreamFps", programStreamFpsSpinBox->value());
 
     QFont obsTextFontToSave = fontFromControls(obsTextFontCombo,
                                               obsTextFontSizeSpinBox,
@@ -255,6 +255,11 @@ private:
     
     // OBS Canvas Resolution
     QComboBox *obsResolutionCombo;
+    QCheckBox *obsTranscodeVideosCheck;
+
+    // Program output stream
+    QComboBox *programStreamResolutionCombo;
+    QSpinBox *programStreamFpsSpinBox;
 };
 
 #endif // SETTINGSDIALOG_H
@@ -0,0 +1,548 @@
+#include "SongImporter.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QXmlStreamReader>
+
+namespace {
+
+const QStringList &sourceNameFilters()
+{
+    static const QStringList filters = {
+        "*.xml", "*.txt", "*.usr", "*.cho", "*.chordpro", "*.chopro", "*.crd", "*.pro"
+    };
+    return filters;
+}
+
+bool readLines(const QString &filePath, QStringList &lines, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = QString("Cannot open file: %1").arg(filePath);
+        }
+        return false;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        lines.append(in.readLine());
+    }
+    return true;
+}
+
+// "Verse 2", "CHORUS", "Pre-Chorus 1a" -> section type; empty when the
+// line is lyrics rather than a label
+QString sectionTypeForLabel(const QString &line)
+{
+    static const QRegularExpression label(
+        "^(verse|chorus|pre[- ]?chorus|bridge|tag|intro|ending|outro|interlude|"
+        "instrumental|refrain|vamp|coda|misc)\\s*\\d*[a-z]?\\s*:?$",
+        QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch match = label.match(line.trimmed());
+    if (!match.hasMatch()) {
+        return QString();
+    }
+    QString type = match.captured(1).toLower();
+    if (type.startsWith("pre")) {
+        return "pre-chorus";
+    }
+    if (type == "outro" || type == "coda") {
+        return "ending";
+    }
+    if (type == "refrain") {
+        return "chorus";
+    }
+    if (type == "misc" || type == "instrumental") {
+        return "other";
+    }
+    return type;
+}
+
+// Collects lines into sections; a section is only kept if it has lyrics
+struct SectionBuilder {
+    Song &song;
+    SongSection current;
+
+    explicit SectionBuilder(Song &target) : song(target) { current.type = "verse"; }
+
+    void addLine(const QString &line)
+    {
+        current.lines.append(line);
+    }
+
+    void finish(const QString &nextType = "verse")
+    {
+        if (!current.lines.isEmpty()) {
+            current.index = song.sections.size();
+            song.sections.append(current);
+        }
+        current = SongSection();
+        current.type = nextType;
+    }
+};
+
+void appendAuthor(Song &song, const QString &author)
+{
+    const QString trimmed = author.trimmed();
+    if (trimmed.isEmpty() || song.author.contains(trimmed)) {
+        return;
+    }
+    song.author = song.author.isEmpty() ? trimmed : QString("%1, %2").arg(song.author, trimmed);
+}
+
+QString digitsOf(const QString &text)
+{
+    QString digits;
+    for (const QChar ch : text) {
+        if (ch.isDigit()) {
+            digits.append(ch);
+        }
+    }
+    return digits;
+}
+
+bool finishSong(const QString &filePath, Song &song, QString *errorString)
+{
+    if (song.title.isEmpty()) {
+        song.title = QFileInfo(filePath).completeBaseName();
+    }
+    if (song.sections.isEmpty()) {
+        if (errorString) {
+            *errorString = QString("No content found in: %1").arg(filePath);
+        }
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SongImporter::Format SongImporter::detectFormat(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "cho" || suffix == "chordpro" || suffix == "chopro" || suffix == "crd" || suffix == "pro") {
+        return ChordProFormat;
+    }
+    if (suffix == "usr") {
+        return SongSelectFormat;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return UnknownFormat;
+    }
+
+    if (suffix == "xml") {
+        // OpenLyrics declares its namespace; older exports without it still
+        // open with <properties>, where native songs have <title>
+        QXmlStreamReader xml(&file);
+        if (!xml.readNextStartElement() || xml.name() != QLatin1String("song")) {
+            return UnknownFormat;
+        }
+        if (xml.namespaceUri().contains(QLatin1String("openlyrics"))) {
+            return OpenLyricsFormat;
+        }
+        if (xml.readNextStartElement() && xml.name() == QLatin1String("properties")) {
+            return OpenLyricsFormat;
+        }
+        return NativeFormat;
+    }
+
+    if (suffix == "txt") {
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            if (in.readLine().trimmed().startsWith(QLatin1String("CCLI Song #"), Qt::CaseInsensitive)) {
+                return SongSelectFormat;
+            }
+        }
+        return NativeFormat;
+    }
+
+    return UnknownFormat;
+}
+
+QString SongImporter::formatName(Format format)
+{
+    switch (format) {
+    case NativeFormat: return "SimplePresenter";
+    case OpenLyricsFormat: return "OpenLyrics";
+    case ChordProFormat: return "ChordPro";
+    case SongSelectFormat: return "CCLI SongSelect";
+    default: return "Unknown";
+    }
+}
+
+QString SongImporter::fileDialogFilter()
+{
+    return QString("Song files (%1);;OpenLyrics (*.xml);;ChordPro (*.cho *.chordpro *.chopro *.crd *.pro);;"
+                   "SongSelect (*.txt *.usr);;All files (*)")
+        .arg(sourceNameFilters().join(' '));
+}
+
+QStringList SongImporter::collectSources(const QStringList &paths)
+{
+    QStringList files;
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            files.append(info.absoluteFilePath());
+            continue;
+        }
+        QDirIterator it(path, sourceNameFilters(), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            files.append(it.next());
+        }
+    }
+    return files;
+}
+
+SongImporter::Result SongImporter::parseFile(const QString &filePath)
+{
+    Result result;
+    result.sourcePath = filePath;
+    result.format = detectFormat(filePath);
+
+    switch (result.format) {
+    case NativeFormat:
+        result.ok = SongManager::parseSongFile(filePath, result.song, &result.error);
+        result.song.filePath.clear();
+        break;
+    case OpenLyricsFormat:
+        result.ok = parseOpenLyrics(filePath, result.song, &result.error);
+        break;
+    case ChordProFormat:
+        result.ok = parseChordPro(filePath, result.song, &result.error);
+        break;
+    case SongSelectFormat:
+        if (QFileInfo(filePath).suffix().compare(QLatin1String("usr"), Qt::CaseInsensitive) == 0) {
+            result.ok = parseSongSelectUsr(filePath, result.song, &result.error);
+        } else {
+            result.ok = parseSongSelectText(filePath, result.song, &result.error);
+        }
+        break;
+    default:
+        result.error = QString("Unrecognised song format: %1").arg(filePath);
+        return result;
+    }
+    if (!result.ok) {
+        result.error = QString("%1: %2").arg(formatName(result.format), result.error);
+    }
+    return result;
+}
+
+bool SongImporter::parseOpenLyrics(const QString &filePath, Song &song, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = QString("Cannot open file: %1").arg(filePath);
+        }
+        return false;
+    }
+
+    QXmlStreamReader xml(&file);
+    SectionBuilder sections(song);
+    QString line;
+    bool inLines = false;
+    int skipDepth = 0; // inside <comment> or another element whose text is not lyrics
+
+    auto endLine = [&sections, &line]() {
+        const QString trimmed = line.simplified();
+        if (!trimmed.isEmpty()) {
+            sections.addLine(trimmed);
+        }
+        line.clear();
+    };
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isStartElement()) {
+            const QStringView name = xml.name();
+            if (inLines) {
+                if (name == QLatin1String("br")) {
+                    endLine();
+                } else if (skipDepth > 0 || name == QLatin1String("comment")) {
+                    ++skipDepth;
+                }
+                // <chord> and <tag> wrap lyrics in newer versions; keep their text
+            } else if (name == QLatin1String("title")) {
+                const QString title = xml.readElementText().trimmed();
+                if (song.title.isEmpty()) {
+                    song.title = title;
+                }
+            } else if (name == QLatin1String("author")) {
+                appendAuthor(song, xml.readElementText());
+            } else if (name == QLatin1String("copyright")) {
+                song.copyright = xml.readElementText().trimmed();
+            } else if (name == QLatin1String("ccliNo")) {
+                song.ccli = xml.readElementText().trimmed();
+            } else if (name == QLatin1String("verse")) {
+                // v1, c, b1, p, i, e, o: the letter gives the section type
+                const QString verseName = xml.attributes().value("name").toString().toLower();
+                QString type = "verse";
+                if (verseName.startsWith('c')) {
+                    type = "chorus";
+                } else if (verseName.startsWith('b')) {
+                    type = "bridge";
+                } else if (verseName.startsWith('p')) {
+                    type = "pre-chorus";
+                } else if (verseName.startsWith('i')) {
+                    type = "intro";
+                } else if (verseName.startsWith('e')) {
+                    type = "ending";
+                } else if (verseName.startsWith('o')) {
+                    type = "other";
+                }
+                sections.finish(type);
+            } else if (name == QLatin1String("lines")) {
+                inLines = true;
+            }
+        } else if (xml.isEndElement()) {
+            const QStringView name = xml.name();
+            if (inLines && skipDepth > 0) {
+                --skipDepth;
+            } else if (name == QLatin1String("lines")) {
+                endLine();
+                inLines = false;
+            } else if (name == QLatin1String("verse")) {
+                sections.finish();
+            }
+        } else if (xml.isCharacters() && inLines && skipDepth == 0) {
+            // Line breaks are <br/>; whitespace in the markup is formatting
+            line += xml.text().toString().replace('\n', ' ');
+        }
+    }
+    sections.finish();
+
+    if (xml.hasError()) {
+        if (errorString) {
+            *errorString = QString("XML error in %1: %2").arg(filePath).arg(xml.errorString());
+        }
+        return false;
+    }
+    return finishSong(filePath, song, errorString);
+}
+
+bool SongImporter::parseChordPro(const QString &filePath, Song &song, QString *errorString)
+{
+    QStringList lines;
+    if (!readLines(filePath, lines, errorString)) {
+        return false;
+    }
+
+    static const QRegularExpression chord("\\[[^\\]]*\\]");
+    SectionBuilder sections(song);
+    QString environment = "verse"; // type inside {start_of_*}, reused after blank lines
+    bool skipping = false;         // inside tab, grid or other non-lyric blocks
+
+    for (const QString &rawLine : lines) {
+        const QString trimmed = rawLine.trimmed();
+
+        if (trimmed.startsWith('{') && trimmed.endsWith('}')) {
+            const QString body = trimmed.mid(1, trimmed.size() - 2).trimmed();
+            const int colon = body.indexOf(':');
+            const QString directive = (colon < 0 ? body : body.left(colon)).trimmed().toLower();
+            const QString value = colon < 0 ? QString() : body.mid(colon + 1).trimmed();
+
+            if (directive.startsWith("start_of_") || directive == "soc" || directive == "sov"
+                || directive == "sob" || directive == "sot" || directive == "sog") {
+                const QString part = directive.startsWith("start_of_") ? directive.mid(9) : directive.mid(2);
+                if (part == "chorus" || part == "c") {
+                    environment = "chorus";
+                } else if (part == "bridge" || part == "b") {
+                    environment = "bridge";
+                } else if (part == "verse" || part == "v") {
+                    environment = "verse";
+                } else {
+                    skipping = true;
+                }
+                sections.finish(environment);
+            } else if (directive.startsWith("end_of_") || directive == "eoc" || directive == "eov"
+                       || directive == "eob" || directive == "eot" || directive == "eog") {
+                if (!skipping) {
+                    environment = "verse";
+                    sections.finish(environment);
+                }
+                skipping = false;
+            } else if (directive == "title" || directive == "t") {
+                if (song.title.isEmpty()) {
+                    song.title = value;
+                }
+            } else if (directive == "artist" || directive == "composer" || directive == "lyricist"
+                       || directive == "author") {
+                appendAuthor(song, value);
+            } else if (directive == "copyright") {
+                song.copyright = value;
+            } else if (directive == "ccli") {
+                song.ccli = digitsOf(value);
+            } else if (directive == "meta") {
+                // {meta: ccli 12345}, {meta: artist Name}
+                const int space = value.indexOf(' ');
+                const QString key = value.left(space).toLower();
+                const QString metaValue = space < 0 ? QString() : value.mid(space + 1).trimmed();
+                if (key == "title" && song.title.isEmpty()) {
+                    song.title = metaValue;
+                } else if (key == "artist" || key == "composer" || key == "lyricist") {
+                    appendAuthor(song, metaValue);
+                } else if (key == "copyright") {
+                    song.copyright = metaValue;
+                } else if (key == "ccli") {
+                    song.ccli = digitsOf(metaValue);
+                }
+            } else if (directive == "comment" || directive == "c" || directive == "ci"
+                       || directive == "comment_italic" || directive == "cb" || directive == "comment_box") {
+                // Many files label parts with comments: {c: Chorus}
+                const QString type = sectionTypeForLabel(value);
+                if (!type.isEmpty()) {
+                    sections.finish(type);
+                }
+            }
+            continue;
+        }
+
+        if (skipping || trimmed.startsWith('#')) {
+            continue;
+        }
+        if (trimmed.isEmpty()) {
+            sections.finish(environment);
+            continue;
+        }
+
+        const QString lyric = QString(trimmed).remove(chord).simplified();
+        if (!lyric.isEmpty()) {
+            sections.addLine(lyric);
+        }
+    }
+    sections.finish();
+
+    return finishSong(filePath, song, errorString);
+}
+
+bool SongImporter::parseSongSelectText(const QString &filePath, Song &song, QString *errorString)
+{
+    QStringList lines;
+    if (!readLines(filePath, lines, errorString)) {
+        return false;
+    }
+
+    // Title, blank line, labelled stanzas, then the licence footer:
+    //   CCLI Song # 22025
+    //   John Newton
+    //   © Words: Public Domain
+    //   CCLI License # ...
+    int i = 0;
+    while (i < lines.size() && lines[i].trimmed().isEmpty()) {
+        ++i;
+    }
+    if (i < lines.size()) {
+        song.title = lines[i++].trimmed();
+    }
+
+    SectionBuilder sections(song);
+    bool atBlockStart = true;
+    for (; i < lines.size(); ++i) {
+        const QString trimmed = lines[i].trimmed();
+        if (trimmed.startsWith(QLatin1String("CCLI Song #"), Qt::CaseInsensitive)) {
+            break;
+        }
+        if (trimmed.isEmpty()) {
+            sections.finish();
+            atBlockStart = true;
+            continue;
+        }
+        if (atBlockStart) {
+            atBlockStart = false;
+            const QString type = sectionTypeForLabel(trimmed);
+            if (!type.isEmpty()) {
+                sections.current.type = type;
+                continue;
+            }
+        }
+        sections.addLine(trimmed);
+    }
+    sections.finish();
+
+    if (i < lines.size()) {
+        song.ccli = digitsOf(lines[i++]);
+        bool authorsRead = false;
+        for (; i < lines.size(); ++i) {
+            const QString trimmed = lines[i].trimmed();
+            if (trimmed.isEmpty()) {
+                continue;
+            }
+            if (trimmed.startsWith(QLatin1String("CCLI Licen"), Qt::CaseInsensitive)
+                || trimmed.startsWith(QLatin1String("For use solely"), Qt::CaseInsensitive)) {
+                break;
+            }
+            if (trimmed.startsWith(QChar(0x00A9)) || trimmed.startsWith(QLatin1String("Copyright"), Qt::CaseInsensitive)) {
+                song.copyright = song.copyright.isEmpty() ? trimmed : QString("%1; %2").arg(song.copyright, trimmed);
+            } else if (!authorsRead) {
+                for (const QString &author : trimmed.split('|')) {
+                    appendAuthor(song, author);
+                }
+                authorsRead = true;
+            }
+        }
+    }
+
+    return finishSong(filePath, song, errorString);
+}
+
+bool SongImporter::parseSongSelectUsr(const QString &filePath, Song &song, QString *errorString)
+{
+    QStringList lines;
+    if (!readLines(filePath, lines, errorString)) {
+        return false;
+    }
+
+    // INI-like, but values use literal "/t" and "/n" as separators, so it
+    // is read by hand rather than through QSettings
+    QString fields;
+    QString words;
+    for (const QString &line : lines) {
+        const QString trimmed = line.trimmed();
+        if (trimmed.startsWith(QLatin1String("[S "))) {
+            song.ccli = digitsOf(trimmed);
+            continue;
+        }
+        const int equals = trimmed.indexOf('=');
+        if (equals < 0) {
+            continue;
+        }
+        const QString key = trimmed.left(equals).toLower();
+        const QString value = trimmed.mid(equals + 1);
+        if (key == "title") {
+            song.title = value.trimmed();
+        } else if (key == "author") {
+            for (const QString &author : value.split('|')) {
+                appendAuthor(song, author);
+            }
+        } else if (key == "copyright") {
+            song.copyright = value.trimmed();
+        } else if (key == "fields") {
+            fields = value;
+        } else if (key == "words") {
+            words = value;
+        }
+    }
+
+    const QStringList labels = fields.split(QLatin1String("/t"));
+    const QStringList stanzas = words.split(QLatin1String("/t"));
+    SectionBuilder sections(song);
+    for (int s = 0; s < stanzas.size(); ++s) {
+        const QString type = s < labels.size() ? sectionTypeForLabel(labels[s]) : QString();
+        sections.current.type = type.isEmpty() ? "verse" : type;
+        for (const QString &lyric : stanzas[s].split(QLatin1String("/n"))) {
+            const QString trimmed = lyric.trimmed();
+            if (!trimmed.isEmpty()) {
+                sections.addLine(trimmed);
+            }
+        }
+        sections.finish();
+    }
+
+    return finishSong(filePath, song, errorString);
+}
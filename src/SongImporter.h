@@ -0,0 +1,60 @@
+#ifndef SONGIMPORTER_H
+#define SONGIMPORTER_H
+
+#include <QString>
+#include <QStringList>
+#include "SongManager.h"
+
+// Reads songs exported by other presentation and lyric software:
+//
+//   OpenLyrics XML   - <song xmlns="http://openlyrics.info/...">, with
+//                      <br/>, chords and comments inside <lines>
+//   ChordPro         - .cho/.chordpro/.chopro/.pro/.crd, {directives} and
+//                      inline [chords], which are dropped
+//   SongSelect       - CCLI's plain-text export (.txt ending in the
+//                      "CCLI Song #" footer) and the older .usr files
+//
+// plus the app's own XML and plain-text songs. Parsing is reentrant and
+// touches no shared state, so many files can be parsed on the thread pool
+// at once; adding the results to the library is SongManager::addSongs.
+class SongImporter
+{
+public:
+    enum Format {
+        UnknownFormat,
+        NativeFormat,
+        OpenLyricsFormat,
+        ChordProFormat,
+        SongSelectFormat
+    };
+
+    struct Result {
+        QString sourcePath;
+        Format format = UnknownFormat;
+        bool ok = false;
+        Song song;
+        QString error;
+    };
+
+    static Format detectFormat(const QString &filePath);
+    static QString formatName(Format format);
+
+    // File dialog filter for the formats parseFile understands
+    static QString fileDialogFilter();
+
+    // Files and directories (searched recursively) expanded to the song
+    // files inside them
+    static QStringList collectSources(const QStringList &paths);
+
+    // Detect the format of one file and parse it. The song's filePath is
+    // left empty; it is assigned when the song is written to the library.
+    static Result parseFile(const QString &filePath);
+
+private:
+    static bool parseOpenLyrics(const QString &filePath, Song &song, QString *errorString);
+    static bool parseChordPro(const QString &filePath, Song &song, QString *errorString);
+    static bool parseSongSelectText(const QString &filePath, Song &song, QString *errorString);
+    static bool parseSongSelectUsr(const QString &filePath, Song &song, QString *errorString);
+};
+
+#endif // SONGIMPORTER_H
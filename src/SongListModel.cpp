@@ -0,0 +1,115 @@
+#include "SongListModel.h"
+#include <QHash>
+
+SongListModel::SongListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void SongListModel::setSongs(const QVector<SongHandle> &songs)
+{
+    QHash<int, int> newRowById;
+    newRowById.reserve(songs.size());
+    for (int i = 0; i < songs.size(); ++i) {
+        newRowById.insert(songs[i]->id, i);
+    }
+
+    // Drop rows that are gone, a run at a time from the bottom
+    for (int row = rows.size() - 1; row >= 0; --row) {
+        if (newRowById.contains(rows[row]->id)) {
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && !newRowById.contains(rows[row - 1]->id)) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        rows.remove(row, last - row + 1);
+        endRemoveRows();
+    }
+
+    // What is left must keep its order (a renamed song that sorts
+    // elsewhere, or a re-ranked search, does not); otherwise start over
+    int previous = -1;
+    for (const SongHandle &song : rows) {
+        const int newRow = newRowById.value(song->id);
+        if (newRow < previous) {
+            beginResetModel();
+            rows = songs;
+            endResetModel();
+            return;
+        }
+        previous = newRow;
+    }
+
+    // Remaining rows are now a subsequence of songs: insert the runs
+    // between them and pick up edited songs
+    int i = 0;
+    while (i < songs.size()) {
+        if (i < rows.size() && rows[i]->id == songs[i]->id) {
+            if (rows[i] != songs[i]) {
+                rows[i] = songs[i];
+                const QModelIndex changed = index(i);
+                emit dataChanged(changed, changed);
+            }
+            ++i;
+            continue;
+        }
+        int end = i;
+        while (end < songs.size() && !(i < rows.size() && rows[i]->id == songs[end]->id)) {
+            ++end;
+        }
+        beginInsertRows(QModelIndex(), i, end - 1);
+        rows.insert(i, end - i, SongHandle());
+        for (int j = i; j < end; ++j) {
+            rows[j] = songs[j];
+        }
+        endInsertRows();
+        i = end;
+    }
+}
+
+SongHandle SongListModel::songAt(int row) const
+{
+    return row >= 0 && row < rows.size() ? rows[row] : SongHandle();
+}
+
+QModelIndex SongListModel::indexOfSong(int songId) const
+{
+    for (int i = 0; i < rows.size(); ++i) {
+        if (rows[i]->id == songId) {
+            return index(i);
+        }
+    }
+    return QModelIndex();
+}
+
+int SongListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant SongListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+
+    const SongHandle &song = rows[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+        return song->title;
+    case Qt::UserRole:
+        return song->id;
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags SongListModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+}
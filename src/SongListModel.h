@@ -0,0 +1,34 @@
+#ifndef SONGLISTMODEL_H
+#define SONGLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "SongManager.h"
+
+// Song titles for the song panel: the whole library or search results.
+// Rows share the library's song handles; Qt::UserRole holds the song ID.
+//
+// setSongs() works out what changed against the rows already shown, so a
+// rescan that touched one file, or a search narrowed by another letter,
+// reaches the view as a few row inserts, removals and changes instead of
+// a rebuilt list, and the selection stays where it was.
+class SongListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit SongListModel(QObject *parent = nullptr);
+
+    void setSongs(const QVector<SongHandle> &songs);
+    SongHandle songAt(int row) const;
+    QModelIndex indexOfSong(int songId) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    QVector<SongHandle> rows;
+};
+
+#endif // SONGLISTMODEL_H
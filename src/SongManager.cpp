@@ -4,51 +4,57 @@
 #include <QFileInfo>
 #include <QTextStream>
 #include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
 
-SongManager::SongManager(QObject *parent)
-    : QObject(parent)
+// Catalog serialisation. File-static rather than in the anonymous namespace
+// so QVector<SongSection>'s stream operator finds them through ADL.
+static QDataStream &operator<<(QDataStream &out, const SongSection &section)
 {
+    return out << qint32(section.index) << section.type << section.lines;
 }
-SongManager::~SongManager()
+
+static QDataStream &operator>>(QDataStream &in, SongSection &section)
 {
+    qint32 index = 0;
+    in >> index >> section.type >> section.lines;
+    section.index = index;
+    return in;
 }
 
-void SongManager::loadSongsFromDirectory(const QString &dirPath)
+static QDataStream &operator<<(QDataStream &out, const Song &song)
 {
-    songs.clear();
-    
-    QDir dir(dirPath);
-    if (!dir.exists()) {
-        emit songLoadError(QString("Directory does not exist: %1").arg(dirPath));
-        return;
-    }
-    
-    QStringList filters;
-    filters << "*.xml" << "*.txt";  // Support both XML and TXT files
-    
-    QFileInfoList files = dir.entryInfoList(filters, QDir::Files);
-    int loadedCount = 0;
-    
-    for (const QFileInfo &fileInfo : files) {
-        if (loadSong(fileInfo.absoluteFilePath())) {
-            loadedCount++;
-        }
-    }
-    
-    emit songsLoaded(loadedCount);
+    return out << qint32(song.id) << song.title << song.author << song.copyright << song.ccli << song.filePath << song.sections;
 }
 
-bool SongManager::loadSong(const QString &filePath)
+static QDataStream &operator>>(QDataStream &in, Song &song)
+{
+    qint32 id = 0;
+    in >> id;
+    song.id = id;
+    return in >> song.title >> song.author >> song.copyright >> song.ccli >> song.filePath >> song.sections;
+}
+
+namespace {
+
+// Bump when the catalog layout or the way songs are parsed changes, so
+// stale catalogs are rebuilt instead of misread
+static const quint32 kCatalogMagic = 0x53505343; // "SPSC"
+static const quint32 kCatalogVersion = 2;
+
+// Debounce bursts of directory events (a sync tool copying many files)
+static const int kRescanDelayMs = 300;
+
+bool parseXmlSong(QFile &file, Song &song, QString *errorString)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        emit songLoadError(QString("Cannot open file: %1").arg(filePath));
-        return false;
-    }
-    
-    Song song;
-    song.filePath = filePath;
-    
     QXmlStreamReader xml(&file);
     
     SongSection currentSection;
@@ -78,67 +84,588 @@ bool SongManager::loadSong(const QString &filePath)
             } else if (name == "line") {
                 currentSection.lines.append(xml.readElementText());
             }
-        } else if (xml.isEndElement() && xml.name() == "section") {
+        } else if (xml.isEndElement() && xml.name() == QLatin1String("section")) {
             if (!currentSection.lines.isEmpty()) {
                 song.sections.append(currentSection);
             }
         }
     }
     
-    file.close();
-    
     if (xml.hasError()) {
-        emit songLoadError(QString("XML error in %1: %2").arg(filePath).arg(xml.errorString()));
+        if (errorString) {
+            *errorString = QString("XML error in %1: %2").arg(file.fileName()).arg(xml.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+// Plain-text songs: one stanza per block of lines, blocks separated by
+// blank lines. The file name is the title ("Amazing_Grace.txt").
+bool parseTextSong(QFile &file, Song &song)
+{
+    QTextStream in(&file);
+    SongSection currentSection;
+    currentSection.type = "verse";
+
+    auto finishSection = [&song, &currentSection]() {
+        if (!currentSection.lines.isEmpty()) {
+            currentSection.index = song.sections.size();
+            song.sections.append(currentSection);
+            currentSection.lines.clear();
+        }
+    };
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty()) {
+            finishSection();
+        } else {
+            currentSection.lines.append(line);
+        }
+    }
+    finishSection();
+
+    song.title = QFileInfo(file.fileName()).completeBaseName().replace(QLatin1Char('_'), QLatin1Char(' '));
+    return true;
+}
+
+bool songTitleLessThan(const SongHandle &a, const SongHandle &b)
+{
+    const int order = a->title.compare(b->title, Qt::CaseInsensitive);
+    return order != 0 ? order < 0 : a->id < b->id;
+}
+
+} // namespace
+
+SongManager::SongManager(QObject *parent)
+    : QObject(parent)
+    , watcher(new QFileSystemWatcher(this))
+    , rescanTimer(new QTimer(this))
+{
+    rescanTimer->setSingleShot(true);
+    rescanTimer->setInterval(kRescanDelayMs);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, rescanTimer, qOverload<>(&QTimer::start));
+    connect(rescanTimer, &QTimer::timeout, this, [this]() {
+        if (rescanDirectory()) {
+            emit songsLoaded(songsById.size());
+        }
+    });
+}
+SongManager::~SongManager()
+{
+}
+
+void SongManager::loadSongsFromDirectory(const QString &dirPath)
+{
+    QDir dir(dirPath);
+    if (!dir.exists()) {
+        catalog.clear();
+        searchIndex.clear();
+        rebuildLibrary();
+        emit songLoadError(QString("Directory does not exist: %1").arg(dirPath));
+        return;
+    }
+
+    const QString absolutePath = dir.absolutePath();
+    if (absolutePath != songsDirectory) {
+        if (!songsDirectory.isEmpty()) {
+            watcher->removePath(songsDirectory);
+        }
+        songsDirectory = absolutePath;
+        catalog.clear();
+        // IDs are reused from 1; postings of the old library must go too
+        searchIndex.clear();
+        nextSongId = 1;
+        loadCatalog();
+        rebuildLibrary();
+        // Edits made in place by other programs do not always touch the
+        // directory; those show up on the next refresh instead
+        watcher->addPath(songsDirectory);
+    }
+
+    rescanDirectory();
+    emit songsLoaded(songsById.size());
+}
+
+bool SongManager::rescanDirectory()
+{
+    if (songsDirectory.isEmpty()) {
         return false;
     }
+
+    QStringList filters;
+    filters << "*.xml" << "*.txt";  // Support both XML and TXT files
     
+    // Only stat the files; unchanged ones keep their cataloged song
+    const QFileInfoList files = QDir(songsDirectory).entryInfoList(filters, QDir::Files);
+    QHash<QString, CatalogEntry> scanned;
+    scanned.reserve(files.size());
+    bool changed = false;
+
+    for (const QFileInfo &fileInfo : files) {
+        const QString filePath = fileInfo.absoluteFilePath();
+        const qint64 size = fileInfo.size();
+        const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        auto cached = catalog.constFind(filePath);
+        if (cached != catalog.constEnd() && cached->size == size && cached->modified == modified) {
+            scanned.insert(filePath, cached.value());
+            continue;
+        }
+
+        // A file edited elsewhere keeps its ID; only new files get one
+        CatalogEntry entry;
+        entry.size = size;
+        entry.modified = modified;
+        entry.songId = cached != catalog.constEnd() ? cached->songId : nextSongId++;
+        Song song;
+        QString error;
+        if (parseSongFile(filePath, song, &error)) {
+            song.id = entry.songId;
+            entry.song = std::make_shared<const Song>(std::move(song));
+            searchIndex.addSong(*entry.song);
+        } else {
+            searchIndex.removeSong(entry.songId);
+            emit songLoadError(error);
+        }
+        scanned.insert(filePath, entry);
+        changed = true;
+    }
+
+    for (auto it = catalog.constBegin(); it != catalog.constEnd(); ++it) {
+        if (!scanned.contains(it.key())) {
+            searchIndex.removeSong(it->songId);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        catalog = scanned;
+        rebuildLibrary();
+        saveCatalog();
+    }
+    return changed;
+}
+
+void SongManager::rebuildLibrary()
+{
+    // Handles are shared, so this only copies pointers
+    songsById.clear();
+    songsByTitle.clear();
+    songsByTitle.reserve(catalog.size());
+    for (auto it = catalog.constBegin(); it != catalog.constEnd(); ++it) {
+        if (it->song) {
+            songsById.insert(it->songId, it->song);
+            songsByTitle.append(it->song);
+        }
+    }
+    std::sort(songsByTitle.begin(), songsByTitle.end(), songTitleLessThan);
+
+    if (searchIndex.isEmpty()) {
+        for (const SongHandle &song : songsByTitle) {
+            searchIndex.addSong(*song);
+        }
+    }
+}
+
+QString SongManager::catalogFilePath() const
+{
+    const QString baseDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (baseDir.isEmpty()) {
+        return QString();
+    }
+    QDir dir(baseDir);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    return dir.filePath("song-catalog.dat");
+}
+
+void SongManager::loadCatalog()
+{
+    const QString path = catalogFilePath();
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString directory;
+    qint32 storedNextId = 1;
+    quint32 count = 0;
+    in >> magic >> version >> directory >> storedNextId >> count;
+    if (magic != kCatalogMagic || version != kCatalogVersion || directory != songsDirectory) {
+        return;
+    }
+
+    QHash<QString, CatalogEntry> loaded;
+    loaded.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        CatalogEntry entry;
+        qint32 songId = 0;
+        bool valid = false;
+        in >> filePath >> entry.size >> entry.modified >> songId >> valid;
+        entry.songId = songId;
+        if (valid) {
+            Song song;
+            in >> song;
+            entry.song = std::make_shared<const Song>(std::move(song));
+        }
+        loaded.insert(filePath, entry);
+    }
+    if (in.status() == QDataStream::Ok) {
+        catalog = loaded;
+        nextSongId = storedNextId;
+    }
+}
+
+void SongManager::saveCatalog() const
+{
+    const QString path = catalogFilePath();
+    if (path.isEmpty()) {
+        return;
+    }
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kCatalogMagic << kCatalogVersion << songsDirectory << qint32(nextSongId) << quint32(catalog.size());
+    for (auto it = catalog.constBegin(); it != catalog.constEnd(); ++it) {
+        const bool valid = it->song != nullptr;
+        out << it.key() << it->size << it->modified << qint32(it->songId) << valid;
+        if (valid) {
+            out << *it->song;
+        }
+    }
+    file.commit();
+}
+
+bool SongManager::parseSongFile(const QString &filePath, Song &song, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = QString("Cannot open file: %1").arg(filePath);
+        }
+        return false;
+    }
+
+    song = Song();
+    song.filePath = filePath;
+
+    const bool isText = QFileInfo(filePath).suffix().compare(QLatin1String("txt"), Qt::CaseInsensitive) == 0;
+    if (isText) {
+        parseTextSong(file, song);
+    } else if (!parseXmlSong(file, song, errorString)) {
+        return false;
+    }
+
     if (song.title.isEmpty()) {
         song.title = QFileInfo(filePath).baseName();
     }
     
     if (song.sections.isEmpty()) {
-        emit songLoadError(QString("No content found in: %1").arg(filePath));
+        if (errorString) {
+            *errorString = QString("No content found in: %1").arg(filePath);
+        }
         return false;
     }
-    
-    songs[song.title] = song;
     return true;
 }
 
-QStringList SongManager::getSongTitles() const
+bool SongManager::loadSong(const QString &filePath)
 {
-    QStringList titles = songs.keys();
-    titles.sort(Qt::CaseInsensitive);
-    return titles;
+    Song song;
+    QString error;
+    if (!parseSongFile(filePath, song, &error)) {
+        emit songLoadError(error);
+        return false;
+    }
+    auto existing = catalog.constFind(QFileInfo(filePath).absoluteFilePath());
+    song.id = existing != catalog.constEnd() ? existing->songId : 0;
+    publish(song, filePath);
+    rebuildLibrary();
+    return true;
 }
 
-Song SongManager::getSong(const QString &title) const
+SongHandle SongManager::publish(Song song, const QString &filePath)
 {
-    if (songs.contains(title)) {
-        return songs[title];
+    if (song.id <= 0) {
+        song.id = nextSongId++;
+    }
+    song.filePath = filePath;
+
+    const QFileInfo fileInfo(filePath);
+    CatalogEntry entry;
+    entry.size = fileInfo.size();
+    entry.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    entry.songId = song.id;
+    entry.song = std::make_shared<const Song>(std::move(song));
+    catalog.insert(fileInfo.absoluteFilePath(), entry);
+
+    searchIndex.addSong(*entry.song);
+    return entry.song;
+}
+
+QString SongManager::songKey(const Song &song)
+{
+    QString ccli;
+    for (const QChar ch : song.ccli) {
+        if (ch.isDigit()) {
+            ccli.append(ch);
+        }
+    }
+    return SongSearchIndex::tokenize(song.title).join(' ') + QLatin1Char('|') + ccli;
+}
+
+QJsonObject SongManager::songToJson(const Song &song)
+{
+    QJsonArray sections;
+    for (const SongSection &section : song.sections) {
+        QJsonObject sectionObj;
+        sectionObj["type"] = section.type;
+        sectionObj["lines"] = QJsonArray::fromStringList(section.lines);
+        sections.append(sectionObj);
+    }
+
+    QJsonObject json;
+    json["title"] = song.title;
+    json["author"] = song.author;
+    json["copyright"] = song.copyright;
+    json["ccli"] = song.ccli;
+    json["sections"] = sections;
+    return json;
+}
+
+Song SongManager::songFromJson(const QJsonObject &json)
+{
+    Song song;
+    song.title = json.value("title").toString();
+    song.author = json.value("author").toString();
+    song.copyright = json.value("copyright").toString();
+    song.ccli = json.value("ccli").toString();
+    for (const QJsonValue &value : json.value("sections").toArray()) {
+        const QJsonObject sectionObj = value.toObject();
+        SongSection section;
+        section.index = song.sections.size();
+        section.type = sectionObj.value("type").toString("verse");
+        for (const QJsonValue &line : sectionObj.value("lines").toArray()) {
+            section.lines.append(line.toString());
+        }
+        song.sections.append(section);
+    }
+    return song;
+}
+
+QString SongManager::uniqueSongFileName(const QString &title) const
+{
+    // Titles come from other programs' files too; keep them valid file
+    // names on every platform
+    static const QString reserved = QStringLiteral("\\/:*?\"<>|");
+    QString baseName = title.trimmed();
+    for (QChar &ch : baseName) {
+        if (reserved.contains(ch) || ch.unicode() < 0x20) {
+            ch = QLatin1Char('_');
+        }
+    }
+    if (baseName.isEmpty()) {
+        baseName = "Untitled";
+    }
+
+    // Two songs may share a title; never overwrite another song's file
+    const QDir dir(songsDirectory);
+    QString fileName = dir.filePath(QString("%1.xml").arg(baseName));
+    for (int n = 2; QFile::exists(fileName); ++n) {
+        fileName = dir.filePath(QString("%1 (%2).xml").arg(baseName).arg(n));
     }
-    return Song();
+    return fileName;
 }
 
-QStringList SongManager::searchSongs(const QString &searchText) const
+bool SongManager::writeSongFile(const Song &song, const QString &fileName, QString *errorString)
 {
-    QStringList results;
-    QString lowerSearch = searchText.toLower();
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = QString("Cannot write file: %1").arg(fileName);
+        }
+        return false;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
     
-    for (auto it = songs.constBegin(); it != songs.constEnd(); ++it) {
-        if (it.key().toLower().contains(lowerSearch)) {
-            results.append(it.key());
+    xml.writeStartElement("song");
+    xml.writeTextElement("title", song.title);
+    xml.writeTextElement("author", song.author);
+    xml.writeTextElement("copyright", song.copyright);
+    xml.writeTextElement("ccli", song.ccli);
+    
+    xml.writeStartElement("lyrics");
+    for (const SongSection &section : song.sections) {
+        xml.writeStartElement("section");
+        xml.writeAttribute("type", section.type);
+        for (const QString &line : section.lines) {
+            xml.writeTextElement("line", line);
         }
+        xml.writeEndElement(); // section
     }
+    xml.writeEndElement(); // lyrics
     
-    results.sort(Qt::CaseInsensitive);
-    return results;
+    xml.writeEndElement(); // song
+    xml.writeEndDocument();
+
+    if (!file.commit()) {
+        if (errorString) {
+            *errorString = QString("Cannot write file: %1").arg(fileName);
+        }
+        return false;
+    }
+    return true;
+}
+
+int SongManager::saveSong(const Song &song, QString *errorString)
+{
+    if (songsDirectory.isEmpty()) {
+        if (errorString) {
+            *errorString = QString("No songs directory loaded");
+        }
+        return 0;
+    }
+
+    // An edit rewrites the song's own file, so renaming a song no longer
+    // moves files around. Editing a text song replaces its .txt file with
+    // an XML one, which would otherwise be listed twice.
+    const SongHandle previous = song.id > 0 ? songsById.value(song.id) : SongHandle();
+    QString fileName;
+    if (previous && QFileInfo(previous->filePath).suffix().compare(QLatin1String("xml"), Qt::CaseInsensitive) == 0) {
+        fileName = previous->filePath;
+    } else {
+        fileName = uniqueSongFileName(song.title);
+    }
+
+    if (!writeSongFile(song, fileName, errorString)) {
+        return 0;
+    }
+    if (previous && previous->filePath != fileName) {
+        QFile::remove(previous->filePath);
+        catalog.remove(QFileInfo(previous->filePath).absoluteFilePath());
+    }
+
+    // Update the catalog and search index now rather than waiting for the
+    // directory watcher; its rescan then finds nothing new
+    Song saved = song;
+    saved.id = previous ? song.id : 0;
+    const SongHandle handle = publish(saved, fileName);
+    rebuildLibrary();
+    saveCatalog();
+    emit songsLoaded(songsById.size());
+    return handle->id;
 }
 
-QString SongManager::getSongFilePath(const QString &title) const
+bool SongManager::deleteSong(int songId, QString *errorString)
 {
-    if (songs.contains(title)) {
-        return songs[title].filePath;
+    const SongHandle existing = songsById.value(songId);
+    if (!existing || !QFile::remove(existing->filePath)) {
+        if (errorString) {
+            *errorString = QString("Cannot delete song file: %1").arg(existing ? existing->filePath : QString());
+        }
+        return false;
     }
-    return QString();
+
+    catalog.remove(QFileInfo(existing->filePath).absoluteFilePath());
+    searchIndex.removeSong(songId);
+    rebuildLibrary();
+    saveCatalog();
+    emit songsLoaded(songsById.size());
+    return true;
+}
+
+int SongManager::addSongs(const QVector<Song> &newSongs, int *duplicates, QStringList *errors)
+{
+    if (songsDirectory.isEmpty()) {
+        if (errors) {
+            errors->append(QString("No songs directory loaded"));
+        }
+        return 0;
+    }
+
+    QSet<QString> keys;
+    keys.reserve(songsById.size() + newSongs.size());
+    for (const SongHandle &song : songsByTitle) {
+        keys.insert(songKey(*song));
+    }
+
+    int added = 0;
+    for (const Song &song : newSongs) {
+        const QString key = songKey(song);
+        if (keys.contains(key)) {
+            if (duplicates) {
+                ++*duplicates;
+            }
+            continue;
+        }
+
+        const QString fileName = uniqueSongFileName(song.title);
+        QString error;
+        if (!writeSongFile(song, fileName, &error)) {
+            if (errors) {
+                errors->append(error);
+            }
+            continue;
+        }
+        keys.insert(key);
+        Song imported = song;
+        imported.id = 0;
+        publish(imported, fileName);
+        ++added;
+    }
+
+    if (added > 0) {
+        rebuildLibrary();
+        saveCatalog();
+        emit songsLoaded(songsById.size());
+    }
+    return added;
+}
+
+SongHandle SongManager::song(int songId) const
+{
+    return songsById.value(songId);
+}
+
+SongHandle SongManager::songByTitle(const QString &title) const
+{
+    for (const SongHandle &song : songsByTitle) {
+        if (song->title == title) {
+            return song;
+        }
+    }
+    return SongHandle();
+}
+
+QVector<SongHandle> SongManager::allSongs() const
+{
+    return songsByTitle;
+}
+
+QVector<SongHandle> SongManager::searchSongs(const QString &searchText) const
+{
+    const QVector<int> ids = searchIndex.search(searchText);
+    QVector<SongHandle> results;
+    results.reserve(ids.size());
+    for (int id : ids) {
+        if (const SongHandle song = songsById.value(id)) {
+            results.append(song);
+        }
+    }
+    return results;
 }
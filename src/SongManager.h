@@ -6,6 +6,13 @@
 #include <QStringList>
 #include <QVector>
 #include <QMap>
+#include <QHash>
+#include <QJsonObject>
+#include <memory>
+#include "SongSearchIndex.h"
+
+class QFileSystemWatcher;
+class QTimer;
 
 struct SongSection {
     int index;
@@ -18,6 +25,7 @@ struct SongSection {
 };
 
 struct Song {
+    int id = 0;  // stable library ID, 0 until the song is in the library
     QString title;
     QString author;
     QString copyright;
@@ -26,6 +34,12 @@ struct Song {
     QVector<SongSection> sections;
 };
 
+// Songs in the library are immutable and shared: every panel, playlist
+// entry and search result holding a song holds the same object. Editing
+// means building a new Song (copy, change, saveSong) which replaces the
+// library's handle; existing holders keep the version they had.
+using SongHandle = std::shared_ptr<const Song>;
+
 class SongManager : public QObject
 {
     Q_OBJECT
@@ -34,30 +48,84 @@ public:
     explicit SongManager(QObject *parent = nullptr);
     ~SongManager();
     
-    // Load all songs from directory
+    // Load all songs from directory. Only files that are new or whose size
+    // or modification time changed since the last scan are parsed; the rest
+    // come from a catalog persisted in the app data folder. The directory is
+    // then watched and rescanned the same way whenever it changes.
     void loadSongsFromDirectory(const QString &dirPath = "data/songs");
     
     // Load single song
     bool loadSong(const QString &filePath);
+
+    // Parse an XML song or a plain-text song (stanzas separated by blank
+    // lines, titled after the file name)
+    static bool parseSongFile(const QString &filePath, Song &song, QString *errorString = nullptr);
     
-    // Get list of song titles
-    QStringList getSongTitles() const;
-    
-    // Get song by title
-    Song getSong(const QString &title) const;
-    
-    // Search songs by title
-    QStringList searchSongs(const QString &searchText) const;
+    // Write song as XML and publish it. A song with the ID of one in the
+    // library replaces it in its existing file, whatever its title; any
+    // other song is added under a new ID and file. Returns the song's ID,
+    // or 0 on failure.
+    int saveSong(const Song &song, QString *errorString = nullptr);
+    bool deleteSong(int songId, QString *errorString = nullptr);
+
+    // Write a batch of imported songs into the songs directory, skipping
+    // any whose songKey is already in the library (or earlier in the
+    // batch). The catalog is saved and songsLoaded emitted once per batch.
+    // Returns the number of songs added.
+    int addSongs(const QVector<Song> &newSongs, int *duplicates = nullptr, QStringList *errors = nullptr);
+
+    // Identity used to spot duplicates across formats: the title reduced to
+    // lower-case words plus the CCLI number's digits
+    static QString songKey(const Song &song);
+
+    // Song with its sections as JSON, for files that carry songs with them
+    // (service bundles). The ID and file path are not included.
+    static QJsonObject songToJson(const Song &song);
+    static Song songFromJson(const QJsonObject &json);
+
+    // nullptr when there is no such song
+    SongHandle song(int songId) const;
+    // First song with this exact title, for references saved before songs
+    // had IDs
+    SongHandle songByTitle(const QString &title) const;
+
+    // All songs ordered by title
+    QVector<SongHandle> allSongs() const;
+    int songCount() const { return songsById.size(); }
     
-    // Get song file path
-    QString getSongFilePath(const QString &title) const;
+    // Full-text search over titles, lyrics, author, copyright and CCLI
+    // number (see SongSearchIndex), best matches first
+    QVector<SongHandle> searchSongs(const QString &searchText) const;
 
 signals:
     void songsLoaded(int count);
     void songLoadError(const QString &error);
 
 private:
-    QMap<QString, Song> songs; // title -> song
+    struct CatalogEntry {
+        qint64 size = 0;
+        qint64 modified = 0; // ms since epoch
+        int songId = 0;      // kept while the file fails to parse, so a fix keeps the ID
+        SongHandle song;     // nullptr: the file failed to parse; skip it until it changes
+    };
+
+    bool rescanDirectory();
+    SongHandle publish(Song song, const QString &filePath);
+    QString uniqueSongFileName(const QString &title) const;
+    static bool writeSongFile(const Song &song, const QString &fileName, QString *errorString);
+    void rebuildLibrary();
+    QString catalogFilePath() const;
+    void loadCatalog();
+    void saveCatalog() const;
+
+    QHash<QString, CatalogEntry> catalog;  // absolute file path -> parsed song
+    QHash<int, SongHandle> songsById;
+    QVector<SongHandle> songsByTitle;      // sorted, rebuilt when the library changes
+    SongSearchIndex searchIndex;
+    int nextSongId = 1;
+    QString songsDirectory;
+    QFileSystemWatcher *watcher;
+    QTimer *rescanTimer;
 };
 
 #endif // SONGMANAGER_H
@@ -7,9 +7,23 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QFile>
-#include <QXmlStreamWriter>
 #include <QDir>
 #include <QStandardPaths>
+#include <QFileDialog>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <memory>
+#include "SongImporter.h"
+#include "SongListModel.h"
+
+namespace {
+
+// Parsed songs are written to the library in batches so the catalog and
+// list are refreshed a few times during a large import, not per song
+static const int kImportBatchSize = 200;
+
+} // namespace
 
 SongPanel::SongPanel(QWidget *parent)
     : QWidget(parent)
@@ -17,6 +31,10 @@ SongPanel::SongPanel(QWidget *parent)
     , currentSectionIndex(-1)
 {
     setupUI();
+    // Fires after every scan, including the ones triggered by files being
+    // added or changed on disk while the app is running
+    connect(songManager, &SongManager::songsLoaded,
+            this, &SongPanel::onSongsLoaded);
     loadSongs();
 }
 
@@ -45,17 +63,34 @@ static QString songsDirectory()
 #endif
 }
 
-void SongPanel::activateSong(const QString &songTitle)
+void SongPanel::activateSong(const QString &songTitle, int songId, const QJsonObject &bundledSong)
 {
+    if (!bundledSong.isEmpty()) {
+        // Not a library song (its ID is 0), so it cannot be edited or
+        // deleted from here, and rescans leave it selected
+        songsList->clearSelection();
+        selectSong(std::make_shared<const Song>(SongManager::songFromJson(bundledSong)));
+        editSongButton->setEnabled(false);
+        deleteSongButton->setEnabled(false);
+        return;
+    }
+
+    // Prefer the stable ID; playlists saved before songs had IDs (or whose
+    // ID now belongs to another song) fall back to the title
+    SongHandle song = songManager->song(songId);
+    if (!song || song->title != songTitle) {
+        song = songManager->songByTitle(songTitle);
+    }
+    if (!song) {
+        return;
+    }
+
     // Find the song in the list
-    for (int i = 0; i < songsList->count(); ++i) {
-        QListWidgetItem *item = songsList->item(i);
-        if (item->text() == songTitle) {
-            songsList->setCurrentItem(item);
-            onSongClicked(item);  // This will load the sections
-            break;
-        }
+    const QModelIndex row = songsModel->indexOfSong(song->id);
+    if (row.isValid()) {
+        songsList->setCurrentIndex(row);
     }
+    selectSong(song);
 }
 
 void SongPanel::setupUI()
@@ -64,7 +99,7 @@ void SongPanel::setupUI()
     // Search box
     QHBoxLayout *searchLayout = new QHBoxLayout();
     searchEdit = new QLineEdit();
-    searchEdit->setPlaceholderText("Search songs...");
+    searchEdit->setPlaceholderText("Search titles, lyrics, author or CCLI...");
     searchLayout->addWidget(searchEdit);
     
     // Refresh button
@@ -74,6 +109,27 @@ void SongPanel::setupUI()
     // Song management buttons
     addSongButton = new QPushButton("Add Song");
     searchLayout->addWidget(addSongButton);
+
+    importSongsButton = new QToolButton();
+    importSongsButton->setText("Import...");
+    importSongsButton->setToolTip("Import OpenLyrics, ChordPro or CCLI SongSelect songs");
+    importSongsButton->setPopupMode(QToolButton::InstantPopup);
+    QMenu *importMenu = new QMenu(importSongsButton);
+    importMenu->addAction("From Files...", this, [this]() {
+        const QStringList paths = QFileDialog::getOpenFileNames(this, "Import Songs", QString(),
+                                                                SongImporter::fileDialogFilter());
+        if (!paths.isEmpty()) {
+            importSongs(paths);
+        }
+    });
+    importMenu->addAction("From Folder...", this, [this]() {
+        const QString path = QFileDialog::getExistingDirectory(this, "Import Songs");
+        if (!path.isEmpty()) {
+            importSongs(QStringList() << path);
+        }
+    });
+    importSongsButton->setMenu(importMenu);
+    searchLayout->addWidget(importSongsButton);
     
     editSongButton = new QPushButton("Edit Song");
     editSongButton->setEnabled(false);
@@ -92,14 +148,17 @@ void SongPanel::setupUI()
     QVBoxLayout *songsLayout = new QVBoxLayout(songsWidget);
     songsLayout->setContentsMargins(0, 0, 0, 0);
     songsLayout->addWidget(new QLabel("Songs:"));
-    songsList = new QListWidget();
+    songsModel = new SongListModel(this);
+    songsList = new QListView();
+    songsList->setModel(songsModel);
+    songsList->setUniformItemSizes(true);
     songsList->setDragEnabled(true);
     songsList->setContextMenuPolicy(Qt::CustomContextMenu);
     songsLayout->addWidget(songsList);
     splitter->addWidget(songsWidget);
     
     // Connect context menu for songs
-    connect(songsList, &QListWidget::customContextMenuRequested,
+    connect(songsList, &QListView::customContextMenuRequested,
             this, &SongPanel::onSongContextMenuRequested);
     
     // Sections list
@@ -142,7 +201,7 @@ void SongPanel::setupUI()
     // Connect signals
     connect(searchEdit, &QLineEdit::textChanged,
             this, &SongPanel::onSearchTextChanged);
-    connect(songsList, &QListWidget::itemClicked,
+    connect(songsList, &QListView::clicked,
             this, &SongPanel::onSongClicked);
     connect(sectionsList, &QListWidget::itemClicked,
             this, &SongPanel::onSectionClicked);
@@ -167,42 +226,72 @@ void SongPanel::setupUI()
 void SongPanel::loadSongs()
 {
     songManager->loadSongsFromDirectory(songsDirectory());
-    
-    songsList->clear();
-    QStringList titles = songManager->getSongTitles();
-    songsList->addItems(titles);
 }
 
-void SongPanel::onSearchTextChanged(const QString &text)
+void SongPanel::onSongsLoaded()
 {
-    if (text.isEmpty()) {
-        songsList->clear();
-        songsList->addItems(songManager->getSongTitles());
-    } else {
-        QStringList results = songManager->searchSongs(text);
-        songsList->clear();
-        songsList->addItems(results);
+    // Keep the current filter and selection across background rescans
+    onSearchTextChanged(searchEdit->text());
+    if (!currentSong || currentSong->id == 0) {
+        return;
+    }
+
+    // Edits elsewhere publish a new handle; follow it, or drop the song if
+    // it was deleted
+    const SongHandle latest = songManager->song(currentSong->id);
+    if (!latest) {
+        clearCurrentSong();
+        return;
+    }
+    const QModelIndex row = songsModel->indexOfSong(latest->id);
+    if (row.isValid() && songsList->currentIndex() != row) {
+        songsList->setCurrentIndex(row);
+    }
+    if (latest != currentSong) {
+        selectSong(latest);
     }
 }
 
-void SongPanel::onSongClicked(QListWidgetItem *item)
+void SongPanel::onSearchTextChanged(const QString &text)
 {
-    if (!item) return;
-    
-    QString songTitle = item->text();
-    Song song = songManager->getSong(songTitle);
+    const QVector<SongHandle> results = text.isEmpty() ? songManager->allSongs()
+                                                       : songManager->searchSongs(text);
+    songsModel->setSongs(results);
+}
+
+void SongPanel::onSongClicked(const QModelIndex &index)
+{
+    if (!index.isValid()) return;
     
-    if (!song.title.isEmpty()) {
-        currentSongTitle = songTitle;
-        currentSong = song;
-        displaySong(song);
-        
-        // Enable edit/delete buttons when a song is selected
-        editSongButton->setEnabled(true);
-        deleteSongButton->setEnabled(true);
+    const SongHandle song = songManager->song(index.data(Qt::UserRole).toInt());
+    if (song) {
+        selectSong(song);
     }
 }
 
+void SongPanel::selectSong(const SongHandle &song)
+{
+    // Shares the library's copy; nothing about the lyrics is copied
+    currentSong = song;
+    displaySong(*song);
+    
+    // Enable edit/delete buttons when a song is selected
+    editSongButton->setEnabled(true);
+    deleteSongButton->setEnabled(true);
+}
+
+void SongPanel::clearCurrentSong()
+{
+    currentSong.reset();
+    currentSectionIndex = -1;
+    sectionsList->clear();
+    projectButton->setEnabled(false);
+    previousButton->setEnabled(false);
+    nextButton->setEnabled(false);
+    editSongButton->setEnabled(false);
+    deleteSongButton->setEnabled(false);
+}
+
 void SongPanel::onSectionClicked(QListWidgetItem *item)
 {
     
@@ -217,14 +306,14 @@ void SongPanel::onSectionClicked(QListWidgetItem *item)
 
 void SongPanel::onProjectClicked()
 {
-    if (currentSectionIndex < 0 || currentSectionIndex >= currentSong.sections.size()) {
+    if (!currentSong || currentSectionIndex < 0 || currentSectionIndex >= currentSong->sections.size()) {
         return;
     }
     
-    const SongSection &section = currentSong.sections[currentSectionIndex];
+    const SongSection &section = currentSong->sections[currentSectionIndex];
     QString sectionText = section.text();
     
-    emit sectionSelected(currentSongTitle, sectionText);
+    emit sectionSelected(currentSong->title, sectionText);
 }
 
 void SongPanel::onNextSection()
@@ -258,134 +347,123 @@ void SongPanel::onAddSongClicked()
     if (dialog.exec() == QDialog::Accepted) {
         Song newSong = dialog.getSong();
         
-        // Save song to XML file in the songs directory
-        const QString baseDir = songsDirectory();
-        QDir dir(baseDir);
-        const QString fileName = dir.filePath(QString("%1.xml").arg(newSong.title));
-        
-        QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly)) {
-            QXmlStreamWriter xml(&file);
-            xml.setAutoFormatting(true);
-            xml.writeStartDocument();
-            
-            xml.writeStartElement("song");
-            xml.writeTextElement("title", newSong.title);
-            xml.writeTextElement("author", newSong.author);
-            xml.writeTextElement("copyright", newSong.copyright);
-            xml.writeTextElement("ccli", newSong.ccli);
-            
-            xml.writeStartElement("lyrics");
-            for (const SongSection &section : newSong.sections) {
-                xml.writeStartElement("section");
-                xml.writeAttribute("type", section.type);
-                for (const QString &line : section.lines) {
-                    xml.writeTextElement("line", line);
-                }
-                xml.writeEndElement(); // section
-            }
-            xml.writeEndElement(); // lyrics
-            
-            xml.writeEndElement(); // song
-            xml.writeEndDocument();
-            
-            file.close();
-            
+        // Save song to XML file in the songs directory; the list refreshes
+        // from songsLoaded
+        QString error;
+        if (songManager->saveSong(newSong, &error)) {
             QMessageBox::information(this, "Success", "Song created successfully!");
-            loadSongs();  // Refresh the list
         } else {
-            QMessageBox::warning(this, "Error", "Failed to save song file");
+            QMessageBox::warning(this, "Error", QString("Failed to save song file: %1").arg(error));
         }
     }
 }
 
 void SongPanel::onEditSongClicked()
 {
-    if (currentSongTitle.isEmpty()) return;
+    if (!currentSong) return;
     
-    SongEditorDialog dialog(currentSong, this);
+    // The dialog edits a copy; saving publishes it under the same ID and
+    // file, and songsLoaded moves the panel onto the new version
+    SongEditorDialog dialog(*currentSong, this);
     if (dialog.exec() == QDialog::Accepted) {
         Song editedSong = dialog.getSong();
         
-        const QString baseDir = songsDirectory();
-
-        // Delete old file if title changed
-        if (editedSong.title != currentSongTitle) {
-            const QString oldFileName = QDir(baseDir).filePath(QString("%1.xml").arg(currentSongTitle));
-            QFile::remove(oldFileName);
-        }
-        
-        // Save song to XML file
-        const QString fileName = QDir(baseDir).filePath(QString("%1.xml").arg(editedSong.title));
-        
-        QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly)) {
-            QXmlStreamWriter xml(&file);
-            xml.setAutoFormatting(true);
-            xml.writeStartDocument();
-            
-            xml.writeStartElement("song");
-            xml.writeTextElement("title", editedSong.title);
-            xml.writeTextElement("author", editedSong.author);
-            xml.writeTextElement("copyright", editedSong.copyright);
-            xml.writeTextElement("ccli", editedSong.ccli);
-            
-            xml.writeStartElement("lyrics");
-            for (const SongSection &section : editedSong.sections) {
-                xml.writeStartElement("section");
-                xml.writeAttribute("type", section.type);
-                for (const QString &line : section.lines) {
-                    xml.writeTextElement("line", line);
-                }
-                xml.writeEndElement(); // section
-            }
-            xml.writeEndElement(); // lyrics
-            
-            xml.writeEndElement(); // song
-            xml.writeEndDocument();
-            
-            file.close();
-            
+        QString error;
+        if (songManager->saveSong(editedSong, &error)) {
             QMessageBox::information(this, "Success", "Song updated successfully!");
-            loadSongs();  // Refresh the list
-            sectionsList->clear();
-            currentSongTitle.clear();
-            editSongButton->setEnabled(false);
-            deleteSongButton->setEnabled(false);
         } else {
-            QMessageBox::warning(this, "Error", "Failed to save song file");
+            QMessageBox::warning(this, "Error", QString("Failed to save song file: %1").arg(error));
         }
     }
 }
 
 void SongPanel::onDeleteSongClicked()
 {
-    if (currentSongTitle.isEmpty()) return;
+    if (!currentSong) return;
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this,
         "Delete Song",
-        QString("Are you sure you want to delete '%1'?").arg(currentSongTitle),
+        QString("Are you sure you want to delete '%1'?").arg(currentSong->title),
         QMessageBox::Yes | QMessageBox::No
     );
     
     if (reply == QMessageBox::Yes) {
         // Delete the song file from the songs directory
-        const QString baseDir = songsDirectory();
-        const QString filePath = QDir(baseDir).filePath(QString("%1.xml").arg(currentSongTitle));
-        if (QFile::remove(filePath)) {
+        if (songManager->deleteSong(currentSong->id)) {
             QMessageBox::information(this, "Success", "Song deleted successfully");
-            loadSongs();  // Refresh the list
-            sectionsList->clear();
-            currentSongTitle.clear();
-            editSongButton->setEnabled(false);
-            deleteSongButton->setEnabled(false);
+            clearCurrentSong();
         } else {
             QMessageBox::warning(this, "Error", "Failed to delete song file");
         }
     }
 }
 
+void SongPanel::importSongs(const QStringList &paths)
+{
+    const QStringList files = SongImporter::collectSources(paths);
+    if (files.isEmpty()) {
+        QMessageBox::information(this, "Import Songs", "No song files found.");
+        return;
+    }
+
+    struct ImportState {
+        QVector<Song> pending;
+        int added = 0;
+        int duplicates = 0;
+        QStringList errors;
+    };
+    auto state = std::make_shared<ImportState>();
+
+    importSongsButton->setEnabled(false);
+    auto *progress = new QProgressDialog("Importing songs...", "Cancel", 0, files.size(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+
+    // Files are parsed on the thread pool; the GUI thread only collects
+    // results and writes each full batch to the library
+    auto *watcher = new QFutureWatcher<SongImporter::Result>(this);
+    auto flush = [this, state]() {
+        if (!state->pending.isEmpty()) {
+            state->added += songManager->addSongs(state->pending, &state->duplicates, &state->errors);
+            state->pending.clear();
+        }
+    };
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::resultsReadyAt, this, [watcher, state, flush](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const SongImporter::Result result = watcher->resultAt(i);
+            if (result.ok) {
+                state->pending.append(result.song);
+            } else {
+                state->errors.append(result.error);
+            }
+        }
+        if (state->pending.size() >= kImportBatchSize) {
+            flush();
+        }
+    });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress, state, flush]() {
+        watcher->deleteLater();
+        progress->deleteLater();
+        flush();
+        importSongsButton->setEnabled(true);
+
+        QString summary = QString("Imported %1 song(s).").arg(state->added);
+        if (state->duplicates > 0) {
+            summary += QString("\nSkipped %1 already in the library.").arg(state->duplicates);
+        }
+        if (!state->errors.isEmpty()) {
+            summary += QString("\n%1 file(s) could not be imported:\n%2")
+                           .arg(state->errors.size())
+                           .arg(state->errors.mid(0, 10).join('\n'));
+        }
+        QMessageBox::information(this, "Import Songs", summary);
+    });
+    watcher->setFuture(QtConcurrent::mapped(files, &SongImporter::parseFile));
+}
+
 void SongPanel::displaySong(const Song &song)
 {
     sectionsList->clear();
@@ -421,9 +499,9 @@ void SongPanel::onContextMenuRequested(const QPoint &pos)
     
     if (selectedAction == addToPlaylistAction) {
         int sectionIndex = item->data(Qt::UserRole).toInt();
-        if (sectionIndex >= 0 && sectionIndex < currentSong.sections.size()) {
-            QString sectionText = currentSong.sections[sectionIndex].text();
-            emit addSectionToPlaylist(currentSongTitle, sectionText);
+        if (currentSong && sectionIndex >= 0 && sectionIndex < currentSong->sections.size()) {
+            QString sectionText = currentSong->sections[sectionIndex].text();
+            emit addSectionToPlaylist(currentSong->title, sectionText, currentSong->id);
         }
     } else if (selectedAction == projectAction) {
         onSectionClicked(item);
@@ -433,8 +511,8 @@ void SongPanel::onContextMenuRequested(const QPoint &pos)
 
 void SongPanel::onSongContextMenuRequested(const QPoint &pos)
 {
-    QListWidgetItem *item = songsList->itemAt(pos);
-    if (!item) return;
+    const QModelIndex item = songsList->indexAt(pos);
+    if (!item.isValid()) return;
     
     QMenu contextMenu(this);
     QAction *addToPlaylistAction = contextMenu.addAction("Add to Playlist");
@@ -442,7 +520,7 @@ void SongPanel::onSongContextMenuRequested(const QPoint &pos)
     QAction *selectedAction = contextMenu.exec(songsList->mapToGlobal(pos));
     
     if (selectedAction == addToPlaylistAction) {
-        QString songTitle = item->text();
-        emit addSongToPlaylist(songTitle);
+        QString songTitle = item.data(Qt::DisplayRole).toString();
+        emit addSongToPlaylist(songTitle, item.data(Qt::UserRole).toInt());
     }
 }
@@ -4,9 +4,13 @@
 #include <QWidget>
 #include <QLineEdit>
 #include <QListWidget>
+#include <QListView>
 #include <QPushButton>
+#include <QToolButton>
 #include "SongManager.h"
 
+class SongListModel;
+
 class SongPanel : public QWidget
 {
     Q_OBJECT
@@ -15,17 +19,19 @@ public:
     explicit SongPanel(QWidget *parent = nullptr);
     ~SongPanel();
     
-    // Public method to activate a song from playlist
-    void activateSong(const QString &songTitle);
+    // Public method to activate a song from playlist. A bundled song is
+    // shown as it was prepared, not looked up in this library.
+    void activateSong(const QString &songTitle, int songId = 0, const QJsonObject &bundledSong = QJsonObject());
+    SongManager *manager() const { return songManager; }
 
 signals:
     void sectionSelected(const QString &songTitle, const QString &sectionText);
-    void addSongToPlaylist(const QString &songTitle);
-    void addSectionToPlaylist(const QString &songTitle, const QString &sectionText);
+    void addSongToPlaylist(const QString &songTitle, int songId);
+    void addSectionToPlaylist(const QString &songTitle, const QString &sectionText, int songId);
 
 private slots:
     void onSearchTextChanged(const QString &text);
-    void onSongClicked(QListWidgetItem *item);
+    void onSongClicked(const QModelIndex &index);
     void onSectionClicked(QListWidgetItem *item);
     void onProjectClicked();
     void onNextSection();
@@ -36,27 +42,32 @@ private slots:
     void onDeleteSongClicked();
     void onContextMenuRequested(const QPoint &pos);
     void onSongContextMenuRequested(const QPoint &pos);
+    void onSongsLoaded();
 
 private:
     void setupUI();
     void loadSongs();
+    void importSongs(const QStringList &paths);
+    void selectSong(const SongHandle &song);
+    void clearCurrentSong();
     void displaySong(const Song &song);
     
     SongManager *songManager;
     
     QLineEdit *searchEdit;
-    QListWidget *songsList;
+    QListView *songsList;
+    SongListModel *songsModel;
     QListWidget *sectionsList;
     QPushButton *projectButton;
     QPushButton *previousButton;
     QPushButton *nextButton;
     QPushButton *refreshButton;
     QPushButton *addSongButton;
+    QToolButton *importSongsButton;
     QPushButton *editSongButton;
     QPushButton *deleteSongButton;
     
-    QString currentSongTitle;
-    Song currentSong;
+    SongHandle currentSong;
     int currentSectionIndex;
 };
 
@@ -0,0 +1,288 @@
+#include "SongSearchIndex.h"
+#include "SongManager.h"
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// A query word may match in several fields; only its best one counts
+static const int kTitleWeight = 1000;
+static const int kFirstLineWeight = 300;
+static const int kMetaWeight = 100;
+static const int kBodyWeight = 10;
+
+// Intersect the matches of the next query clause into the running scores
+void intersectScores(QHash<qint32, int> &scores, const QHash<qint32, int> &clause, bool first)
+{
+    if (first) {
+        scores = clause;
+        return;
+    }
+    for (auto it = scores.begin(); it != scores.end();) {
+        auto match = clause.constFind(it.key());
+        if (match == clause.constEnd()) {
+            it = scores.erase(it);
+        } else {
+            it.value() += match.value();
+            ++it;
+        }
+    }
+}
+
+} // namespace
+
+void SongSearchIndex::clear()
+{
+    postings.clear();
+    titleByDocId.clear();
+    termsByDocId.clear();
+}
+
+QStringList SongSearchIndex::tokenize(QStringView text)
+{
+    QStringList words;
+    QString word;
+    for (const QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            word.append(ch.toLower());
+        } else if (ch == QLatin1Char('\'') || ch == QChar(0x2019)) {
+            // "don't" and "don’t" both index as "dont"
+            continue;
+        } else if (!word.isEmpty()) {
+            words.append(word);
+            word.clear();
+        }
+    }
+    if (!word.isEmpty()) {
+        words.append(word);
+    }
+    return words;
+}
+
+int SongSearchIndex::fieldWeight(quint8 field)
+{
+    switch (field) {
+    case TitleField: return kTitleWeight;
+    case FirstLineField: return kFirstLineWeight;
+    case MetaField: return kMetaWeight;
+    default: return kBodyWeight;
+    }
+}
+
+quint64 SongSearchIndex::positionKey(qint32 docId, quint8 field, int position)
+{
+    return (quint64(quint32(docId)) << 24) | (quint64(field) << 16) | quint64(quint16(position));
+}
+
+void SongSearchIndex::addField(qint32 docId, Field field, const QStringList &words)
+{
+    QStringList &terms = termsByDocId[docId];
+    for (int i = 0; i < words.size(); ++i) {
+        QVector<Posting> &list = postings[words[i]];
+        if (list.isEmpty() || list.constLast().docId != docId) {
+            terms.append(words[i]);
+        }
+        list.append(Posting{docId, quint8(field), quint16(qMin(i, 0xffff))});
+    }
+}
+
+void SongSearchIndex::addSong(const Song &song)
+{
+    removeSong(song.id);
+
+    const qint32 docId = song.id;
+    titleByDocId.insert(docId, song.title);
+
+    addField(docId, TitleField, tokenize(song.title));
+
+    // Lines of all sections form one body so phrases can run across line
+    // breaks; the opening line is also indexed on its own, ranked higher
+    QStringList body;
+    bool firstLine = true;
+    for (const SongSection &section : song.sections) {
+        for (const QString &line : section.lines) {
+            const QStringList words = tokenize(line);
+            if (firstLine && !words.isEmpty()) {
+                addField(docId, FirstLineField, words);
+                firstLine = false;
+            }
+            body += words;
+        }
+    }
+    addField(docId, BodyField, body);
+
+    QStringList meta = tokenize(song.author);
+    meta += tokenize(song.copyright);
+    meta += tokenize(song.ccli);
+    addField(docId, MetaField, meta);
+}
+
+void SongSearchIndex::removeSong(int songId)
+{
+    const qint32 docId = songId;
+    if (!titleByDocId.remove(docId)) {
+        return;
+    }
+
+    const QStringList terms = termsByDocId.take(docId);
+    for (const QString &term : terms) {
+        auto list = postings.find(term);
+        if (list == postings.end()) {
+            continue;
+        }
+        list->erase(std::remove_if(list->begin(), list->end(),
+                                   [docId](const Posting &p) { return p.docId == docId; }),
+                    list->end());
+        if (list->isEmpty()) {
+            postings.erase(list);
+        }
+    }
+}
+
+QHash<qint32, int> SongSearchIndex::matchWord(const QString &word, bool prefix) const
+{
+    QHash<qint32, int> matches;
+    auto collect = [&matches](const QVector<Posting> &list) {
+        for (const Posting &p : list) {
+            int &best = matches[p.docId];
+            best = qMax(best, fieldWeight(p.field));
+        }
+    };
+
+    if (!prefix) {
+        auto it = postings.constFind(word);
+        if (it != postings.constEnd()) {
+            collect(it.value());
+        }
+        return matches;
+    }
+
+    for (auto it = postings.lowerBound(word); it != postings.constEnd() && it.key().startsWith(word); ++it) {
+        collect(it.value());
+    }
+    return matches;
+}
+
+QHash<qint32, int> SongSearchIndex::matchPhrase(const QStringList &words) const
+{
+    QHash<qint32, int> matches;
+    if (words.isEmpty()) {
+        return matches;
+    }
+
+    auto first = postings.constFind(words.first());
+    if (first == postings.constEnd()) {
+        return matches;
+    }
+
+    // Position sets for the following words, checked against each start
+    QVector<QSet<quint64>> following;
+    for (int i = 1; i < words.size(); ++i) {
+        auto it = postings.constFind(words[i]);
+        if (it == postings.constEnd()) {
+            return matches;
+        }
+        QSet<quint64> keys;
+        keys.reserve(it->size());
+        for (const Posting &p : it.value()) {
+            keys.insert(positionKey(p.docId, p.field, p.position));
+        }
+        following.append(keys);
+    }
+
+    for (const Posting &p : first.value()) {
+        bool adjacent = true;
+        for (int i = 0; i < following.size() && adjacent; ++i) {
+            adjacent = following[i].contains(positionKey(p.docId, p.field, p.position + i + 1));
+        }
+        if (adjacent) {
+            int &best = matches[p.docId];
+            best = qMax(best, fieldWeight(p.field));
+        }
+    }
+    return matches;
+}
+
+QVector<int> SongSearchIndex::search(QStringView query, int maxResults) const
+{
+    // Split into "quoted phrases" and loose words
+    QVector<QStringList> phrases;
+    QStringList words;
+    bool endsInWord = false;
+    int pos = 0;
+    while (pos < query.size()) {
+        const int quote = query.indexOf(QLatin1Char('"'), pos);
+        const QStringView loose = query.mid(pos, quote < 0 ? -1 : quote - pos);
+        const QStringList looseWords = tokenize(loose);
+        words += looseWords;
+        endsInWord = quote < 0 && !looseWords.isEmpty() && !loose.isEmpty() && loose.back().isLetterOrNumber();
+        if (quote < 0) {
+            break;
+        }
+        const int close = query.indexOf(QLatin1Char('"'), quote + 1);
+        const QStringList phraseWords = tokenize(query.mid(quote + 1, close < 0 ? -1 : close - quote - 1));
+        if (phraseWords.size() == 1) {
+            words += phraseWords;
+        } else if (!phraseWords.isEmpty()) {
+            phrases.append(phraseWords);
+        }
+        if (close < 0) {
+            break;
+        }
+        pos = close + 1;
+    }
+
+    if (words.isEmpty() && phrases.isEmpty()) {
+        return QVector<int>();
+    }
+
+    QHash<qint32, int> scores;
+    bool first = true;
+    for (const QStringList &phrase : phrases) {
+        intersectScores(scores, matchPhrase(phrase), first);
+        first = false;
+        if (scores.isEmpty()) {
+            return QVector<int>();
+        }
+    }
+    for (int i = 0; i < words.size(); ++i) {
+        // The word still being typed matches as a prefix
+        const bool prefix = endsInWord && i == words.size() - 1;
+        intersectScores(scores, matchWord(words[i], prefix), first);
+        first = false;
+        if (scores.isEmpty()) {
+            return QVector<int>();
+        }
+    }
+
+    struct Hit {
+        int score;
+        qint32 docId;
+        const QString *title;
+    };
+    QVector<Hit> ranked;
+    ranked.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        ranked.append(Hit{it.value(), it.key(), &*titleByDocId.constFind(it.key())});
+    }
+    auto better = [](const Hit &a, const Hit &b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        const int order = a.title->compare(*b.title, Qt::CaseInsensitive);
+        return order != 0 ? order < 0 : a.docId < b.docId;
+    };
+    if (maxResults >= 0 && maxResults < ranked.size()) {
+        std::partial_sort(ranked.begin(), ranked.begin() + maxResults, ranked.end(), better);
+        ranked.resize(maxResults);
+    } else {
+        std::sort(ranked.begin(), ranked.end(), better);
+    }
+
+    QVector<int> songIds;
+    songIds.reserve(ranked.size());
+    for (const Hit &hit : ranked) {
+        songIds.append(hit.docId);
+    }
+    return songIds;
+}
@@ -0,0 +1,67 @@
+#ifndef SONGSEARCHINDEX_H
+#define SONGSEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+struct Song;
+
+// Inverted index over song titles, lyrics, author, copyright and CCLI
+// number, so a song can be found from any line someone remembers.
+//
+// Every word is stored with the field it came from and its position in
+// that field. Queries are a list of words that must all match (the last
+// one as a prefix, so results follow typing) and "quoted phrases" whose
+// words must be adjacent. Hits are ranked by field: title, then the first
+// line of the song, then author/copyright/CCLI, then the rest of the
+// lyrics. Songs are added and removed one at a time, keyed by song ID.
+class SongSearchIndex
+{
+public:
+    void clear();
+    bool isEmpty() const { return titleByDocId.isEmpty(); }
+
+    // Replaces any song already indexed under the same ID
+    void addSong(const Song &song);
+    void removeSong(int songId);
+
+    // IDs of matching songs, best first; ties are ordered by title
+    QVector<int> search(QStringView query, int maxResults = -1) const;
+
+    // Lower-cased words with punctuation and apostrophes dropped
+    static QStringList tokenize(QStringView text);
+
+private:
+    enum Field : quint8 {
+        TitleField,
+        FirstLineField,
+        MetaField, // author, copyright, CCLI
+        BodyField
+    };
+
+    struct Posting {
+        qint32 docId;
+        quint8 field;
+        quint16 position;
+    };
+
+    static int fieldWeight(quint8 field);
+    static quint64 positionKey(qint32 docId, quint8 field, int position);
+
+    void addField(qint32 docId, Field field, const QStringList &words);
+    // docId -> best field weight for one query word or phrase
+    QHash<qint32, int> matchWord(const QString &word, bool prefix) const;
+    QHash<qint32, int> matchPhrase(const QStringList &words) const;
+
+    // Documents are songs, docId being the song ID. The dictionary is
+    // ordered so prefix queries are a range scan.
+    QMap<QString, QVector<Posting>> postings;
+    QHash<qint32, QString> titleByDocId;     // for ordering ties
+    QHash<qint32, QStringList> termsByDocId; // to remove a song's postings
+};
+
+#endif // SONGSEARCHINDEX_H
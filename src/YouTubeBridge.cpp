@@ -0,0 +1,109 @@
+#include "YouTubeBridge.h"
+
+#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
+
+#include <QFile>
+#include <QWebChannel>
+#include <QWebEnginePage>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+#include <QDebug>
+
+namespace {
+
+// YT.PlayerState values
+constexpr int kStateEnded = 0;
+constexpr int kStatePlaying = 1;
+constexpr int kStatePaused = 2;
+
+} // namespace
+
+YouTubeBridge::YouTubeBridge(QObject *parent)
+    : QObject(parent)
+    , playerState(-1)
+    , playing(false)
+    , position(0.0)
+    , duration(0.0)
+{
+}
+
+void YouTubeBridge::attach(QWebEnginePage *page)
+{
+    QWebChannel *channel = new QWebChannel(page);
+    channel->registerObject(QStringLiteral("spBridge"), this);
+    page->setWebChannel(channel);
+
+    // Injected instead of loaded from qrc:, which the page's http origin
+    // may not reach
+    QFile api(QStringLiteral(":/qtwebchannel/qwebchannel.js"));
+    if (!api.open(QIODevice::ReadOnly)) {
+        qWarning() << "qwebchannel.js not available; YouTube events will not reach the app";
+        return;
+    }
+    QWebEngineScript script;
+    script.setName(QStringLiteral("qwebchannel"));
+    script.setSourceCode(QString::fromUtf8(api.readAll()));
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    page->scripts().insert(script);
+}
+
+void YouTubeBridge::reset()
+{
+    playerState = -1;
+    position = 0.0;
+    duration = 0.0;
+    sinceReport.invalidate();
+    if (playing) {
+        playing = false;
+        emit playingChanged(false);
+    }
+}
+
+double YouTubeBridge::positionRatio() const
+{
+    if (duration <= 0.0) {
+        return -1.0;
+    }
+    double current = position;
+    if (playerState == kStatePlaying && sinceReport.isValid()) {
+        current += sinceReport.elapsed() / 1000.0;
+    }
+    return qBound(0.0, current / duration, 1.0);
+}
+
+void YouTubeBridge::playerStateChanged(int state, double position, double duration)
+{
+    playerState = state;
+    setPosition(position, duration);
+
+    // Buffering and cueing leave the play state as it was
+    if (state == kStatePlaying || state == kStatePaused || state == kStateEnded) {
+        const bool nowPlaying = state == kStatePlaying;
+        if (nowPlaying != playing) {
+            playing = nowPlaying;
+            emit playingChanged(playing);
+        }
+    }
+}
+
+void YouTubeBridge::timeUpdated(double position, double duration)
+{
+    setPosition(position, duration);
+}
+
+void YouTubeBridge::setPosition(double position, double duration)
+{
+    this->position = qMax(0.0, position);
+    if (duration > 0.0) {
+        this->duration = duration;
+    }
+    sinceReport.start();
+
+    const double ratio = positionRatio();
+    if (ratio >= 0.0) {
+        emit positionChanged(ratio);
+    }
+}
+
+#endif // SIMPLEPRESENTER_HAVE_WEBENGINE
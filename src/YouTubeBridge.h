@@ -0,0 +1,54 @@
+#ifndef YOUTUBEBRIDGE_H
+#define YOUTUBEBRIDGE_H
+
+#include <QObject>
+
+#ifdef SIMPLEPRESENTER_HAVE_WEBENGINE
+
+#include <QElapsedTimer>
+
+class QWebEnginePage;
+
+// The projection canvas's YouTube player reports to C++ through this
+// object over QWebChannel: state changes (playing, paused, buffering,
+// ended) and, while playing, its position a few times a second. Nothing
+// has to be polled with runJavaScript, and the position can be read at
+// any time by extrapolating from the last report.
+class YouTubeBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit YouTubeBridge(QObject *parent = nullptr);
+
+    // Exposes the bridge to a newly created player page as "spBridge"
+    void attach(QWebEnginePage *page);
+    // Forgets the previous video's state
+    void reset();
+
+    bool isPlaying() const { return playing; }
+    // Position as a fraction of the duration, or -1 while it is unknown
+    double positionRatio() const;
+
+public slots:
+    // Called by the player page; state is the IFrame API's YT.PlayerState
+    void playerStateChanged(int state, double position, double duration);
+    void timeUpdated(double position, double duration);
+
+signals:
+    void positionChanged(double ratio);
+    void playingChanged(bool playing);
+
+private:
+    void setPosition(double position, double duration);
+
+    int playerState;
+    bool playing;
+    double position;
+    double duration;
+    QElapsedTimer sinceReport;
+};
+
+#endif // SIMPLEPRESENTER_HAVE_WEBENGINE
+
+#endif // YOUTUBEBRIDGE_H
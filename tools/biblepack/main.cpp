@@ -0,0 +1,52 @@
+// Build-time helper that compiles a Bible into the .spbible pack format
+// embedded in SimplePresenter's resources. Besides the app's own Bible XML
+// it accepts anything BibleImporter reads (OSIS files, USFM directories).
+//
+// Usage: SimplePresenterBiblePack <input.xml|usfm-dir> <output.spbible>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include "BibleTranslation.h"
+#include "BiblePack.h"
+#include "BibleImporter.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+
+    const QStringList args = app.arguments();
+    if (args.size() != 3) {
+        err << "Usage: " << QFileInfo(args.value(0)).fileName() << " <input.xml|usfm-dir> <output.spbible>\n";
+        return 2;
+    }
+
+    const QString inputPath = args.at(1);
+    const QString outputPath = args.at(2);
+
+    QString error;
+    QDir().mkpath(QFileInfo(outputPath).absolutePath());
+
+    const BibleImporter::Format format = BibleImporter::detectFormat(inputPath);
+    if (format == BibleImporter::OsisFormat || format == BibleImporter::UsfmFormat) {
+        if (!BibleImporter::importBible(inputPath, outputPath, &error)) {
+            err << inputPath << ": " << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::shared_ptr<const BibleTranslation> translation = BibleTranslation::load(inputPath, &error);
+    if (!translation) {
+        err << inputPath << ": " << error << "\n";
+        return 1;
+    }
+
+    if (!BiblePackWriter::writeTranslation(*translation, outputPath, &error)) {
+        err << outputPath << ": " << error << "\n";
+        return 1;
+    }
+    return 0;
+}